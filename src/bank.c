@@ -0,0 +1,426 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Bank
+ * Read and write a group of pins with one call
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "bank.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Submit the reads of the selected pins in one io_uring submission
+ *
+ * \param   pBank       Bank with BANK_URING backend
+ * \param   pSelected   Pins to read
+ * \param   pBuffers    Filled with one byte per pin
+ * \return  Pins read (Others failed), 0 if io_uring failed
+ */
+static uint32_t submitReads(pinBank*, uint32_t, char*);
+
+/**
+ * \brief   Wait for an edge on the selected pins with one poll()
+ *
+ * \param   pBank       Bank with value files
+ * \param   pSelected   Pins to watch
+ * \param   pTimeout    Timeout (ns)
+ * \param   pEdges      Filled with the pins having an edge
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror waitEdgePoll(pinBank*, uint32_t, uint64_t, uint32_t*);
+
+#define URING_DATA_REMOVE   64  //User data of poll removals (64 + pin bit)
+#define URING_DATA_TIMEOUT  128 //User data of the wait timeout
+
+static volatile uint32_t    *gpioRegisters  = NULL;
+static int                  isMapTried      = FALSE;
+static pthread_mutex_t      mapLock         = PTHREAD_MUTEX_INITIALIZER;
+
+
+//------------------------------------------------------------------------------
+// Bank functions
+//------------------------------------------------------------------------------
+pirror GIPY_bankOpen(pinBank *pBank, const int *pPins, int pNbPins){
+    dbgInfo("Try to open a bank of %d pins", pNbPins);
+    if(pBank == NULL || pPins == NULL || pNbPins < 1 || pNbPins > BANK_MAX_PINS){
+        dbgError("Invalid bank parameters");
+        return GE_PARAM;
+    }
+    memset(pBank, 0, sizeof(pinBank));
+
+    //Open the value files (Even with registers, it checks pins are exported)
+    int k;
+    for(k=0; k<pNbPins; k++){
+        char stamp[BUFSIZ];
+        sprintf(stamp, GPIO_PATH_VALUE, GIPY_getSysfsRoot(), pPins[k]);
+        pBank->pins[k]  = pPins[k];
+        pBank->fds[k]   = open(stamp, O_RDWR);
+        pBank->nbPins   = k + 1;
+        if(pBank->fds[k] == -1){
+            dbgError("Unable to open (RDWR) value file: %s", stamp);
+            pBank->nbPins = k;
+            GIPY_bankClose(pBank);
+            return GE_PERM;
+        }
+    }
+
+    //Registers are used if all pins are in the first GPIO register bank
+    pBank->backend      = BANK_SYSFS;
+    pBank->registers    = bankMapRegisters();
+    if(pBank->registers != NULL){
+        pBank->backend = BANK_GPIOMEM;
+        for(k=0; k<pNbPins; k++){
+            if(bankRegisterBit(pPins[k], &pBank->gpioBits[k]) == FALSE){
+                pBank->backend = BANK_SYSFS;
+                break;
+            }
+        }
+    }
+    if(pBank->backend == BANK_SYSFS && pNbPins >= BANK_URING_MIN_PINS
+            && GIPY_uringIsAvailable() == TRUE){
+        pBank->backend = BANK_URING;
+    }
+    dbgInfo("Bank opened (Backend: %s)", GIPY_bankBackendName(pBank->backend));
+    return GE_OK;
+}
+
+void GIPY_bankClose(pinBank *pBank){
+    int k;
+    for(k=0; k<pBank->nbPins; k++){
+        close(pBank->fds[k]);
+        pBank->fds[k] = -1;
+    }
+    pBank->nbPins = 0;
+}
+
+pirror GIPY_bankWrite(pinBank *pBank, uint32_t pMask, uint32_t pValues){
+    int k;
+
+    //Registers: one set and one clear write for all pins
+    if(pBank->backend == BANK_GPIOMEM){
+        uint32_t set = 0, clear = 0;
+        for(k=0; k<pBank->nbPins; k++){
+            if(pMask & (1U << k)){
+                if(pValues & (1U << k)){
+                    set |= pBank->gpioBits[k];
+                }
+                else{
+                    clear |= pBank->gpioBits[k];
+                }
+            }
+        }
+        if(clear != 0){
+            pBank->registers[GPIOMEM_GPCLR0] = clear;
+        }
+        if(set != 0){
+            pBank->registers[GPIOMEM_GPSET0] = set;
+        }
+        pBank->shadow   = (pBank->shadow & ~pMask) | (pValues & pMask);
+        pBank->known    |= pMask;
+        return GE_OK;
+    }
+
+    //Value files: only the pins which changed are written
+    uint32_t changed = pMask & ((pBank->shadow ^ pValues) | ~pBank->known);
+    for(k=0; k<pBank->nbPins && changed != 0; k++){
+        uint32_t bit = 1U << k;
+        if((changed & bit) == 0){
+            continue;
+        }
+        pBank->syscalls++;
+        if(pwrite(pBank->fds[k], (pValues & bit) ? "1" : "0", 1, 0) != 1){
+            dbgError("Unable to write in value file for pin: %d", pBank->pins[k]);
+            pBank->known &= ~bit;
+            return GE_IO;
+        }
+        pBank->shadow   = (pBank->shadow & ~bit) | (pValues & bit);
+        pBank->known    |= bit;
+        changed         &= ~bit;
+    }
+    return GE_OK;
+}
+
+pirror GIPY_bankRead(pinBank *pBank, uint32_t pMask, uint32_t *pValues){
+    int k;
+    uint32_t values = 0;
+
+    //Registers: one read for all pins
+    if(pBank->backend == BANK_GPIOMEM){
+        uint32_t level = pBank->registers[GPIOMEM_GPLEV0];
+        for(k=0; k<pBank->nbPins; k++){
+            if((pMask & (1U << k)) && (level & pBank->gpioBits[k])){
+                values |= 1U << k;
+            }
+        }
+        *pValues = values;
+        return GE_OK;
+    }
+
+    //Value files: positional read of each file (One submission with io_uring)
+    uint32_t selected = pMask & ((pBank->nbPins == 32) ? ~0U : (1U << pBank->nbPins) - 1);
+    if(pBank->backend == BANK_URING && __builtin_popcount(selected) >= 2){
+        char buffers[BANK_MAX_PINS];
+        if(submitReads(pBank, selected, buffers) != selected){
+            dbgError("Unable to read from value files of bank");
+            return GE_IO;
+        }
+        for(k=0; k<pBank->nbPins; k++){
+            if((selected & (1U << k)) && buffers[k] == '1'){
+                values |= 1U << k;
+            }
+        }
+        *pValues = values;
+        return GE_OK;
+    }
+    for(k=0; k<pBank->nbPins; k++){
+        char buff;
+        if((pMask & (1U << k)) == 0){
+            continue;
+        }
+        pBank->syscalls++;
+        if(pread(pBank->fds[k], &buff, 1, 0) != 1){
+            dbgError("Unable to read from value file for pin: %d", pBank->pins[k]);
+            return GE_IO;
+        }
+        if(buff == '1'){
+            values |= 1U << k;
+        }
+    }
+    *pValues = values;
+    return GE_OK;
+}
+
+pirror GIPY_bankWaitEdge(pinBank *pBank, uint32_t pMask, uint64_t pTimeout, uint32_t *pEdges){
+    uint32_t    selected    = pMask & ((pBank->nbPins == 32) ? ~0U : (1U << pBank->nbPins) - 1);
+    uint32_t    edges       = 0;
+    int         k;
+
+    if(pBank->backend == BANK_GPIOMEM){
+        return GE_PERM; //Registers have no edge notification
+    }
+
+    uringRing *ring = (pBank->backend == BANK_URING) ? uringThreadRing() : NULL;
+    if(ring == NULL){
+        return waitEdgePoll(pBank, selected, pTimeout, pEdges);
+    }
+
+    //One poll per pin and a timeout completing with the first poll
+    struct __kernel_timespec time = {pTimeout / NSEC_PER_SEC, pTimeout % NSEC_PER_SEC};
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t    pending     = selected;
+    int         outstanding = 1;
+    for(k=0; k<pBank->nbPins; k++){
+        if(selected & (1U << k)){
+            uringPrepPoll(ring, pBank->fds[k], POLLPRI | POLLERR, k);
+            outstanding++;
+        }
+    }
+    uringPrepTimeout(ring, &time, 1, URING_DATA_TIMEOUT);
+    pBank->syscalls++;
+    if(uringSubmit(ring, 1) != GE_OK){
+        return GE_IO; //Nothing submitted
+    }
+
+    //Remove the polls still pending, then drain all completions
+    int isRemoved   = FALSE;
+    int isRejected  = FALSE;
+    while(outstanding > 0){
+        uint64_t    data;
+        int32_t     result;
+        if(uringReap(ring, &data, &result) == FALSE){
+            if(isRemoved == FALSE){
+                for(k=0; k<pBank->nbPins; k++){
+                    if(pending & (1U << k)){
+                        uringPrepPollRemove(ring, k, URING_DATA_REMOVE + k);
+                        outstanding++;
+                    }
+                }
+                isRemoved = TRUE;
+            }
+            pBank->syscalls++;
+            if(uringSubmit(ring, 1) != GE_OK){
+                return GE_IO;
+            }
+            continue;
+        }
+        outstanding--;
+        if(data < URING_DATA_REMOVE){
+            pending &= ~(1U << data);
+            if(result > 0 && (result & (POLLPRI | POLLERR))){
+                edges |= 1U << data;
+            }
+            else if(result < 0 && result != -ECANCELED){
+                isRejected = TRUE; //Not pollable by io_uring (Regular file)
+            }
+        }
+    }
+
+    //Simulated value files: io_uring refuses to poll them, poll() waits
+    if(edges == 0 && isRejected == TRUE){
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        uint64_t elapsed = (uint64_t)(end.tv_sec - start.tv_sec) * NSEC_PER_SEC
+                         + end.tv_nsec - start.tv_nsec;
+        return waitEdgePoll(pBank, selected, (elapsed < pTimeout) ? pTimeout - elapsed : 0, pEdges);
+    }
+    *pEdges = edges;
+    return GE_OK;
+}
+
+pirror GIPY_bankSetBackend(pinBank *pBank, bankBackend pBackend){
+    int k;
+    switch(pBackend){
+        case BANK_GPIOMEM:
+            if(pBank->registers == NULL){
+                return GE_PERM;
+            }
+            for(k=0; k<pBank->nbPins; k++){
+                if(bankRegisterBit(pBank->pins[k], &pBank->gpioBits[k]) == FALSE){
+                    return GE_PERM;
+                }
+            }
+            break;
+        case BANK_URING:
+            if(GIPY_uringIsAvailable() == FALSE){
+                return GE_PERM;
+            }
+            break;
+        case BANK_SYSFS:
+            break;
+        default:
+            return GE_PERM;
+    }
+    pBank->backend  = pBackend;
+    pBank->known    = 0; //Written again through the new backend
+    return GE_OK;
+}
+
+const char *GIPY_bankBackendName(bankBackend pBackend){
+    static const char *names[] = {"sysfs", "gpiomem", "io_uring"};
+    return (pBackend <= BANK_URING) ? names[pBackend] : "unknown";
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static pirror waitEdgePoll(pinBank *pBank, uint32_t pSelected, uint64_t pTimeout, uint32_t *pEdges){
+    struct pollfd   fds[BANK_MAX_PINS];
+    int             pins[BANK_MAX_PINS];
+    int             nbFds   = 0;
+    uint32_t        edges   = 0;
+    int             k;
+    for(k=0; k<pBank->nbPins; k++){
+        if(pSelected & (1U << k)){
+            fds[nbFds].fd       = pBank->fds[k];
+            fds[nbFds].events   = POLLPRI | POLLERR;
+            pins[nbFds++]       = k;
+        }
+    }
+    pBank->syscalls++;
+    if(poll(fds, nbFds, (int)((pTimeout + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC)) == -1){
+        return GE_IO;
+    }
+    for(k=0; k<nbFds; k++){
+        if(fds[k].revents & (POLLPRI | POLLERR)){
+            edges |= 1U << pins[k];
+        }
+    }
+    *pEdges = edges;
+    return GE_OK;
+}
+
+static uint32_t submitReads(pinBank *pBank, uint32_t pSelected, char *pBuffers){
+    uringRing   *ring   = uringThreadRing();
+    uint32_t    done    = 0;
+    int         nb      = 0;
+    int         k;
+    if(ring == NULL){
+        return 0;
+    }
+    for(k=0; k<pBank->nbPins; k++){
+        if(pSelected & (1U << k)){
+            uringPrepRw(ring, FALSE, pBank->fds[k], &pBuffers[k], 1, 0, k);
+            nb++;
+        }
+    }
+    pBank->syscalls++;
+    if(uringSubmit(ring, nb) != GE_OK){
+        return 0;
+    }
+
+    //Completions may come in any order
+    while(nb > 0){
+        uint64_t    data;
+        int32_t     result;
+        if(uringReap(ring, &data, &result) == FALSE){
+            pBank->syscalls++;
+            if(uringSubmit(ring, 1) != GE_OK){
+                break; //Not all completed yet, and unable to wait
+            }
+            continue;
+        }
+        nb--;
+        if(result == 1){
+            done |= 1U << data;
+        }
+    }
+    return done;
+}
+
+
+//------------------------------------------------------------------------------
+// Library internal functions
+//------------------------------------------------------------------------------
+volatile uint32_t *bankMapRegisters(void){
+    //Registers do not match a relocated (Simulated) sysfs
+    if(strcmp(GIPY_getSysfsRoot(), GPIO_PATH) != 0){
+        return NULL;
+    }
+    pthread_mutex_lock(&mapLock);
+    if(isMapTried == FALSE){
+        isMapTried = TRUE;
+        int file = open(GPIOMEM_PATH, O_RDWR | O_SYNC);
+        if(file != -1){
+            void *map = mmap(NULL, GPIOMEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+            close(file); //Mapping stays valid
+            if(map != MAP_FAILED){
+                gpioRegisters = (volatile uint32_t *)map;
+            }
+        }
+        dbgInfo("GPIO registers %s", (gpioRegisters != NULL) ? "mapped" : "not available");
+    }
+    pthread_mutex_unlock(&mapLock);
+    return gpioRegisters;
+}
+
+int bankRegisterBit(int pPin, uint32_t *pBit){
+    static const char   *labels[] = {GPIOMEM_CHIP_LABELS};
+    gpioChip            chips[GPIOMEM_MAX_CHIPS];
+    int                 nbChips = GIPY_getChips(chips, GPIOMEM_MAX_CHIPS);
+    int                 base    = (nbChips == 0) ? 0 : -1;
+    int                 k, l;
+
+    //Other chips (Expanders...) may have any base, even 0
+    for(k=0; k<nbChips && k<GPIOMEM_MAX_CHIPS && base == -1; k++){
+        for(l=0; l<(int)(sizeof(labels) / sizeof(labels[0])); l++){
+            if(strstr(chips[k].label, labels[l]) != NULL){
+                base = chips[k].base;
+                break;
+            }
+        }
+    }
+    if(base == -1 || pPin < base || pPin - base > 31){
+        return FALSE;
+    }
+    *pBit = 1U << (pPin - base);
+    return TRUE;
+}
@@ -0,0 +1,195 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Bank
+ * Read and write a group of pins with one call
+ *
+ * BACKENDS
+ * A bank uses the fastest backend available when it is opened:
+ *  - BANK_GPIOMEM: BCM2835 registers mapped from /dev/gpiomem. All pins
+ *    of the bank are set / cleared with one register write each. Only for
+ *    lines 0 to 31 of the BCM gpiochip (Found by label, any base).
+ *  - BANK_URING: Value files kept open by the bank. All reads of one call
+ *    (And the edge waits) are submitted with one io_uring_enter (See
+ *    uring.h). Writes use pwrite: io_uring gives them to its worker threads
+ *    (No non-blocking write on these files), which is slower. Used by
+ *    default for banks of BANK_URING_MIN_PINS pins or more.
+ *  - BANK_SYSFS: Value files kept open by the bank. One pread / pwrite per
+ *    pin.
+ * With value files, only the pins whose value changed since the last write
+ * are written (Shadow image).
+ * Pins must be exported (And direction set) before opening a bank.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_BANK_H_
+#define _HEADER_BANK_H_
+
+#include <sys/mman.h>
+
+#include "gipy.h"
+#include "uring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define BANK_MAX_PINS       32
+#define BANK_URING_MIN_PINS 4  //Smaller banks do not use io_uring by default
+#define GPIOMEM_PATH        "/dev/gpiomem"
+#define GPIOMEM_SIZE        4096
+#define GPIOMEM_GPSET0      (0x1C/4) //Registers offsets (32 bits words)
+#define GPIOMEM_GPCLR0      (0x28/4)
+#define GPIOMEM_GPLEV0      (0x34/4)
+#define GPIOMEM_CHIP_LABELS "bcm2835", "bcm2708", "bcm2709", "bcm2711" //gpiochip label of the registers (Part of)
+#define GPIOMEM_MAX_CHIPS   32 //gpiochips searched for the registers controller
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Describe the bank backends
+ */
+typedef enum {
+    BANK_SYSFS,
+    BANK_GPIOMEM,
+    BANK_URING
+} bankBackend;
+
+/**
+ * \brief Group of pins. Bit k of masks and values is the pin pins[k]
+ */
+typedef struct {
+    bankBackend         backend;
+    int                 nbPins;
+    int                 pins[BANK_MAX_PINS];
+    int                 fds[BANK_MAX_PINS];     //Value files (Sysfs backend)
+    uint32_t            gpioBits[BANK_MAX_PINS];//Register bit (Gpiomem backend)
+    volatile uint32_t   *registers;             //Mapped registers (Gpiomem)
+    uint32_t            shadow;                 //Last written values
+    uint32_t            known;                  //Bits of shadow already written
+    uint64_t            syscalls;               //Syscalls done by the bank
+} pinBank;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a bank of pins
+ *
+ * \param pBank     Bank to initialize
+ * \param pPins     Pins of the bank (Bit k is pPins[k])
+ * \param pNbPins   Number of pins (1 to BANK_MAX_PINS)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid number of pins
+ * \return GE_PERM  If a pin is not exported (Value file not reachable)
+ */
+pirror GIPY_bankOpen(pinBank*, const int*, int);
+
+/**
+ * \brief           Close a bank (Pins stay exported)
+ *
+ * \param pBank     Bank to close
+ * \return void
+ */
+void GIPY_bankClose(pinBank*);
+
+/**
+ * \brief           Write the pins selected by the mask
+ *
+ * \param pBank     Opened bank
+ * \param pMask     Pins to write
+ * \param pValues   Values for the selected pins
+ * \return GE_OK    If no error
+ * \return GE_IO    If unable to write a value file
+ */
+pirror GIPY_bankWrite(pinBank*, uint32_t, uint32_t);
+
+/**
+ * \brief           Read the pins selected by the mask
+ *
+ * \param pBank     Opened bank
+ * \param pMask     Pins to read
+ * \param pValues   Filled with the values (Not selected bits are 0)
+ * \return GE_OK    If no error
+ * \return GE_IO    If unable to read a value file
+ */
+pirror GIPY_bankRead(pinBank*, uint32_t, uint32_t*);
+
+/**
+ * \brief           Wait for an edge on the pins selected by the mask
+ * \details         Edges must be set on the pins (See GIPY_pinSetEdge). 
+ *                  Uses one io_uring submission for all pins (Or poll if
+ *                  io_uring is not available). Read the bank after an edge:
+ *                  the read arms the next edge of the value files.
+ *                  Simulated value files never report edges.
+ *
+ * \param pBank     Opened bank (Value files backend)
+ * \param pMask     Pins to watch
+ * \param pTimeout  Max wait (ns)
+ * \param pEdges    Filled with the pins with an edge (0 if timeout)
+ * \return GE_OK    If no error (Edge or timeout)
+ * \return GE_PERM  If the bank uses registers
+ * \return GE_IO    If the wait failed
+ */
+pirror GIPY_bankWaitEdge(pinBank*, uint32_t, uint64_t, uint32_t*);
+
+/**
+ * \brief           Change the backend of a bank
+ *
+ * \param pBank     Opened bank
+ * \param pBackend  New backend
+ * \return GE_OK    If no error
+ * \return GE_PERM  If the backend is not available for this bank
+ */
+pirror GIPY_bankSetBackend(pinBank*, bankBackend);
+
+/**
+ * \brief           Get the name of a bank backend
+ *
+ * \param pBackend  Backend
+ * \return          Backend name
+ */
+const char *GIPY_bankBackendName(bankBackend);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Library internal
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Map the GPIO registers (Once, shared by banks and handles)
+ * \details         Only done when the library works on the real sysfs root
+ *
+ * \return          Mapped registers, NULL if not available
+ */
+volatile uint32_t *bankMapRegisters(void);
+
+/**
+ * \brief           Get the register bit of a pin
+ * \details         The bit is the line of the pin in the BCM gpiochip (Pin
+ *                  minus chip base). Without any gpiochip (PINS_AVAILABLE),
+ *                  pins are the BCM lines.
+ *
+ * \param pPin      Pin number
+ * \param pBit      Filled with the bit in the GPIOMEM_GPLEV0... words
+ * \return          TRUE if a line 0 to 31 of the BCM chip, otherwise FALSE
+ */
+int bankRegisterBit(int, uint32_t*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,1316 @@
+/*
+ * ****************************************************************************
+ * GIPY Library
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ *
+ * Benchmark program. Each benchmark is a sub command:
+ *      execBench <benchmark> [parameters]
+ * Benchmarks run on the simulated backend (No GPIO required), unless
+ * stated otherwise. Build with 'make bench' (Debug messages disabled).
+ * ****************************************************************************
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gipy.h"
+#include "simul.h"
+#include "spi.h"
+#include "bank.h"
+#include "filter.h"
+#include "capture.h"
+#include "pwm.h"
+#include "decoder.h"
+#include "motion.h"
+#include "shift.h"
+
+
+// ****************************************************************************
+// Constants - General variable
+// ****************************************************************************
+#define BENCH_PIN       17
+#define EDGES_DURATION  0.5 //Default virtual seconds per edges run
+#define EDGES_SPEED     1.0 //Default virtual clock speed
+#define SPI_BYTES       4096 //Default bytes per SPI transfer
+#define SPI_PIN_CS      8
+#define SPI_PIN_SCLK    11
+#define SPI_PIN_MOSI    10
+#define SPI_PIN_MISO    9
+#define TOGGLE_COUNT    200000 //Default writes per toggle run
+#define BANK_PINS       8 //Default pins per bank
+#define BANK_LOOPS      20000 //Default bank calls per run
+#define BANK_FIRST_PIN  2 //Bank pins are BANK_FIRST_PIN, BANK_FIRST_PIN+1...
+#define FILTER_LOOPS    200000 //Default samples per filter run
+#define FILTER_WINDOW   5 //Filter window (M), majority vote
+#define FILTER_NOISE    20 //One glitch every FILTER_NOISE samples per pin
+#define FILTER_SET      1024 //Generated samples (Played in loop)
+#define CAPTURE_RATE    100000 //Default samples per second
+#define CAPTURE_PINS    8 //Default captured pins
+#define CAPTURE_SECONDS 1 //Capture duration
+#define CAPTURE_VCD     "/tmp/gipy-capture.vcd"
+#define PWM_UPDATES     200000 //Default duty cycle updates per run
+#define PWM_PERIOD      1000000 //1 kHz (ns)
+#define THREADS_MAX     8 //Default max threads (Doubled from 1)
+#define THREADS_OPS     50000 //Default write + read pairs per thread
+#define DECODER_FRAMES  100000 //Default frames per protocol run
+#define DECODER_JITTER  10 //Pulse width jitter (Percent)
+#define DECODER_DROP    1000 //One edge lost every DECODER_DROP edges (Lossy run)
+#define DECODER_SET     64 //Generated frames (Played in loop)
+#define DECODER_PULSES  96 //Max pulses per generated frame
+#define MOTION_SPEED    5000 //Default max speed (Steps/s)
+#define MOTION_STEPS    5000 //Default steps of the leading axis
+#define MOTION_ACCEL    50000 //Steps/s^2
+#define SHIFT_BITS      32 //Default outputs of the chain (4 x 74HC595)
+#define SHIFT_REFRESHES 200 //Synced refreshes per run
+#define SHIFT_RATE      20000 //Max refreshes per second
+#define SHIFT_PIN_BASE  1000 //First virtual pin
+#define SHIFT_WRITES    10000 //Virtual pin writes of the merge run
+#define SNAPSHOT_PINS   16 //Default pins of the mode switch
+#define SNAPSHOT_LOOPS  500 //Default mode switches per run
+#define CLOCK_READS     2000000 //Default timestamps per run
+#define CLOCK_SECONDS   2 //Default drift measure duration
+#define MIRROR_READS    1000000 //Default reads per run
+#define MIRROR_AGE_US   1000 //Default max age of the mirrored level (us)
+
+/**
+ * @brief Describe one benchmark (Sub command)
+ */
+typedef struct {
+    const char  *name;
+    const char  *usage;
+    int         (*run)(int, char**);
+} benchEntry;
+
+int benchEdges(int, char**);
+int benchSpi(int, char**);
+int benchToggle(int, char**);
+int benchBank(int, char**);
+int benchFilter(int, char**);
+int benchCapture(int, char**);
+int benchPwm(int, char**);
+int benchThreads(int, char**);
+int benchDecoder(int, char**);
+int benchMotion(int, char**);
+int benchShift(int, char**);
+int benchSnapshot(int, char**);
+int benchClock(int, char**);
+int benchMirror(int, char**);
+
+static const benchEntry benches[] = {
+    {"edges",   "edges [fixed|poisson|bursty|bounce] [rate] [seconds] [speed]", benchEdges},
+    {"spi",     "spi [bytes]", benchSpi},
+    {"toggle",  "toggle [count]", benchToggle},
+    {"bank",    "bank [pins] [loops]", benchBank},
+    {"filter",  "filter [loops]", benchFilter},
+    {"capture", "capture [rate] [pins]", benchCapture},
+    {"pwm",     "pwm [updates]", benchPwm},
+    {"threads", "threads [max threads] [ops]", benchThreads},
+    {"decoder", "decoder [frames]", benchDecoder},
+    {"motion",  "motion [speed] [steps]", benchMotion},
+    {"shift",   "shift [bits]", benchShift},
+    {"snapshot", "snapshot [pins] [loops]", benchSnapshot},
+    {"clock",   "clock [reads] [seconds]", benchClock},
+    {"mirror",  "mirror [reads] [max age us]", benchMirror}
+};
+#define NB_BENCHES (int)(sizeof(benches) / sizeof(benches[0]))
+
+static volatile uint64_t isrCalls = 0;
+
+
+// ****************************************************************************
+// Tools functions
+// ****************************************************************************
+static void countingIsr(){
+    isrCalls++;
+}
+
+/**
+ * @brief           Get the profile from its name
+ *
+ * @param pName     Profile name
+ * @return          Profile, -1 if unknown
+ */
+static int profileFromName(const char *pName){
+    static const char *names[] = {"fixed", "poisson", "bursty", "bounce"};
+    int k;
+    for(k=0; k<4; k++){
+        if(strcmp(names[k], pName) == 0){
+            return k;
+        }
+    }
+    return -1;
+}
+
+
+// ****************************************************************************
+// Edges benchmark
+// ****************************************************************************
+/**
+ * @brief           Run one edge stream on the bench pin and display results
+ *
+ * @param pStream   Stream to generate
+ * @param pRate     Average edges/s of the stream (Displayed)
+ * @param pDuration Virtual seconds to run
+ */
+static void runEdgeStream(const simStream *pStream, double pRate, double pDuration){
+    static const char *names[] = {"fixed", "poisson", "bursty", "bounce"};
+    simStats    gen;
+    pinStats    evt;
+
+    GIPY_simResetStats(BENCH_PIN);
+    GIPY_pinResetStats(BENCH_PIN);
+    isrCalls = 0;
+
+    uint64_t start = GIPY_clockNow();
+    GIPY_simSetStream(BENCH_PIN, pStream);
+    GIPY_clockSleep((uint64_t)(pDuration * NSEC_PER_SEC));
+    GIPY_simSetStream(BENCH_PIN, NULL);
+    uint64_t elapsed = GIPY_clockNow() - start;
+    GIPY_clockSleep(10 * NSEC_PER_MSEC); //Let the handler drain
+
+    GIPY_simGetStats(BENCH_PIN, &gen);
+    GIPY_pinGetStats(BENCH_PIN, &evt);
+    double drop = (gen.notified > 0) ? 100.0 * (double)(gen.notified - evt.events) / gen.notified : 0.0;
+    double avg  = (evt.events > 0) ? (double)evt.latencyTotal / evt.events / 1000.0 : 0.0;
+    printf("%-8s %10.0f %10llu %10llu %10llu %7.2f%% %12.0f %10.1f %10.1f\n",
+            names[pStream->profile], pRate,
+            (unsigned long long)gen.generated,
+            (unsigned long long)gen.notified,
+            (unsigned long long)evt.events, drop,
+            (double)evt.events * NSEC_PER_SEC / elapsed,
+            avg, evt.latencyMax / 1000.0);
+}
+
+/**
+ * @brief   Measure throughput, drop rate and latency of the interrupt path
+ */
+int benchEdges(int argc, char **argv){
+    static const double rates[] = {1e4, 1e5, 1e6};
+    double  duration    = (argc > 2) ? atof(argv[2]) : EDGES_DURATION;
+    double  speed       = (argc > 3) ? atof(argv[3]) : EDGES_SPEED;
+    int     profile     = (argc > 0) ? profileFromName(argv[0]) : -1;
+    double  rate        = (argc > 1) ? atof(argv[1]) : 0.0;
+
+    if(argc > 0 && profile == -1){
+        printError(NULL, "Unknown profile %s", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(GIPY_simEnable(NULL, speed) != GE_OK
+            || GIPY_pinExport(BENCH_PIN) != GE_OK
+            || GIPY_pinSetDirectionIn(BENCH_PIN) != GE_OK
+            || GIPY_pinSetEdgeBoth(BENCH_PIN) != GE_OK
+            || GIPY_pinCreateInterrupt(BENCH_PIN, &countingIsr) != GE_OK){
+        printError(NULL, "Unable to set the simulated bench pin");
+        return EXIT_FAILURE;
+    }
+    GIPY_clockSleep(1100 * NSEC_PER_MSEC); //Handler start delay
+
+    printf("Edges: %.2f virtual s per run, clock speed %.1f\n", duration, speed);
+    printf("%-8s %10s %10s %10s %10s %8s %12s %10s %10s\n",
+            "profile", "edges/s", "generated", "notified", "handled", "drop",
+            "handled/s", "lat avg us", "lat max us");
+    int p, r;
+    for(p=0; p<4; p++){
+        if(profile != -1 && p != profile){
+            continue;
+        }
+        for(r=0; r<3; r++){
+            if(rate > 0.0 && r > 0){
+                break;
+            }
+            simStream stream;
+            memset(&stream, 0, sizeof(simStream));
+            stream.profile      = p;
+            stream.rate         = (rate > 0.0) ? rate : rates[r];
+            stream.burstSize    = 8;
+            stream.burstRate    = stream.rate * 10.0;
+            //Bursts and toggles rates are set to give the same edges count
+            if(p == SIM_BURSTY){
+                stream.rate         = stream.rate / 8.0;
+            }
+            if(p == SIM_BOUNCE){
+                stream.burstSize    = 5;
+                stream.rate         = stream.rate / 11.0;
+            }
+            runEdgeStream(&stream, (rate > 0.0) ? rate : rates[r], duration);
+        }
+    }
+
+    GIPY_pinUnexport(BENCH_PIN);
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// SPI benchmark
+// ****************************************************************************
+/**
+ * @brief           Reference transfer: one pin call per clock edge and bit
+ *
+ * @param pTx       Bytes to send (Mode 0, MSB first)
+ * @param pLen      Number of bytes
+ */
+static void spiPinByPin(const uint8_t *pTx, size_t pLen){
+    size_t k;
+    int b, miso;
+    GIPY_pinWrite(SPI_PIN_CS, LOGIC_ZERO);
+    for(k=0; k<pLen; k++){
+        for(b=7; b>=0; b--){
+            GIPY_pinWrite(SPI_PIN_MOSI, (pTx[k] >> b) & 0x01);
+            GIPY_pinWrite(SPI_PIN_SCLK, LOGIC_ONE);
+            GIPY_pinRead(SPI_PIN_MISO, &miso);
+            GIPY_pinWrite(SPI_PIN_SCLK, LOGIC_ZERO);
+        }
+    }
+    GIPY_pinWrite(SPI_PIN_CS, LOGIC_ONE);
+}
+
+/**
+ * @brief   Measure the bit-banged SPI throughput (Each mode) against
+ *          a transfer done with GIPY_pinWrite / GIPY_pinRead
+ */
+int benchSpi(int argc, char **argv){
+    size_t      len = (argc > 0) ? (size_t)atol(argv[0]) : SPI_BYTES;
+    int         pins[] = {SPI_PIN_CS, SPI_PIN_SCLK, SPI_PIN_MOSI, SPI_PIN_MISO};
+    spiConfig   config = {SPI_PIN_CS, SPI_PIN_SCLK, SPI_PIN_MOSI, SPI_PIN_MISO, 0, FALSE, 0};
+    spiBus      bus;
+    int         k;
+
+    uint8_t *tx = malloc(len);
+    uint8_t *rx = malloc(len);
+    if(tx == NULL || rx == NULL || len == 0 || GIPY_simEnable(NULL, 1.0) != GE_OK){
+        printError(NULL, "Unable to set the SPI bench");
+        return EXIT_FAILURE;
+    }
+    for(k=0; k<4; k++){
+        GIPY_pinExport(pins[k]);
+    }
+    for(k=0; k<(int)len; k++){
+        tx[k] = (uint8_t)k;
+    }
+
+    printf("SPI: %zu bytes per transfer (Simulated sysfs)\n", len);
+    printf("%-14s %8s %12s\n", "transfer", "backend", "kbit/s");
+
+    //Reference: one call per edge
+    GIPY_pinSetDirectionLow(SPI_PIN_SCLK);
+    GIPY_pinSetDirectionLow(SPI_PIN_MOSI);
+    GIPY_pinSetDirectionHigh(SPI_PIN_CS);
+    GIPY_pinSetDirectionIn(SPI_PIN_MISO);
+    uint64_t start = GIPY_clockNow();
+    spiPinByPin(tx, len);
+    double elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-14s %8s %12.1f\n", "pin by pin", "sysfs", len * 8.0 * 1e6 / elapsed);
+
+    //Engine, each mode
+    for(config.mode=0; config.mode<4; config.mode++){
+        char name[32];
+        if(GIPY_spiOpen(&bus, &config) != GE_OK){
+            printError(NULL, "Unable to open SPI bus");
+            break;
+        }
+        start = GIPY_clockNow();
+        GIPY_spiTransfer(&bus, tx, rx, len);
+        elapsed = (double)(GIPY_clockNow() - start);
+        sprintf(name, "spi mode %d", config.mode);
+        printf("%-14s %8s %12.1f\n", name, GIPY_bankBackendName(bus.out.backend),
+                len * 8.0 * 1e6 / elapsed);
+        GIPY_spiClose(&bus);
+    }
+
+    for(k=0; k<4; k++){
+        GIPY_pinUnexport(pins[k]);
+    }
+    GIPY_simDisable();
+    free(tx);
+    free(rx);
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Toggle benchmark
+// ****************************************************************************
+/**
+ * @brief   Measure the write rate of an output pin, through the int
+ *          functions (Lookup and checks each call) and through a handle
+ */
+int benchToggle(int argc, char **argv){
+    long        count = (argc > 0) ? atol(argv[0]) : TOGGLE_COUNT;
+    GIPY_Pin    *pin;
+    long        k;
+    int         value;
+
+    if(count <= 0 || GIPY_simEnable(NULL, 1.0) != GE_OK
+            || GIPY_pinExport(BENCH_PIN) != GE_OK
+            || GIPY_pinSetDirectionLow(BENCH_PIN) != GE_OK
+            || (pin = GIPY_pinOpen(BENCH_PIN)) == NULL){
+        printError(NULL, "Unable to set the toggle bench");
+        return EXIT_FAILURE;
+    }
+    printf("Toggle: %ld writes per run (Simulated sysfs)\n", count);
+    printf("%-18s %12s %10s\n", "api", "writes/s", "ns/write");
+
+    uint64_t start = GIPY_clockNow();
+    for(k=0; k<count; k++){
+        GIPY_pinWrite(BENCH_PIN, k & 0x01);
+    }
+    double elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-18s %12.0f %10.1f\n", "GIPY_pinWrite", count * 1e9 / elapsed, elapsed / count);
+
+    start = GIPY_clockNow();
+    for(k=0; k<count; k++){
+        GIPY_handleToggle(pin);
+    }
+    elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-18s %12.0f %10.1f\n", "GIPY_handleToggle", count * 1e9 / elapsed, elapsed / count);
+
+    start = GIPY_clockNow();
+    for(k=0; k<count; k++){
+        GIPY_handleRead(pin, &value);
+    }
+    elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-18s %12.0f %10.1f\n", "GIPY_handleRead", count * 1e9 / elapsed, elapsed / count);
+
+    GIPY_pinUnexport(BENCH_PIN);
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Bank benchmark
+// ****************************************************************************
+/**
+ * @brief   Measure bank reads and writes (All pins changing) for each value
+ *          files backend: time and syscalls per call
+ */
+int benchBank(int argc, char **argv){
+    static const bankBackend backends[] = {BANK_SYSFS, BANK_URING};
+    int     nbPins  = (argc > 0) ? atoi(argv[0]) : BANK_PINS;
+    long    loops   = (argc > 1) ? atol(argv[1]) : BANK_LOOPS;
+    int     pins[BANK_MAX_PINS];
+    pinBank bank;
+    int     k, b;
+    long    n;
+
+    if(nbPins < 1 || nbPins > 24 || loops <= 0 || GIPY_simEnable(NULL, 1.0) != GE_OK){
+        printError(NULL, "Unable to set the bank bench (1 to 24 pins)");
+        return EXIT_FAILURE;
+    }
+    for(k=0; k<nbPins; k++){
+        pins[k] = BANK_FIRST_PIN + k;
+        GIPY_pinExport(pins[k]);
+        GIPY_pinSetDirectionLow(pins[k]);
+    }
+    if(GIPY_bankOpen(&bank, pins, nbPins) != GE_OK){
+        printError(NULL, "Unable to open the bank");
+        return EXIT_FAILURE;
+    }
+
+    uint32_t mask = (1U << nbPins) - 1;
+    printf("Bank: %d pins, %ld calls per run (Simulated sysfs)\n", nbPins, loops);
+    printf("%-10s %-6s %12s %14s\n", "backend", "call", "ns/call", "syscalls/call");
+    for(b=0; b<2; b++){
+        if(GIPY_bankSetBackend(&bank, backends[b]) != GE_OK){
+            printf("%-10s not available\n", GIPY_bankBackendName(backends[b]));
+            continue;
+        }
+        uint32_t values;
+        bank.syscalls   = 0;
+        uint64_t start  = GIPY_clockNow();
+        for(n=0; n<loops; n++){
+            GIPY_bankRead(&bank, mask, &values);
+        }
+        double elapsed = (double)(GIPY_clockNow() - start);
+        printf("%-10s %-6s %12.1f %14.2f\n", GIPY_bankBackendName(backends[b]), "read",
+                elapsed / loops, (double)bank.syscalls / loops);
+
+        bank.syscalls   = 0;
+        start           = GIPY_clockNow();
+        for(n=0; n<loops; n++){
+            GIPY_bankWrite(&bank, mask, (n & 0x01) ? mask : 0);
+        }
+        elapsed = (double)(GIPY_clockNow() - start);
+        printf("%-10s %-6s %12.1f %14.2f\n", GIPY_bankBackendName(backends[b]), "write",
+                elapsed / loops, (double)bank.syscalls / loops);
+    }
+
+    GIPY_bankClose(&bank);
+    for(k=0; k<nbPins; k++){
+        GIPY_pinUnexport(pins[k]);
+    }
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Filter benchmark
+// ****************************************************************************
+/**
+ * @brief   Filter noisy samples with the vertical counters (GIPY_filterPush)
+ *          and with one counter per pin (Shift register and popcount), for
+ *          8 to 256 pins. Both must find the same number of changes.
+ */
+int benchFilter(int argc, char **argv){
+    static const int    sizes[]     = {8, 32, 64, 128, 256};
+    static uint64_t     set[FILTER_SET][FILTER_MAX_LANES];
+    static uint32_t     shifts[FILTER_MAX_PINS];
+    static uint8_t      levels[FILTER_MAX_PINS];
+    long                loops       = (argc > 0) ? atol(argv[0]) : FILTER_LOOPS;
+    int                 threshold   = FILTER_WINDOW / 2 + 1;
+    uint32_t            window      = (1U << FILTER_WINDOW) - 1;
+    uint32_t            rng         = 2463534242U;
+    uint64_t            clean[FILTER_MAX_LANES] = {0};
+    pinFilter           filter;
+    int                 s, k, l;
+    long                n;
+
+    if(loops <= 0){
+        printError(NULL, "Unable to set the filter bench");
+        return EXIT_FAILURE;
+    }
+
+    //Slow clean signals (One change every 64 samples) with random glitches
+    for(n=0; n<FILTER_SET; n++){
+        for(k=0; k<FILTER_MAX_PINS; k++){
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            if(((n + k) % 64) == 0){
+                clean[k / 64] ^= 1ULL << (k % 64);
+            }
+            uint64_t glitch = ((rng % FILTER_NOISE) == 0) ? 1ULL << (k % 64) : 0;
+            set[n][k / 64]  = (set[n][k / 64] & ~(1ULL << (k % 64)))
+                            | ((clean[k / 64] ^ glitch) & (1ULL << (k % 64)));
+        }
+    }
+
+    printf("Filter: %d of %d, %ld samples per run, 1 glitch every %d samples\n",
+            threshold, FILTER_WINDOW, loops, FILTER_NOISE);
+    printf("%-6s %-10s %12s %14s %10s\n", "pins", "filter", "ns/sample", "ns/pin/sample", "changes");
+    for(s=0; s<(int)(sizeof(sizes) / sizeof(sizes[0])); s++){
+        int         nbPins  = sizes[s];
+        int         nbLanes = (nbPins + 63) / 64;
+        uint64_t    lastMask = (nbPins % 64) ? (1ULL << (nbPins % 64)) - 1 : ~0ULL;
+        uint64_t    sample[FILTER_MAX_LANES];
+        uint64_t    changes = 0;
+
+        //Vertical counters: all pins of a lane at once
+        GIPY_filterInit(&filter, nbPins, FILTER_WINDOW, threshold);
+        uint64_t start = GIPY_clockNow();
+        for(n=0; n<loops; n++){
+            uint64_t changed[FILTER_MAX_LANES];
+            memcpy(sample, set[n % FILTER_SET], sizeof(sample));
+            sample[nbLanes - 1] &= lastMask;
+            if(GIPY_filterPush(&filter, sample, changed) == TRUE){
+                for(l=0; l<nbLanes; l++){
+                    changes += __builtin_popcountll(changed[l]);
+                }
+            }
+        }
+        double elapsed = (double)(GIPY_clockNow() - start);
+        printf("%-6d %-10s %12.1f %14.3f %10llu\n", nbPins, "vertical", elapsed / loops,
+                elapsed / loops / nbPins, (unsigned long long)changes);
+
+        //Reference: one shift register per pin
+        changes = 0;
+        start   = GIPY_clockNow();
+        for(n=0; n<loops; n++){
+            const uint64_t *in = set[n % FILTER_SET];
+            for(k=0; k<nbPins; k++){
+                uint32_t bit    = (in[k / 64] >> (k % 64)) & 0x01;
+                shifts[k]       = (n == 0) ? bit * window : ((shifts[k] << 1) | bit) & window;
+                int count       = __builtin_popcount(shifts[k]);
+                uint8_t next    = (count >= threshold) ? 1 : (count <= FILTER_WINDOW - threshold) ? 0 : levels[k];
+                changes         += (n > 0 && next != levels[k]) ? 1 : 0;
+                levels[k]       = next;
+            }
+        }
+        elapsed = (double)(GIPY_clockNow() - start);
+        printf("%-6d %-10s %12.1f %14.3f %10llu\n", nbPins, "per-pin", elapsed / loops,
+                elapsed / loops / nbPins, (unsigned long long)changes);
+    }
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Capture benchmark
+// ****************************************************************************
+/**
+ * @brief   Capture simulated pins (Poisson edges, 100 to 800 edges/s) during
+ *          CAPTURE_SECONDS: missed samples, compression and VCD size
+ */
+int benchCapture(int argc, char **argv){
+    long            rate    = (argc > 0) ? atol(argv[0]) : CAPTURE_RATE;
+    int             nbPins  = (argc > 1) ? atoi(argv[1]) : CAPTURE_PINS;
+    captureConfig   config;
+    capture         cap;
+    int             k;
+
+    if(rate <= 0 || nbPins < 1 || nbPins > 24 || GIPY_simEnable(NULL, 1.0) != GE_OK){
+        printError(NULL, "Unable to set the capture bench (1 to 24 pins)");
+        return EXIT_FAILURE;
+    }
+    memset(&config, 0, sizeof(captureConfig));
+    config.nbPins       = nbPins;
+    config.sampleRate   = (uint32_t)rate;
+    config.preTrigger   = (uint32_t)rate / 10;
+    config.postTrigger  = (uint32_t)rate * CAPTURE_SECONDS;
+    config.trigger.rising = 0x01; //First rising edge of the first pin
+    for(k=0; k<nbPins; k++){
+        simStream stream;
+        memset(&stream, 0, sizeof(simStream));
+        stream.profile  = SIM_POISSON;
+        stream.rate     = 100.0 * (1 + k % 8);
+        stream.seed     = k + 1;
+        config.pins[k]  = BANK_FIRST_PIN + k;
+        GIPY_pinExport(config.pins[k]);
+        GIPY_pinSetDirectionIn(config.pins[k]);
+        GIPY_simSetStream(config.pins[k], &stream);
+    }
+    if(GIPY_captureOpen(&cap, &config) != GE_OK){
+        printError(NULL, "Unable to open the capture");
+        return EXIT_FAILURE;
+    }
+    for(k=0; k<100 * (CAPTURE_SECONDS + 2) && (GIPY_captureGetState(&cap) == CAPTURE_ARMED
+            || GIPY_captureGetState(&cap) == CAPTURE_TRIGGERED); k++){
+        GIPY_clockSleep(10 * NSEC_PER_MSEC);
+    }
+    GIPY_captureStop(&cap);
+    if(GIPY_captureGetState(&cap) == CAPTURE_ARMED){
+        printf("Not triggered (%llu samples, %llu missed)\n",
+                (unsigned long long)cap.samples, (unsigned long long)cap.missed);
+    }
+
+    uint32_t runs = cap.head - cap.tail;
+    printf("Capture: %d pins, %ld samples/s, %d s after trigger (Simulated sysfs, %s)\n",
+            nbPins, rate, CAPTURE_SECONDS, GIPY_bankBackendName(cap.bank.backend));
+    printf("%-14s %llu\n", "samples", (unsigned long long)cap.ringSamples);
+    printf("%-14s %llu (%llu stalls)\n", "missed", (unsigned long long)cap.missed,
+            (unsigned long long)cap.stalls);
+    printf("%-14s %u (%.1f samples/run, %.1f bytes/sample)\n", "runs", runs,
+            (double)cap.ringSamples / runs, (double)runs * sizeof(captureRun) / cap.ringSamples);
+    if(GIPY_captureWriteVcd(&cap, CAPTURE_VCD) == GE_OK){
+        FILE *file = fopen(CAPTURE_VCD, "r");
+        fseek(file, 0, SEEK_END);
+        printf("%-14s %s (%ld bytes)\n", "vcd", CAPTURE_VCD, ftell(file));
+        fclose(file);
+    }
+
+    GIPY_captureClose(&cap);
+    for(k=0; k<nbPins; k++){
+        GIPY_pinUnexport(config.pins[k]);
+    }
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// PWM benchmark
+// ****************************************************************************
+/**
+ * @brief   Measure duty cycle updates: one write on the kept duty_cycle
+ *          file, against open / write / close of the file each update
+ */
+int benchPwm(int argc, char **argv){
+    long        updates = (argc > 0) ? atol(argv[0]) : PWM_UPDATES;
+    pwmChannel  pwm;
+    char        path[PATH_MAX + 64];
+    char        text[24];
+    long        k;
+
+    if(updates <= 0 || GIPY_simEnable(NULL, 1.0) != GE_OK
+            || GIPY_pwmExport(&pwm, 0, 0) != GE_OK
+            || GIPY_pwmSetPeriod(&pwm, PWM_PERIOD) != GE_OK
+            || GIPY_pwmEnable(&pwm, TRUE) != GE_OK){
+        printError(NULL, "Unable to set the pwm bench");
+        return EXIT_FAILURE;
+    }
+    pwmRootOf(GIPY_getSysfsRoot(), path);
+    strcat(path, "pwmchip0/pwm0/duty_cycle");
+    printf("Pwm: %ld duty cycle updates per run (Simulated sysfs)\n", updates);
+    printf("%-18s %12s %11s\n", "api", "updates/s", "ns/update");
+
+    uint64_t start = GIPY_clockNow();
+    for(k=0; k<updates; k++){
+        GIPY_pwmSetDuty(&pwm, (k * 7919) % PWM_PERIOD);
+    }
+    double elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-18s %12.0f %11.1f\n", "GIPY_pwmSetDuty", updates * 1e9 / elapsed, elapsed / updates);
+
+    start = GIPY_clockNow();
+    for(k=0; k<updates; k++){
+        int len     = sprintf(text, "%ld\n", (k * 7919) % PWM_PERIOD);
+        int file    = open(path, O_WRONLY);
+        if(file == -1 || write(file, text, len) != len){
+            printError(NULL, "Unable to write the duty cycle file");
+            break;
+        }
+        close(file);
+    }
+    elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-18s %12.0f %11.1f\n", "open/write/close", k * 1e9 / elapsed, elapsed / k);
+
+    GIPY_pwmEnable(&pwm, FALSE);
+    GIPY_pwmUnexport(&pwm);
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Threads benchmark
+// ****************************************************************************
+/**
+ * @brief Work of one stress thread
+ */
+typedef struct {
+    int         pin;
+    long        ops;
+    long        errors;     //Functions not GE_OK, or invalid values read
+    pthread_t   thread;
+} threadWork;
+
+/**
+ * @brief   Stress thread: write then read its pin
+ */
+static void *stressThread(void *pWork){
+    threadWork  *work = (threadWork *)pWork;
+    int         value;
+    long        k;
+    for(k=0; k<work->ops; k++){
+        if(GIPY_pinWrite(work->pin, k & 0x01) != GE_OK
+                || GIPY_pinRead(work->pin, &value) != GE_OK
+                || (value != 0 && value != 1)){
+            work->errors++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief   Run the stress threads, return the elapsed time (ns)
+ */
+static uint64_t runStress(threadWork *pWorks, int pNbThreads, long *pErrors){
+    int         k;
+    uint64_t    start = GIPY_clockNow();
+    for(k=0; k<pNbThreads; k++){
+        pthread_create(&pWorks[k].thread, NULL, &stressThread, &pWorks[k]);
+    }
+    for(k=0; k<pNbThreads; k++){
+        pthread_join(pWorks[k].thread, NULL);
+        *pErrors += pWorks[k].errors;
+    }
+    return GIPY_clockNow() - start;
+}
+
+/**
+ * @brief   Measure the int functions from many threads: one pin per thread
+ *          (Should scale with the cores), then all threads on one pin
+ *          (Checks that concurrent accesses do not fail)
+ */
+int benchThreads(int argc, char **argv){
+    int         maxThreads  = (argc > 0) ? atoi(argv[0]) : THREADS_MAX;
+    long        ops         = (argc > 1) ? atol(argv[1]) : THREADS_OPS;
+    threadWork  works[BANK_MAX_PINS];
+    int         nb, k;
+
+    if(maxThreads < 1 || maxThreads > 20 || ops <= 0 || GIPY_simEnable(NULL, 1.0) != GE_OK){
+        printError(NULL, "Unable to set the threads bench (1 to 20 threads)");
+        return EXIT_FAILURE;
+    }
+    for(k=0; k<maxThreads; k++){
+        GIPY_pinExport(BANK_FIRST_PIN + k);
+        GIPY_pinSetDirectionLow(BANK_FIRST_PIN + k);
+    }
+    printf("Threads: %ld write + read per thread, %ld cores (Simulated sysfs)\n",
+            ops, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s %-8s %12s %9s %8s\n", "pins", "threads", "ops/s", "speedup", "errors");
+    double single = 0.0;
+    for(k=0; k<2; k++){
+        for(nb=1; nb<=maxThreads; nb=(nb < maxThreads && nb * 2 > maxThreads) ? maxThreads : nb * 2){
+            long    errors  = 0;
+            int     n;
+            for(n=0; n<nb; n++){
+                works[n].pin    = (k == 0) ? BANK_FIRST_PIN + n : BANK_FIRST_PIN;
+                works[n].ops    = ops;
+                works[n].errors = 0;
+            }
+            double  elapsed = (double)runStress(works, nb, &errors);
+            double  rate    = 2.0 * ops * nb * 1e9 / elapsed;
+            single          = (nb == 1) ? rate : single;
+            printf("%-8s %-8d %12.0f %8.2fx %8ld\n", (k == 0) ? "own" : "shared",
+                    nb, rate, rate / single, errors);
+        }
+    }
+
+    for(k=0; k<maxThreads; k++){
+        GIPY_pinUnexport(BANK_FIRST_PIN + k);
+    }
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Decoder benchmark
+// ****************************************************************************
+/**
+ * @brief           Build the pulses of one frame (First pulse is the idle
+ *                  high level before the frame, then levels alternate)
+ *
+ * @param pProtocol GIPY_protocolNec or GIPY_protocolDht22
+ * @param pIndex    Frame index (Gives the data, one NEC repeat code in 4)
+ * @param pWidths   Filled with the widths in us (DECODER_PULSES)
+ * @return          Number of pulses
+ */
+static int buildFrame(const pulseProtocol *pProtocol, uint32_t pIndex, uint32_t *pWidths){
+    uint8_t data[5];
+    int     n = 0;
+    int     k;
+
+    if(pProtocol == &GIPY_protocolNec){
+        data[0] = pIndex;
+        data[1] = ~data[0];
+        data[2] = pIndex >> 8;
+        data[3] = ~data[2];
+        pWidths[n++] = 40000;
+        pWidths[n++] = 9000;
+        if(pIndex % 4 == 3){
+            pWidths[n++] = 2250;
+            pWidths[n++] = 562;
+            return n;
+        }
+        pWidths[n++] = 4500;
+        for(k=0; k<32; k++){
+            pWidths[n++] = 562;
+            pWidths[n++] = ((data[k / 8] >> (k % 8)) & 0x01) ? 1687 : 562;
+        }
+        pWidths[n++] = 562;
+        return n;
+    }
+
+    //DHT22: humidity 50.0 to 89.9 %, temperature -20.0 to 39.9 C
+    int temp = (int)(pIndex % 600) - 200;
+    int humidity = 500 + pIndex % 400;
+    data[0] = humidity >> 8;
+    data[1] = humidity;
+    data[2] = ((temp < 0 ? -temp : temp) >> 8) | ((temp < 0) ? 0x80 : 0);
+    data[3] = (temp < 0) ? -temp : temp;
+    data[4] = data[0] + data[1] + data[2] + data[3];
+    pWidths[n++] = 30;
+    pWidths[n++] = 80;
+    pWidths[n++] = 80;
+    for(k=0; k<40; k++){
+        pWidths[n++] = 50;
+        pWidths[n++] = ((data[k / 8] >> (7 - k % 8)) & 0x01) ? 70 : 26;
+    }
+    pWidths[n++] = 50;
+    return n;
+}
+
+/**
+ * @brief   Decode generated NEC and DHT22 frames with jitter, given edge
+ *          by edge to the protocol state machines (No pin, replay), then
+ *          with lost edges (Framing errors, frames dropped)
+ */
+int benchDecoder(int argc, char **argv){
+    static const pulseProtocol  *protocols[] = {&GIPY_protocolNec, &GIPY_protocolDht22};
+    static uint64_t             widths[DECODER_SET][DECODER_PULSES];
+    static int                  nbPulses[DECODER_SET];
+    long                        frames  = (argc > 0) ? atol(argv[0]) : DECODER_FRAMES;
+    uint32_t                    rng     = 2463534242U;
+    uint32_t                    us[DECODER_PULSES];
+    pulseDecoder                decoder;
+    decodedFrame                frame;
+    int                         p, d, k;
+    long                        f;
+
+    if(frames <= 0){
+        printError(NULL, "Unable to set the decoder bench");
+        return EXIT_FAILURE;
+    }
+    printf("Decoder: %ld frames per run, %d%% jitter, lossy run drops 1 edge in %d\n",
+            frames, DECODER_JITTER, DECODER_DROP);
+    printf("%-8s %-7s %10s %10s %10s %10s\n", "protocol", "edges", "ns/edge", "sent", "decoded", "errors");
+    for(p=0; p<2; p++){
+        for(f=0; f<DECODER_SET; f++){
+            nbPulses[f] = buildFrame(protocols[p], f, us);
+            for(k=0; k<nbPulses[f]; k++){
+                rng ^= rng << 13;
+                rng ^= rng >> 17;
+                rng ^= rng << 5;
+                int jitter      = (int)(rng % (2 * DECODER_JITTER + 1)) - DECODER_JITTER;
+                widths[f][k]    = (uint64_t)us[k] * (100 + jitter) * 10; //ns
+            }
+        }
+        for(d=0; d<2; d++){
+            uint64_t    stamp   = 0;
+            uint64_t    decoded = 0;
+            long        edges   = 0;
+            GIPY_decoderOpen(&decoder, -1, protocols[p]);
+            uint64_t start = GIPY_clockNow();
+            for(f=0; f<frames; f++){
+                const uint64_t *w = widths[f % DECODER_SET];
+                for(k=0; k<nbPulses[f % DECODER_SET]; k++){
+                    stamp += w[k];
+                    edges++;
+                    if(d == 0 || edges % DECODER_DROP != 0){
+                        GIPY_decoderEdge(&decoder, k % 2, stamp); //Pulse k is high if even
+                    }
+                }
+                while(GIPY_decoderGetFrame(&decoder, &frame) == TRUE){
+                    decoded++;
+                }
+            }
+            double elapsed = (double)(GIPY_clockNow() - start);
+            printf("%-8s %-7s %10.1f %10ld %10llu %10llu\n", protocols[p]->name,
+                    (d == 0) ? "all" : "lossy", elapsed / edges, frames,
+                    (unsigned long long)decoded,
+                    (unsigned long long)GIPY_decoderGetErrors(&decoder));
+            GIPY_decoderClose(&decoder);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Motion benchmark
+// ****************************************************************************
+/**
+ * @brief   Run a two axes move with the motion engine (Trapezoid, S-curve)
+ *          and measure the step lateness, against steps written by the
+ *          application (GIPY_pinWrite, then sleep one period)
+ */
+int benchMotion(int argc, char **argv){
+    static const char   *names[] = {"trapezoid", "s-curve"};
+    uint32_t            speed   = (argc > 0) ? (uint32_t)atol(argv[0]) : MOTION_SPEED;
+    long                steps   = (argc > 1) ? atol(argv[1]) : MOTION_STEPS;
+    motionConfig        config;
+    motionEngine        engine;
+    motionStats         stats;
+    int                 p, k;
+
+    if(speed == 0 || steps <= 0 || GIPY_simEnable(NULL, 1.0) != GE_OK){
+        printError(NULL, "Unable to set the motion bench");
+        return EXIT_FAILURE;
+    }
+    memset(&config, 0, sizeof(config));
+    config.nbAxes       = 2;
+    config.maxSpeed     = speed;
+    config.acceleration = MOTION_ACCEL;
+    for(k=0; k<4; k++){
+        GIPY_pinExport(BANK_FIRST_PIN + k);
+    }
+    for(k=0; k<2; k++){
+        config.stepPins[k]  = BANK_FIRST_PIN + k;
+        config.dirPins[k]   = BANK_FIRST_PIN + 2 + k;
+    }
+    printf("Motion: %ld + %ld steps, %u steps/s, %u steps/s2 (Simulated sysfs)\n",
+            steps, steps / 3, speed, MOTION_ACCEL);
+    printf("%-10s %10s %10s %12s %12s %8s\n", "profile", "steps", "seconds",
+            "mean late us", "max late us", "late");
+    for(p=0; p<2; p++){
+        config.profile = (p == 0) ? MOTION_TRAPEZOID : MOTION_SCURVE;
+        if(GIPY_motionOpen(&engine, &config) != GE_OK){
+            printError(NULL, "Unable to open the motion engine");
+            break;
+        }
+        int64_t targets[2] = {steps, steps / 3};
+        uint64_t start = GIPY_clockNow();
+        GIPY_motionMove(&engine, targets, 0);
+        while(GIPY_motionIsIdle(&engine) == FALSE){
+            GIPY_clockSleep(MOTION_IDLE_NS);
+        }
+        double elapsed = (double)(GIPY_clockNow() - start) / NSEC_PER_SEC;
+        GIPY_motionGetStats(&engine, &stats);
+        printf("%-10s %10llu %10.3f %12.2f %12.2f %8llu\n", names[p],
+                (unsigned long long)stats.steps, elapsed,
+                stats.errorTotal / 1000.0 / stats.steps, stats.errorMax / 1000.0,
+                (unsigned long long)stats.late);
+        if(GIPY_motionGetPosition(&engine, 0) != targets[0]
+                || GIPY_motionGetPosition(&engine, 1) != targets[1]){
+            printError(NULL, "Wrong final position");
+        }
+        GIPY_motionClose(&engine);
+    }
+
+    //Reference: constant speed, one write and one sleep per step
+    uint64_t period = NSEC_PER_SEC / speed;
+    uint64_t total  = 0;
+    uint64_t max    = 0;
+    uint64_t late   = 0;
+    uint64_t start  = GIPY_clockNow();
+    long     n;
+    for(n=0; n<steps; n++){
+        uint64_t when = start + n * period;
+        uint64_t now  = GIPY_clockNow();
+        uint64_t diff = (now > when) ? now - when : 0;
+        GIPY_pinWrite(config.stepPins[0], 1);
+        GIPY_pinWrite(config.stepPins[0], 0);
+        total   += diff;
+        max     = (diff > max) ? diff : max;
+        late    += (diff > MOTION_LATE_NS) ? 1 : 0;
+        GIPY_clockSleep(period);
+    }
+    printf("%-10s %10ld %10.3f %12.2f %12.2f %8llu\n", "pinWrite", steps,
+            (double)(GIPY_clockNow() - start) / NSEC_PER_SEC, total / 1000.0 / steps,
+            max / 1000.0, (unsigned long long)late);
+
+    for(k=0; k<4; k++){
+        GIPY_pinUnexport(BANK_FIRST_PIN + k);
+    }
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Shift benchmark
+// ****************************************************************************
+/**
+ * @brief           Shift and latch an image with GIPY_pinWrite (Reference)
+ *
+ * @param pImage    Outputs image
+ * @param pBits     Outputs of the chain
+ */
+static void shiftPinByPin(uint64_t pImage, int pBits){
+    int b;
+    for(b=pBits-1; b>=0; b--){
+        GIPY_pinWrite(SPI_PIN_MOSI, (pImage >> b) & 0x01);
+        GIPY_pinWrite(SPI_PIN_SCLK, LOGIC_ONE);
+        GIPY_pinWrite(SPI_PIN_SCLK, LOGIC_ZERO);
+    }
+    GIPY_pinWrite(SPI_PIN_CS, LOGIC_ZERO);
+    GIPY_pinWrite(SPI_PIN_CS, LOGIC_ONE);
+}
+
+/**
+ * @brief   Measure the shift chain refresh (bits/s, refresh time) against
+ *          a refresh done with GIPY_pinWrite, and the writes merged by
+ *          the shadow image
+ */
+int benchShift(int argc, char **argv){
+    int         bits    = (argc > 0) ? atoi(argv[0]) : SHIFT_BITS;
+    int         pins[]  = {SPI_PIN_CS, SPI_PIN_SCLK, SPI_PIN_MOSI};
+    shiftConfig config  = {SPI_PIN_MOSI, SPI_PIN_SCLK, SPI_PIN_CS, SHIFT_NO_PIN,
+                           bits, 0, SHIFT_PIN_BASE, SHIFT_RATE, 0};
+    shiftChain  chain;
+    shiftStats  stats;
+    int         k;
+
+    if(bits < 1 || bits > SHIFT_MAX_BITS || GIPY_simEnable(NULL, 1.0) != GE_OK){
+        printError(NULL, "Unable to set the shift bench");
+        return EXIT_FAILURE;
+    }
+    for(k=0; k<3; k++){
+        GIPY_pinExport(pins[k]);
+    }
+    printf("Shift: %d outputs, %d refreshes (Simulated sysfs)\n", bits, SHIFT_REFRESHES);
+    printf("%-12s %8s %12s %12s\n", "refresh", "backend", "kbit/s", "refresh us");
+
+    //Reference: one call per edge
+    GIPY_pinSetDirectionLow(SPI_PIN_SCLK);
+    GIPY_pinSetDirectionLow(SPI_PIN_MOSI);
+    GIPY_pinSetDirectionHigh(SPI_PIN_CS);
+    uint64_t start = GIPY_clockNow();
+    for(k=0; k<SHIFT_REFRESHES; k++){
+        shiftPinByPin((uint64_t)k * 0x9E3779B97F4A7C15ULL, bits);
+    }
+    double elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-12s %8s %12.1f %12.2f\n", "pin by pin", "sysfs",
+            (double)bits * SHIFT_REFRESHES * 1e6 / elapsed, elapsed / SHIFT_REFRESHES / 1000.0);
+
+    //Engine: one image per refresh
+    if(GIPY_shiftOpen(&chain, &config) != GE_OK){
+        printError(NULL, "Unable to open the shift chain");
+        GIPY_simDisable();
+        return EXIT_FAILURE;
+    }
+    GIPY_shiftSync(&chain);
+    for(k=0; k<SHIFT_REFRESHES; k++){
+        GIPY_shiftWrite(&chain, ~0ULL, (uint64_t)k * 0x9E3779B97F4A7C15ULL);
+        GIPY_shiftSync(&chain);
+    }
+    GIPY_shiftGetStats(&chain, &stats);
+    printf("%-12s %8s %12.1f %12.2f\n", "engine", GIPY_bankBackendName(chain.out.backend),
+            stats.bits * 1e6 / stats.time, (double)stats.time / stats.refreshes / 1000.0);
+
+    //Virtual pins: writes between two refreshes are merged
+    uint64_t refreshes = stats.refreshes;
+    start = GIPY_clockNow();
+    for(k=0; k<SHIFT_WRITES; k++){
+        GIPY_pinWrite(SHIFT_PIN_BASE + k % bits, (k / bits) & 0x01);
+    }
+    GIPY_shiftSync(&chain);
+    elapsed = (double)(GIPY_clockNow() - start);
+    GIPY_shiftGetStats(&chain, &stats);
+    printf("Virtual pins: %d writes in %.2f ms, %llu refreshes\n", SHIFT_WRITES,
+            elapsed / NSEC_PER_MSEC, (unsigned long long)(stats.refreshes - refreshes));
+    GIPY_shiftClose(&chain);
+
+    for(k=0; k<3; k++){
+        GIPY_pinUnexport(pins[k]);
+    }
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+
+// ****************************************************************************
+// Snapshot benchmark
+// ****************************************************************************
+/**
+ * @brief           Configure the bench pins one call at a time
+ *
+ * @param pNbPins   Pins from BANK_FIRST_PIN
+ * @param pMode     0: low outputs, no edge. 1: even pins are inputs with
+ *                  both edges, odd pins are high outputs
+ */
+static void snapshotSetMode(int pNbPins, int pMode){
+    int k;
+    for(k=0; k<pNbPins; k++){
+        int isInput = (pMode == 1 && (k & 0x01) == 0);
+        GIPY_pinSetDirection(BANK_FIRST_PIN + k, (isInput) ? IN : (pMode == 1) ? HIGH : LOW);
+        GIPY_pinSetEdge(BANK_FIRST_PIN + k, (isInput) ? BOTH : NONE);
+    }
+}
+
+/**
+ * @brief   Measure a mode switch done one call per setting against a
+ *          snapshot restore (Minimal diff)
+ */
+int benchSnapshot(int argc, char **argv){
+    static uint8_t  modes[2][1024];
+    size_t          sizes[2];
+    int             nbPins  = (argc > 0) ? atoi(argv[0]) : SNAPSHOT_PINS;
+    long            loops   = (argc > 1) ? atol(argv[1]) : SNAPSHOT_LOOPS;
+    int             changes = 0;
+    int             k, m;
+    long            n;
+
+    if(nbPins < 1 || nbPins > 24 || loops <= 0 || GIPY_simEnable(NULL, 1.0) != GE_OK){
+        printError(NULL, "Unable to set the snapshot bench (1 to 24 pins)");
+        return EXIT_FAILURE;
+    }
+    for(k=0; k<nbPins; k++){
+        GIPY_pinExport(BANK_FIRST_PIN + k);
+    }
+    for(m=0; m<2; m++){
+        snapshotSetMode(nbPins, m);
+        sizes[m] = GIPY_snapshotCapture(modes[m], sizeof(modes[m]));
+    }
+
+    printf("Snapshot: %d pins, %ld mode switches, %zu bytes blob (Simulated sysfs)\n",
+            nbPins, loops, sizes[0]);
+    printf("%-14s %12s %14s\n", "switch", "us/switch", "changes/switch");
+    uint64_t start = GIPY_clockNow();
+    for(n=0; n<loops; n++){
+        snapshotSetMode(nbPins, (n + 1) & 0x01);
+    }
+    double elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-14s %12.2f %14d\n", "per call", elapsed / loops / 1000.0, 2 * nbPins);
+
+    long total = 0;
+    start = GIPY_clockNow();
+    for(n=0; n<loops; n++){
+        GIPY_snapshotRestore(modes[n & 0x01], sizes[n & 0x01], &changes);
+        total += changes;
+    }
+    elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-14s %12.2f %14.1f\n", "restore", elapsed / loops / 1000.0, (double)total / loops);
+
+    //Same mode again: nothing to change
+    m       = (int)((loops - 1) & 0x01);
+    total   = 0;
+    start   = GIPY_clockNow();
+    for(n=0; n<loops; n++){
+        GIPY_snapshotRestore(modes[m], sizes[m], &changes);
+        total += changes;
+    }
+    elapsed = (double)(GIPY_clockNow() - start);
+    printf("%-14s %12.2f %14.1f\n", "restore same", elapsed / loops / 1000.0, (double)total / loops);
+
+    for(k=0; k<nbPins; k++){
+        GIPY_pinUnexport(BANK_FIRST_PIN + k);
+    }
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+
+// ****************************************************************************
+// Clock benchmark
+// ****************************************************************************
+/**
+ * @brief           Display the cost of one timestamp
+ *
+ * @param pName     Timestamp source
+ * @param pReads    Number of reads
+ * @param pElapsed  Duration of the reads (ns)
+ * @param pSum      Sum of the reads (Keeps them from being optimized out)
+ */
+static void printClockCost(const char *pName, long pReads, uint64_t pElapsed, uint64_t pSum){
+    printf("%-22s %10.2f %18llx\n", pName, (double)pElapsed / pReads,
+            (unsigned long long)(pSum & 0xFFFF));
+}
+
+/**
+ * @brief   Measure the cost of a timestamp for each time source, and the
+ *          drift of the counter against CLOCK_MONOTONIC
+ */
+int benchClock(int argc, char **argv){
+    long            reads   = (argc > 0) ? atol(argv[0]) : CLOCK_READS;
+    int             seconds = (argc > 1) ? atoi(argv[1]) : CLOCK_SECONDS;
+    struct timespec ts;
+    uint64_t        sum     = 0;
+    uint64_t        start;
+    long            n;
+
+    if(reads <= 0 || seconds < 0){
+        printError(NULL, "Unable to set the clock bench");
+        return EXIT_FAILURE;
+    }
+    printf("Clock: %ld timestamps per source\n", reads);
+    printf("%-22s %10s %18s\n", "source", "ns/stamp", "(checksum)");
+
+    start = GIPY_clockNow();
+    for(n=0; n<reads; n++){
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        sum += (uint64_t)ts.tv_nsec;
+    }
+    printClockCost("clock_gettime", reads, GIPY_clockNow() - start, sum);
+
+    start = GIPY_clockNow();
+    for(n=0; n<reads; n++){
+        sum += GIPY_clockNow();
+    }
+    printClockCost("clockNow monotonic", reads, GIPY_clockNow() - start, sum);
+
+    if(GIPY_clockSetSource(CLK_SOURCE_COUNTER) != GE_OK){
+        printf("%-22s not available\n", "counter");
+        return EXIT_SUCCESS;
+    }
+    start = GIPY_clockNow();
+    for(n=0; n<reads; n++){
+        sum += GIPY_clockCounter();
+    }
+    printClockCost("raw counter", reads, GIPY_clockNow() - start, sum);
+
+    start = GIPY_clockNow();
+    for(n=0; n<reads; n++){
+        sum += GIPY_clockNow();
+    }
+    printClockCost("clockNow counter", reads, GIPY_clockNow() - start, sum);
+
+    //Drift: counter time against CLOCK_MONOTONIC, after the calibration
+    int64_t drift = GIPY_clockDrift();
+    GIPY_clockSleep(seconds * NSEC_PER_SEC);
+    int64_t after = GIPY_clockDrift();
+    printf("Drift after %d s: %lld ns (%.3f ppm), at selection: %lld ns\n", seconds,
+            (long long)(after - drift), (seconds > 0) ? (double)(after - drift) / seconds / 1000.0 : 0.0,
+            (long long)drift);
+    GIPY_clockSetSource(CLK_SOURCE_MONOTONIC);
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Mirror benchmark
+// ****************************************************************************
+/**
+ * @brief   Measure GIPY_pinRead of an input with and without the input
+ *          mirror, and the age of the mirrored levels
+ */
+int benchMirror(int argc, char **argv){
+    long        reads   = (argc > 0) ? atol(argv[0]) : MIRROR_READS;
+    long        maxAge  = (argc > 1) ? atol(argv[1]) : MIRROR_AGE_US;
+    uint64_t    ageMax  = 0;
+    uint64_t    ageSum  = 0;
+    uint64_t    stamp;
+    long        sum     = 0;
+    long        n;
+    int         value;
+
+    if(reads <= 0 || GIPY_simEnable(NULL, 1.0) != GE_OK
+            || GIPY_pinExport(BENCH_PIN) != GE_OK
+            || GIPY_pinSetDirectionIn(BENCH_PIN) != GE_OK){
+        printError(NULL, "Unable to set the mirror bench");
+        return EXIT_FAILURE;
+    }
+    printf("Mirror: %ld reads of pin %d, max age %ld us (Simulated sysfs)\n",
+            reads, BENCH_PIN, maxAge);
+    printf("%-14s %10s %10s\n", "read", "ns/read", "(checksum)");
+
+    uint64_t start = GIPY_clockNow();
+    for(n=0; n<reads; n++){
+        GIPY_pinRead(BENCH_PIN, &value);
+        sum += value;
+    }
+    printf("%-14s %10.1f %10ld\n", "value file",
+            (double)(GIPY_clockNow() - start) / reads, sum);
+
+    if(GIPY_pinSetMirror(BENCH_PIN, (uint64_t)maxAge * NSEC_PER_USEC) != GE_OK){
+        printError(NULL, "Unable to mirror the bench pin");
+        GIPY_simDisable();
+        return EXIT_FAILURE;
+    }
+    GIPY_clockSleep((uint64_t)maxAge * NSEC_PER_USEC); //First samples
+    start = GIPY_clockNow();
+    for(n=0; n<reads; n++){
+        GIPY_pinRead(BENCH_PIN, &value);
+        sum += value;
+    }
+    printf("%-14s %10.1f %10ld\n", "mirror",
+            (double)(GIPY_clockNow() - start) / reads, sum);
+
+    //Age seen by the readers (Sampled every max age / 2)
+    for(n=0; n<reads; n++){
+        GIPY_pinReadMirror(BENCH_PIN, &value, &stamp);
+        uint64_t now = GIPY_clockNow();
+        uint64_t age = (now > stamp) ? now - stamp : 0;
+        ageSum += age;
+        if(age > ageMax){
+            ageMax = age;
+        }
+    }
+    printf("Age: mean %.1f us, max %.1f us\n",
+            (double)ageSum / reads / 1000.0, ageMax / 1000.0);
+
+    GIPY_pinSetMirror(BENCH_PIN, 0);
+    GIPY_pinUnexport(BENCH_PIN);
+    GIPY_simDisable();
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Main function
+// ****************************************************************************
+/**
+ * Main function
+ */
+int main(int argc, char **argv){
+    int k;
+    for(k=0; k<NB_BENCHES && argc > 1; k++){
+        if(strcmp(benches[k].name, argv[1]) == 0){
+            return benches[k].run(argc - 2, argv + 2);
+        }
+    }
+    printf("Usage: %s <benchmark> [parameters]\n", argv[0]);
+    for(k=0; k<NB_BENCHES; k++){
+        printf("    %s\n", benches[k].usage);
+    }
+    return (argc > 1) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,356 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Capture
+ * Logic analyzer: sampled capture of pins, VCD export
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "capture.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Capture thread. One sample every 1/sampleRate till done
+ */
+static void *captureThread(void*);
+
+/**
+ * \brief   Wait till a clock time (Sleep, then spin for the last
+ *          CAPTURE_SPIN_NS)
+ */
+static void waitUntil(uint64_t);
+
+/**
+ * \brief   Handle one sample: trigger, then store
+ *
+ * \param   pCapture    Capture
+ * \param   pValue      Sample
+ * \param   pStamp      Sample time (Library clock)
+ * \return  void
+ */
+static void addSample(capture*, uint32_t, uint64_t);
+
+/**
+ * \brief   Handle missed samples (Gap run)
+ *
+ * \param   pCapture    Capture
+ * \param   pCount      Number of missed samples
+ * \return  void
+ */
+static void addGap(capture*, uint64_t);
+
+/**
+ * \brief   Store samples in the ring (Extend the last run if possible)
+ * \details Before the trigger, the oldest run is dropped if the ring is full
+ *
+ * \param   pCapture    Capture
+ * \param   pValue      Sample
+ * \param   pCount      Number of samples (Up to CAPTURE_MAX_COUNT)
+ * \param   pIsGap      TRUE for missed samples
+ * \return  TRUE if stored, FALSE if the ring is full
+ */
+static int appendRun(capture*, uint32_t, uint32_t, int);
+
+/**
+ * \brief   Drop the oldest samples to keep at most pKeep samples
+ */
+static void trimRing(capture*, uint64_t);
+
+/**
+ * \brief   Check whether a sample matches the trigger pattern
+ */
+static int isTrigger(const capture*, uint32_t);
+
+#define RUN_AT(capture, index) (&(capture)->runs[(index) & ((capture)->config.nbRuns - 1)])
+
+
+//------------------------------------------------------------------------------
+// Capture functions
+//------------------------------------------------------------------------------
+pirror GIPY_captureOpen(capture *pCapture, const captureConfig *pConfig){
+    dbgInfo("Try to open capture");
+    if(pCapture == NULL || pConfig == NULL
+            || pConfig->nbPins < 1 || pConfig->nbPins > BANK_MAX_PINS
+            || pConfig->sampleRate == 0 || pConfig->postTrigger == 0
+            || (pConfig->nbRuns & (pConfig->nbRuns - 1)) != 0){
+        dbgError("Invalid capture configuration");
+        return GE_PARAM;
+    }
+    memset(pCapture, 0, sizeof(capture));
+    pCapture->config = *pConfig;
+    if(pCapture->config.nbRuns == 0){
+        pCapture->config.nbRuns = CAPTURE_DEFAULT_RUNS;
+    }
+    pCapture->runs = malloc(pCapture->config.nbRuns * sizeof(captureRun));
+    if(pCapture->runs == NULL){
+        dbgError("Unable to allocate the capture ring");
+        return GE_IO;
+    }
+    pirror err = GIPY_bankOpen(&pCapture->bank, pConfig->pins, pConfig->nbPins);
+    if(err != GE_OK){
+        free(pCapture->runs);
+        return err;
+    }
+
+    pCapture->state     = CAPTURE_ARMED;
+    pCapture->running   = TRUE;
+    pthread_create(&pCapture->thread, NULL, &captureThread, pCapture);
+    dbgInfo("Capture opened (%d pins, %u samples/s, %u runs)", pConfig->nbPins,
+            pConfig->sampleRate, pCapture->config.nbRuns);
+    return GE_OK;
+}
+
+captureState GIPY_captureGetState(capture *pCapture){
+    return __atomic_load_n(&pCapture->state, __ATOMIC_ACQUIRE);
+}
+
+void GIPY_captureStop(capture *pCapture){
+    if(pCapture->isStopped == TRUE){
+        return;
+    }
+    __atomic_store_n(&pCapture->running, FALSE, __ATOMIC_RELEASE);
+    pthread_join(pCapture->thread, NULL);
+    pCapture->isStopped = TRUE;
+}
+
+pirror GIPY_captureWriteVcd(capture *pCapture, const char *pPath){
+    static const char   *states[] = {"armed", "triggered", "done", "overflow"};
+    uint64_t            period  = NSEC_PER_SEC / pCapture->config.sampleRate;
+    uint64_t            index   = 0;
+    uint32_t            last    = 0;
+    int                 isKnown = FALSE;
+    uint32_t            r;
+    int                 k;
+
+    if(pCapture->isStopped == FALSE){
+        return GE_PERM;
+    }
+    FILE *file = fopen(pPath, "w");
+    if(file == NULL){
+        dbgError("Unable to create VCD file %s", pPath);
+        return GE_IO;
+    }
+
+    //Header: one wire per pin, identifiers are '!' + pin index
+    fprintf(file, "$version GIPY capture $end\n");
+    fprintf(file, "$comment %s, %u samples/s, %llu samples, %llu missed",
+            states[pCapture->state], pCapture->config.sampleRate,
+            (unsigned long long)pCapture->ringSamples, (unsigned long long)pCapture->missed);
+    if(pCapture->state != CAPTURE_ARMED){
+        fprintf(file, ", trigger at #%llu", (unsigned long long)(pCapture->triggerIndex * period));
+    }
+    fprintf(file, " $end\n$timescale 1 ns $end\n$scope module gipy $end\n");
+    for(k=0; k<pCapture->config.nbPins; k++){
+        fprintf(file, "$var wire 1 %c gpio%d $end\n", '!' + k, pCapture->config.pins[k]);
+    }
+    fprintf(file, "$upscope $end\n$enddefinitions $end\n");
+
+    //Only the pins changing at the start of a run are written
+    for(r=pCapture->tail; r!=pCapture->head; r++){
+        captureRun *run = RUN_AT(pCapture, r);
+        fprintf(file, "#%llu\n", (unsigned long long)(index * period));
+        if(run->count & CAPTURE_GAP){
+            fprintf(file, "$comment %u samples missed $end\n", run->count & CAPTURE_MAX_COUNT);
+            for(k=0; k<pCapture->config.nbPins; k++){
+                fprintf(file, "x%c\n", '!' + k);
+            }
+            isKnown = FALSE;
+        }
+        else{
+            for(k=0; k<pCapture->config.nbPins; k++){
+                if(isKnown == FALSE || ((run->value ^ last) >> k) & 0x01){
+                    fprintf(file, "%u%c\n", (run->value >> k) & 0x01, '!' + k);
+                }
+            }
+            last    = run->value;
+            isKnown = TRUE;
+        }
+        index += run->count & CAPTURE_MAX_COUNT;
+    }
+    fprintf(file, "#%llu\n", (unsigned long long)(index * period));
+
+    if(fclose(file) != 0){
+        dbgError("Unable to write VCD file %s", pPath);
+        return GE_IO;
+    }
+    return GE_OK;
+}
+
+void GIPY_captureClose(capture *pCapture){
+    GIPY_captureStop(pCapture);
+    GIPY_bankClose(&pCapture->bank);
+    free(pCapture->runs);
+    pCapture->runs = NULL;
+}
+
+
+//------------------------------------------------------------------------------
+// Sample functions
+//------------------------------------------------------------------------------
+static void *captureThread(void *pCapture){
+    capture     *cap    = (capture *)pCapture;
+    uint64_t    period  = NSEC_PER_SEC / cap->config.sampleRate;
+    uint32_t    mask    = (cap->config.nbPins == 32) ? ~0U : (1U << cap->config.nbPins) - 1;
+    uint64_t    next    = GIPY_clockNow();
+    dbgInfo("Start capture thread");
+
+    while(__atomic_load_n(&cap->running, __ATOMIC_ACQUIRE) == TRUE
+            && (cap->state == CAPTURE_ARMED || cap->state == CAPTURE_TRIGGERED)){
+        waitUntil(next);
+
+        //A whole period late: these samples are lost, not shifted
+        uint64_t now = GIPY_clockNow();
+        if(now > next && now - next >= period){
+            uint64_t missed = (now - next) / period;
+            cap->missed += missed;
+            cap->stalls++;
+            dbgError("Capture fell behind: %llu samples missed", (unsigned long long)missed);
+            addGap(cap, missed);
+            next += missed * period;
+            if(cap->state != CAPTURE_ARMED && cap->state != CAPTURE_TRIGGERED){
+                break;
+            }
+        }
+
+        uint32_t value;
+        if(GIPY_bankRead(&cap->bank, mask, &value) == GE_OK){
+            addSample(cap, value, next);
+        }
+        else{
+            addGap(cap, 1);
+        }
+        cap->samples++;
+        next += period;
+    }
+    dbgInfo("Capture thread stopped (%llu samples, %llu missed)",
+            (unsigned long long)cap->samples, (unsigned long long)cap->missed);
+    return NULL;
+}
+
+static void waitUntil(uint64_t pTime){
+    uint64_t now = GIPY_clockNow();
+    if(pTime > now + CAPTURE_SPIN_NS){
+        GIPY_clockSleep(pTime - now - CAPTURE_SPIN_NS);
+    }
+    while(GIPY_clockNow() < pTime){
+        //Spin: sleep wake up latency is about the spin duration
+    }
+}
+
+static void addSample(capture *pCapture, uint32_t pValue, uint64_t pStamp){
+    captureState state = pCapture->state;
+    if(state == CAPTURE_ARMED){
+        if(isTrigger(pCapture, pValue) == FALSE){
+            appendRun(pCapture, pValue, 1, FALSE);
+            trimRing(pCapture, pCapture->config.preTrigger);
+            pCapture->previous      = pValue;
+            pCapture->isPrevious    = TRUE;
+            return;
+        }
+        trimRing(pCapture, pCapture->config.preTrigger);
+        pCapture->triggerIndex  = pCapture->ringSamples;
+        pCapture->triggerStamp  = pStamp;
+        state                   = CAPTURE_TRIGGERED;
+        dbgInfo("Capture triggered (%llu samples before)", (unsigned long long)pCapture->ringSamples);
+    }
+
+    if(appendRun(pCapture, pValue, 1, FALSE) == FALSE){
+        dbgError("Capture ring full: capture truncated");
+        state = CAPTURE_OVERFLOW;
+    }
+    else if(++pCapture->postCount >= pCapture->config.postTrigger){
+        state = CAPTURE_DONE;
+    }
+    pCapture->previous      = pValue;
+    pCapture->isPrevious    = TRUE;
+    __atomic_store_n(&pCapture->state, state, __ATOMIC_RELEASE);
+}
+
+static void addGap(capture *pCapture, uint64_t pCount){
+    uint32_t count = (pCount > CAPTURE_MAX_COUNT) ? CAPTURE_MAX_COUNT : (uint32_t)pCount;
+    pCapture->isPrevious = FALSE;
+    if(pCapture->state == CAPTURE_ARMED){
+        appendRun(pCapture, 0, count, TRUE);
+        trimRing(pCapture, pCapture->config.preTrigger);
+        return;
+    }
+
+    //After the trigger, missed samples count as captured ones
+    captureState state = pCapture->state;
+    uint32_t left = pCapture->config.postTrigger - pCapture->postCount;
+    count = (count > left) ? left : count;
+    if(appendRun(pCapture, 0, count, TRUE) == FALSE){
+        state = CAPTURE_OVERFLOW;
+    }
+    else if((pCapture->postCount += count) >= pCapture->config.postTrigger){
+        state = CAPTURE_DONE;
+    }
+    __atomic_store_n(&pCapture->state, state, __ATOMIC_RELEASE);
+}
+
+
+//------------------------------------------------------------------------------
+// Ring functions
+//------------------------------------------------------------------------------
+static int appendRun(capture *pCapture, uint32_t pValue, uint32_t pCount, int pIsGap){
+    if(pCapture->head != pCapture->tail){
+        captureRun *last = RUN_AT(pCapture, pCapture->head - 1);
+        if(pIsGap == FALSE && (last->count & CAPTURE_GAP) == 0 && last->value == pValue
+                && last->count <= CAPTURE_MAX_COUNT - pCount){
+            last->count             += pCount;
+            pCapture->ringSamples   += pCount;
+            return TRUE;
+        }
+    }
+
+    //Ring full: only samples before the trigger can be dropped
+    if(pCapture->head - pCapture->tail == pCapture->config.nbRuns){
+        if(pCapture->state != CAPTURE_ARMED){
+            return FALSE;
+        }
+        pCapture->ringSamples -= RUN_AT(pCapture, pCapture->tail)->count & CAPTURE_MAX_COUNT;
+        pCapture->tail++;
+    }
+    captureRun *run         = RUN_AT(pCapture, pCapture->head);
+    run->value              = pValue;
+    run->count              = pCount | ((pIsGap == TRUE) ? CAPTURE_GAP : 0);
+    pCapture->ringSamples   += pCount;
+    pCapture->head++;
+    return TRUE;
+}
+
+static void trimRing(capture *pCapture, uint64_t pKeep){
+    while(pCapture->ringSamples > pKeep){
+        captureRun  *run    = RUN_AT(pCapture, pCapture->tail);
+        uint64_t    excess  = pCapture->ringSamples - pKeep;
+        uint32_t    count   = run->count & CAPTURE_MAX_COUNT;
+        if(count > excess){
+            run->count              -= (uint32_t)excess; //Gap flag is kept
+            pCapture->ringSamples   = pKeep;
+            return;
+        }
+        pCapture->ringSamples -= count;
+        pCapture->tail++;
+    }
+}
+
+static int isTrigger(const capture *pCapture, uint32_t pValue){
+    const captureTrigger    *trig       = &pCapture->config.trigger;
+    uint32_t                previous    = pCapture->previous;
+
+    if(((pValue ^ trig->level) & trig->mask) != 0){
+        return FALSE;
+    }
+    if((trig->rising | trig->falling) == 0){
+        return TRUE;
+    }
+    return pCapture->isPrevious
+        && (pValue & ~previous & trig->rising) == trig->rising
+        && (~pValue & previous & trig->falling) == trig->falling;
+}
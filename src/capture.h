@@ -0,0 +1,184 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Capture
+ * Logic analyzer: sampled capture of pins, VCD export
+ *
+ * SAMPLING
+ * A capture thread reads all the pins at a fixed rate with one bank read
+ * (See bank.h): one sample is one bit per pin. The sample times follow a
+ * fixed schedule (Sleep, then spin for the last CAPTURE_SPIN_NS).
+ *
+ * COMPRESSION
+ * Samples are stored as runs (Value and number of identical samples) in a
+ * ring: a steady signal costs one run whatever its length.
+ *
+ * TRIGGER
+ * Till the trigger, the ring keeps the last 'preTrigger' samples at least.
+ * The trigger is a pattern: level of the masked pins and edges (Rising /
+ * falling) between two samples. After the trigger, 'postTrigger' samples
+ * are captured (Trigger sample included) then the capture is done.
+ *
+ * FALLING BEHIND
+ * If a sample time is missed by a whole period (Thread not scheduled,
+ * read too slow for the rate), the missed samples are stored as a gap run
+ * (Unknown levels), counted in 'missed' and logged. Samples are never
+ * shifted in time.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_CAPTURE_H_
+#define _HEADER_CAPTURE_H_
+
+#include "gipy.h"
+#include "bank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define CAPTURE_DEFAULT_RUNS    65536 //Ring size if not set (Runs)
+#define CAPTURE_SPIN_NS         (50 * NSEC_PER_USEC) //Busy wait before a sample
+#define CAPTURE_GAP             0x80000000U //Count flag of a gap run
+#define CAPTURE_MAX_COUNT       0x7FFFFFFFU //Samples per run
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Trigger pattern. Bits are pins index in the configuration
+ * \details Matches when the pins in 'mask' are at 'level', and the pins in
+ *          'rising' ('falling') just went high (low). All zero: the first
+ *          sample triggers.
+ */
+typedef struct {
+    uint32_t    mask;
+    uint32_t    level;
+    uint32_t    rising;
+    uint32_t    falling;
+} captureTrigger;
+
+/**
+ * \brief Capture configuration
+ */
+typedef struct {
+    int             nbPins;
+    int             pins[BANK_MAX_PINS];
+    uint32_t        sampleRate;     //Samples per second
+    uint32_t        nbRuns;         //Ring size (Power of 2, 0 for default)
+    captureTrigger  trigger;
+    uint32_t        preTrigger;     //Samples kept before the trigger
+    uint32_t        postTrigger;    //Samples captured from the trigger
+} captureConfig;
+
+/**
+ * \brief Describe the capture states
+ */
+typedef enum {
+    CAPTURE_ARMED,      //Waiting for the trigger
+    CAPTURE_TRIGGERED,  //Capturing the post trigger samples
+    CAPTURE_DONE,       //All samples captured
+    CAPTURE_OVERFLOW    //Ring full after the trigger (Capture is truncated)
+} captureState;
+
+/**
+ * \brief One run of identical samples
+ */
+typedef struct {
+    uint32_t    value;      //Sample (Bit k is pin index k)
+    uint32_t    count;      //Number of samples, CAPTURE_GAP flag if missed
+} captureRun;
+
+/**
+ * \brief Capture engine
+ */
+typedef struct {
+    captureConfig   config;
+    pinBank         bank;
+    captureRun      *runs;
+    uint32_t        head;       //Next run to write
+    uint32_t        tail;       //Oldest run
+    uint64_t        ringSamples;//Samples in the ring
+    uint64_t        triggerIndex;//Trigger sample (Index in the ring)
+    uint64_t        triggerStamp;//Trigger time (Library clock)
+    uint32_t        postCount;  //Samples captured since the trigger
+    uint32_t        previous;   //Previous sample (Trigger edges)
+    int             isPrevious; //FALSE if the previous sample is unknown
+    captureState    state;
+    uint64_t        samples;    //Samples read
+    uint64_t        missed;     //Samples missed (Fell behind)
+    uint64_t        stalls;     //Number of times the capture fell behind
+    int             running;
+    int             isStopped;  //TRUE once the thread is joined
+    pthread_t       thread;
+} capture;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a capture and start sampling (Armed)
+ * \details         Pins must be exported, their direction is not changed.
+ *
+ * \param pCapture  Capture to initialize
+ * \param pConfig   Capture configuration
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid configuration
+ * \return GE_PERM  If a pin is not exported
+ * \return GE_IO    If unable to allocate the ring
+ */
+pirror GIPY_captureOpen(capture*, const captureConfig*);
+
+/**
+ * \brief           Get the state of a capture
+ *
+ * \param pCapture  Opened capture
+ * \return          Current state
+ */
+captureState GIPY_captureGetState(capture*);
+
+/**
+ * \brief           Stop sampling (Done or not)
+ *
+ * \param pCapture  Opened capture
+ * \return void
+ */
+void GIPY_captureStop(capture*);
+
+/**
+ * \brief           Write the captured samples in a VCD file
+ * \details         Time 0 is the first sample kept. Gap runs are written
+ *                  as unknown levels ('x') with a comment.
+ *
+ * \param pCapture  Stopped capture
+ * \param pPath     File to create
+ * \return GE_OK    If no error
+ * \return GE_PERM  If the capture is not stopped
+ * \return GE_IO    If unable to write the file
+ */
+pirror GIPY_captureWriteVcd(capture*, const char*);
+
+/**
+ * \brief           Stop sampling and free the capture
+ *
+ * \param pCapture  Opened capture
+ * \return void
+ */
+void GIPY_captureClose(capture*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
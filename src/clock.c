@@ -0,0 +1,356 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Clock
+ * Monotonic time source used by the library for timestamps and timeouts
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "clock.h"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Read CLOCK_MONOTONIC in nanoseconds
+ *
+ * \return  Current wall monotonic time (ns)
+ */
+static uint64_t wallNow(void);
+
+/**
+ * \brief   Read the real time source in nanoseconds
+ *
+ * \return  Current time of the source (ns)
+ */
+static inline uint64_t sourceNow(void);
+
+/**
+ * \brief   Read the CPU counter (See GIPY_clockCounter)
+ */
+static inline uint64_t counterRead(void);
+
+/**
+ * \brief   Get the CPU counter frequency
+ * \details Calibrated against CLOCK_MONOTONIC on x86-64 (Takes
+ *          CLOCK_CALIBRATE_NS).
+ *
+ * \return  Ticks per second, 0 if no usable counter
+ */
+static double counterFrequency(void);
+
+/**
+ * \brief   Initialize the condition used by manual stepping sleeps
+ *
+ * \return void
+ */
+static void initStepCondition(void);
+
+/**
+ * \brief   Start / end a change of the clock state (stepLock held)
+ *
+ * \return void
+ */
+static void stateWriteBegin(void);
+static void stateWriteEnd(void);
+
+/*
+ * \brief   Current clock state
+ * \details When virtual, time = virtualBase + (wall - wallBase) * speed
+ *          The manual stepping time is virtualBase (Moved by advance)
+ *          When real, time = wall + realOffset (Continues the virtual time)
+ *          Changed under stepLock, read by GIPY_clockNow with stateSeq
+ */
+static clockMode        mode        = CLK_REAL;
+static double           speed       = 1.0;
+static uint64_t         virtualBase = 0;
+static uint64_t         wallBase    = 0;
+static uint64_t         realOffset  = 0; //Modulo 2^64: may be negative
+static uint32_t         stateSeq    = 0; //Odd while the state changes
+
+/*
+ * \brief   Counter conversion: ns = nsBase + ((ticks - tickBase) * mult) >> shift
+ * \details Two copies: a new selection fills the unused one, then switches
+ */
+typedef struct {
+    uint64_t    tickBase;
+    uint64_t    nsBase;
+    uint64_t    mult;
+} counterScale;
+
+static clockSource      source      = CLK_SOURCE_MONOTONIC;
+static int64_t          monotonicOffset = 0; //Added to CLOCK_MONOTONIC (Counter drift)
+static counterScale     scales[2];
+static int              scaleIndex  = 0;
+
+static pthread_mutex_t  stepLock    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   stepCond;
+static pthread_once_t   stepOnce    = PTHREAD_ONCE_INIT;
+
+
+//------------------------------------------------------------------------------
+// Clock functions
+//------------------------------------------------------------------------------
+uint64_t GIPY_clockNow(void){
+    uint64_t now;
+    uint32_t seq;
+    do{
+        seq = __atomic_load_n(&stateSeq, __ATOMIC_ACQUIRE);
+        if(mode == CLK_REAL){
+            now = sourceNow() + realOffset;
+        }
+        else if(speed == 0.0){
+            now = virtualBase;
+        }
+        else{
+            now = virtualBase + (uint64_t)((double)(sourceNow() - wallBase) * speed);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while((seq & 1) != 0 || __atomic_load_n(&stateSeq, __ATOMIC_RELAXED) != seq);
+    return now;
+}
+
+void GIPY_clockSleep(uint64_t pDelay){
+    struct timespec ts;
+
+    //Manual stepping: wait till someone moves the clock far enough
+    if(mode == CLK_VIRTUAL && speed == 0.0){
+        pthread_once(&stepOnce, initStepCondition);
+        uint64_t deadline = GIPY_clockNow() + pDelay;
+        pthread_mutex_lock(&stepLock);
+        while(mode == CLK_VIRTUAL && speed == 0.0 && virtualBase < deadline){
+            pthread_cond_wait(&stepCond, &stepLock);
+        }
+        pthread_mutex_unlock(&stepLock);
+        return;
+    }
+
+    //Scaled clock, the wall sleep is shorter (or longer) than requested
+    if(mode == CLK_VIRTUAL){
+        pDelay = (uint64_t)((double)pDelay / speed);
+    }
+    ts.tv_sec   = pDelay / NSEC_PER_SEC;
+    ts.tv_nsec  = pDelay % NSEC_PER_SEC;
+    while(nanosleep(&ts, &ts) == -1){
+        //Interrupted by a signal, sleep the remaining time
+    }
+}
+
+pirror GIPY_clockSetVirtual(double pSpeed){
+    if(pSpeed < 0.0){
+        return GE_PARAM;
+    }
+    pthread_once(&stepOnce, initStepCondition);
+    pthread_mutex_lock(&stepLock);
+    uint64_t now    = GIPY_clockNow();
+    stateWriteBegin();
+    wallBase        = sourceNow();
+    virtualBase     = now;
+    speed           = pSpeed;
+    mode            = CLK_VIRTUAL;
+    stateWriteEnd();
+    pthread_cond_broadcast(&stepCond);
+    pthread_mutex_unlock(&stepLock);
+    return GE_OK;
+}
+
+void GIPY_clockSetReal(void){
+    pthread_once(&stepOnce, initStepCondition);
+    pthread_mutex_lock(&stepLock);
+    //Continue from the virtual time: no backward step after a fast clock
+    uint64_t now    = GIPY_clockNow();
+    stateWriteBegin();
+    realOffset      = now - sourceNow();
+    mode            = CLK_REAL;
+    speed           = 1.0;
+    stateWriteEnd();
+    pthread_cond_broadcast(&stepCond); //Release manual stepping sleepers
+    pthread_mutex_unlock(&stepLock);
+}
+
+pirror GIPY_clockAdvance(uint64_t pDelay){
+    if(mode != CLK_VIRTUAL || speed != 0.0){
+        return GE_PERM;
+    }
+    pthread_once(&stepOnce, initStepCondition);
+    pthread_mutex_lock(&stepLock);
+    stateWriteBegin();
+    virtualBase += pDelay;
+    stateWriteEnd();
+    pthread_cond_broadcast(&stepCond);
+    pthread_mutex_unlock(&stepLock);
+    return GE_OK;
+}
+
+clockMode GIPY_clockGetMode(void){
+    return mode;
+}
+
+pirror GIPY_clockSetSource(clockSource pSource){
+    if(pSource == CLK_SOURCE_MONOTONIC){
+        //Continue from the counter time: CLOCK_MONOTONIC plus the drift
+        pthread_mutex_lock(&stepLock);
+        stateWriteBegin();
+        uint64_t now = sourceNow();
+        if(__atomic_load_n(&source, __ATOMIC_ACQUIRE) == CLK_SOURCE_COUNTER){
+            __atomic_store_n(&monotonicOffset, (int64_t)(now - wallNow()), __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(&source, CLK_SOURCE_MONOTONIC, __ATOMIC_RELEASE);
+        if(mode == CLK_VIRTUAL){
+            wallBase += sourceNow() - now; //Same virtual time
+        }
+        stateWriteEnd();
+        pthread_mutex_unlock(&stepLock);
+        return GE_OK;
+    }
+    if(pSource != CLK_SOURCE_COUNTER){
+        return GE_PARAM;
+    }
+    double frequency = counterFrequency();
+    if(frequency <= 0.0){
+        return GE_PERM;
+    }
+
+    //Continue from the current source time (No step)
+    pthread_mutex_lock(&stepLock);
+    stateWriteBegin();
+    int             next    = 1 - scaleIndex;
+    counterScale    *scale  = &scales[next];
+    uint64_t        now     = sourceNow();
+    scale->tickBase = counterRead();
+    scale->nsBase   = now;
+    scale->mult     = (uint64_t)((double)NSEC_PER_SEC / frequency
+                        * (double)(1ULL << CLOCK_COUNTER_SHIFT) + 0.5);
+    __atomic_store_n(&scaleIndex, next, __ATOMIC_RELEASE);
+    __atomic_store_n(&source, CLK_SOURCE_COUNTER, __ATOMIC_RELEASE);
+    if(mode == CLK_VIRTUAL){
+        wallBase += sourceNow() - now;
+    }
+    stateWriteEnd();
+    pthread_mutex_unlock(&stepLock);
+    return GE_OK;
+}
+
+clockSource GIPY_clockGetSource(void){
+    return __atomic_load_n(&source, __ATOMIC_ACQUIRE);
+}
+
+int64_t GIPY_clockDrift(void){
+    if(GIPY_clockGetSource() == CLK_SOURCE_MONOTONIC){
+        return __atomic_load_n(&monotonicOffset, __ATOMIC_ACQUIRE);
+    }
+    uint64_t before = wallNow();
+    uint64_t now    = sourceNow();
+    uint64_t after  = wallNow();
+    return (int64_t)(now - (before + (after - before) / 2));
+}
+
+uint64_t GIPY_clockCounter(void){
+    return counterRead();
+}
+
+void GIPY_clockToWall(uint64_t pDeadline, uint64_t pMaxWall, struct timespec *pTs){
+    uint64_t now    = GIPY_clockNow();
+    uint64_t delay  = (pDeadline > now) ? pDeadline - now : 0;
+    if(mode == CLK_VIRTUAL && speed != 0.0){
+        delay = (uint64_t)((double)delay / speed);
+    }
+    if(mode == CLK_VIRTUAL && speed == 0.0){
+        delay = pMaxWall; //Frozen clock, only the wall limit makes sense
+    }
+    if(delay > pMaxWall){
+        delay = pMaxWall;
+    }
+    uint64_t wall   = wallNow() + delay;
+    pTs->tv_sec     = wall / NSEC_PER_SEC;
+    pTs->tv_nsec    = wall % NSEC_PER_SEC;
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static uint64_t wallNow(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t sourceNow(void){
+#ifdef CLOCK_HAS_COUNTER
+    if(__atomic_load_n(&source, __ATOMIC_ACQUIRE) == CLK_SOURCE_COUNTER){
+        const counterScale *scale = &scales[__atomic_load_n(&scaleIndex, __ATOMIC_ACQUIRE)];
+        uint64_t ticks = counterRead() - scale->tickBase;
+        return scale->nsBase + (uint64_t)(((unsigned __int128)ticks * scale->mult)
+                >> CLOCK_COUNTER_SHIFT);
+    }
+#endif
+    return wallNow() + (uint64_t)__atomic_load_n(&monotonicOffset, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t counterRead(void){
+#if defined(__x86_64__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks) :: "memory");
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+static double counterFrequency(void){
+#if defined(__x86_64__)
+    //Invariant TSC only (Same rate in all power states and on all cores)
+    unsigned int eax, ebx, ecx, edx;
+    if(__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0 || (edx & (1U << 8)) == 0){
+        return 0.0;
+    }
+
+    //Ticks during CLOCK_CALIBRATE_NS, each end read between two wall reads
+    uint64_t wallStart  = wallNow();
+    uint64_t tickStart  = counterRead();
+    wallStart           = (wallStart + wallNow()) / 2;
+    struct timespec ts  = {0, CLOCK_CALIBRATE_NS};
+    while(nanosleep(&ts, &ts) == -1){
+        //Interrupted by a signal, sleep the remaining time
+    }
+    uint64_t wallEnd    = wallNow();
+    uint64_t tickEnd    = counterRead();
+    wallEnd             = (wallEnd + wallNow()) / 2;
+    return (double)(tickEnd - tickStart) * NSEC_PER_SEC / (double)(wallEnd - wallStart);
+#elif defined(__aarch64__)
+    uint64_t frequency;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    return (double)frequency;
+#else
+    return 0.0;
+#endif
+}
+
+static void stateWriteBegin(void){
+    __atomic_store_n(&stateSeq, stateSeq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void stateWriteEnd(void){
+    __atomic_store_n(&stateSeq, stateSeq + 1, __ATOMIC_RELEASE);
+}
+
+static void initStepCondition(void){
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&stepCond, &attr);
+    pthread_condattr_destroy(&attr);
+}
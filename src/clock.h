@@ -0,0 +1,194 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Clock
+ * Monotonic time source used by the library for timestamps and timeouts
+ *
+ * REAL AND VIRTUAL CLOCK
+ * By default, the clock follows CLOCK_MONOTONIC. In virtual mode, the clock
+ * runs 'speed' times faster than the wall clock (Speed 10 means one wall
+ * second is 10 virtual seconds). With a speed of 0, the virtual clock is
+ * frozen and only moves with GIPY_clockAdvance (Manual stepping). Going back
+ * to real time keeps the time continuous (Offset from the source).
+ * All times are given in nanoseconds.
+ *
+ * TIME SOURCE
+ * The real time comes from CLOCK_MONOTONIC (vDSO: no syscall) or from the
+ * CPU counter (x86-64 invariant TSC, ARMv8 generic timer), which is read
+ * without the vDSO sequence and clock source checks. The counter is
+ * converted with a multiply and a shift (No division), from a base taken
+ * when the source is selected: the time continues without a step. TSC
+ * ticks are calibrated against CLOCK_MONOTONIC (CLOCK_CALIBRATE_NS), the
+ * ARM frequency is given by the CPU. The counter does not follow the NTP
+ * slew of CLOCK_MONOTONIC: GIPY_clockDrift measures the difference, select
+ * the source again to calibrate again. Every library timestamp and
+ * statistic is taken with GIPY_clockNow, whatever the source.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_CLOCK_H_
+#define _HEADER_CLOCK_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "errman.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define NSEC_PER_USEC   1000ULL
+#define NSEC_PER_MSEC   1000000ULL
+#define NSEC_PER_SEC    1000000000ULL
+#define CLOCK_CALIBRATE_NS  (20 * NSEC_PER_MSEC) //TSC calibration duration
+#define CLOCK_COUNTER_SHIFT 32 //Fixed point of the counter conversion
+
+#if defined(__x86_64__) || defined(__aarch64__)
+#define CLOCK_HAS_COUNTER //CPU counter readable in user space
+#endif
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Describe the clock modes
+ */
+typedef enum {
+    CLK_REAL,
+    CLK_VIRTUAL
+} clockMode;
+
+/**
+ * \brief Describe the real time sources
+ */
+typedef enum {
+    CLK_SOURCE_MONOTONIC,
+    CLK_SOURCE_COUNTER
+} clockSource;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Get the current time of the library clock
+ *
+ * \return          Current time in nanoseconds (Monotonic)
+ */
+uint64_t GIPY_clockNow(void);
+
+/**
+ * \brief           Sleep for a duration measured with the library clock
+ * \details         In virtual mode, the wall sleep is divided by the speed.
+ *                  In manual stepping, wait till the clock has been advanced.
+ *
+ * \param pDelay    Duration to sleep (ns)
+ * \return void
+ */
+void GIPY_clockSleep(uint64_t);
+
+/**
+ * \brief           Switch the library clock to virtual mode
+ * \details         The virtual time continues from the current clock time
+ *
+ * \param pSpeed    Virtual ns per wall ns (0 for manual stepping)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If speed is negative
+ */
+pirror GIPY_clockSetVirtual(double);
+
+/**
+ * \brief           Switch back the library clock to the real time source
+ * \details         The time continues from the virtual time (No step):
+ *                  real time is then the source time plus a fixed offset.
+ *
+ * \return void
+ */
+void GIPY_clockSetReal(void);
+
+/**
+ * \brief           Move forward a manual stepping virtual clock
+ *
+ * \param pDelay    Duration to add to the clock (ns)
+ * \return GE_OK    If no error
+ * \return GE_PERM  If the clock is not in manual stepping mode
+ */
+pirror GIPY_clockAdvance(uint64_t);
+
+/**
+ * \brief           Get the current clock mode
+ *
+ * \return          CLK_REAL or CLK_VIRTUAL
+ */
+clockMode GIPY_clockGetMode(void);
+
+/**
+ * \brief           Select the real time source (See TIME SOURCE)
+ * \details         Selecting the counter (Again) calibrates it, which takes
+ *                  CLOCK_CALIBRATE_NS on x86-64. The counter continues
+ *                  from the current time. Back to CLOCK_MONOTONIC, the time
+ *                  continues too: CLOCK_MONOTONIC plus the drift of the
+ *                  counter at the switch (Never steps back). Not to be
+ *                  called while other threads read the clock for a
+ *                  duration measure.
+ *
+ * \param pSource   Time source
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid source
+ * \return GE_PERM  If no usable counter (CPU, invariant TSC missing)
+ */
+pirror GIPY_clockSetSource(clockSource);
+
+/**
+ * \brief           Get the current real time source
+ *
+ * \return          CLK_SOURCE_MONOTONIC or CLK_SOURCE_COUNTER
+ */
+clockSource GIPY_clockGetSource(void);
+
+/**
+ * \brief           Get the difference between the source and CLOCK_MONOTONIC
+ * \details         For CLOCK_MONOTONIC, the offset kept when it was selected
+ *                  again (0 if the counter was never used).
+ *
+ * \return          Source time minus CLOCK_MONOTONIC time (ns)
+ */
+int64_t GIPY_clockDrift(void);
+
+/**
+ * \brief           Read the raw CPU counter (Benchmarks)
+ *
+ * \return          Counter ticks, 0 if no counter
+ */
+uint64_t GIPY_clockCounter(void);
+
+/**
+ * \brief           Convert a clock deadline into a CLOCK_MONOTONIC timespec
+ * \details         Used for timed waits (pthread_cond_timedwait with a
+ *                  monotonic condition). In manual stepping, the deadline
+ *                  is given as now + pMaxWall.
+ *
+ * \param pDeadline Clock time to convert (ns)
+ * \param pMaxWall  Maximum wall duration from now (ns)
+ * \param pTs       Timespec to fill
+ * \return void
+ */
+void GIPY_clockToWall(uint64_t, uint64_t, struct timespec*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
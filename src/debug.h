@@ -20,11 +20,13 @@
  * -----------------------------------------------------------------------------
  */
 
-//Set debug mode
+//Set debug mode (Compile with -DDBG_DISABLE to remove all debugs)
+#ifndef DBG_DISABLE
 #define DBG_ACTIVE
 #define DBG_ERR_ACTIVE
 #define DBG_WARN_ACTIVE
 #define DBG_INFO_ACTIVE
+#endif
 
 #ifndef DEBUG_H
 #define DEBUG_H
@@ -0,0 +1,352 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Decoder
+ * Pulse width protocol decoders (Single wire: NEC infrared, DHT22)
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "decoder.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/*
+ * NEC timings (us). Frame: leader, 32 bits LSB first (Address, inverted
+ * address or high address byte, command, inverted command), stop mark.
+ * Repeat code: leader mark, short space, stop mark.
+ */
+#define NEC_LEADER_MARK     9000
+#define NEC_LEADER_SPACE    4500
+#define NEC_REPEAT_SPACE    2250
+#define NEC_BIT_MARK        562
+#define NEC_ZERO_SPACE      562
+#define NEC_ONE_SPACE       1687
+#define NEC_TOLERANCE       25 //Percent
+#define NEC_BITS            32
+
+/*
+ * DHT22 timings (us). After the start signal: response (Low 80, high 80),
+ * then 40 bits MSB first (Low 50, high 26 for 0 or 70 for 1). Data is
+ * humidity (16 bits), temperature (16 bits, sign bit) and checksum.
+ */
+#define DHT22_RESPONSE_MIN  60
+#define DHT22_RESPONSE_MAX  100
+#define DHT22_LOW_MIN       30
+#define DHT22_LOW_MAX       60
+#define DHT22_ZERO_MIN      10
+#define DHT22_ONE_MIN       48
+#define DHT22_ONE_MAX       100
+#define DHT22_BITS          40
+
+/**
+ * \brief   Protocol states (0 is idle)
+ */
+enum {
+    NEC_IDLE, NEC_LEADER, NEC_MARK, NEC_SPACE, NEC_REPEAT
+};
+enum {
+    DHT22_IDLE, DHT22_RESPONSE, DHT22_LOW, DHT22_HIGH
+};
+
+/**
+ * \brief   Edge hook of the decoder pin
+ */
+static void decoderHook(int, int, uint64_t, void*);
+
+/**
+ * \brief   Clear the frame in progress, back to idle state
+ */
+static void decoderReset(pulseDecoder*);
+
+/**
+ * \brief   Check whether a width is a nominal width within NEC_TOLERANCE
+ *
+ * \param   pWidth      Pulse width (ns)
+ * \param   pNominal    Nominal width (us)
+ * \return  TRUE if close enough
+ */
+static int isNear(uint64_t, uint32_t);
+
+/**
+ * \brief   Check whether a width is in a range
+ *
+ * \param   pWidth  Pulse width (ns)
+ * \param   pMin    Min width (us)
+ * \param   pMax    Max width (us)
+ * \return  TRUE if in range
+ */
+static int isWithin(uint64_t, uint32_t, uint32_t);
+
+/**
+ * \brief   NEC state machine (See pulseProtocol)
+ */
+static int necPulse(pulseDecoder*, int, uint64_t);
+
+/**
+ * \brief   DHT22 state machine (See pulseProtocol)
+ */
+static int dht22Pulse(pulseDecoder*, int, uint64_t);
+
+const pulseProtocol GIPY_protocolNec    = {"nec", necPulse};
+const pulseProtocol GIPY_protocolDht22  = {"dht22", dht22Pulse};
+
+
+//------------------------------------------------------------------------------
+// Decoder functions
+//------------------------------------------------------------------------------
+pirror GIPY_decoderOpen(pulseDecoder *pDecoder, int pPin, const pulseProtocol *pProtocol){
+    dbgInfo("Try to open decoder (Pin: %d)", pPin);
+    if(pDecoder == NULL || pProtocol == NULL || pProtocol->pulse == NULL){
+        dbgError("Invalid decoder parameters");
+        return GE_PARAM;
+    }
+    memset(pDecoder, 0, sizeof(pulseDecoder));
+    pDecoder->pin       = pPin;
+    pDecoder->protocol  = pProtocol;
+    pDecoder->level     = -1;
+    if(GIPY_queueInit(&pDecoder->frames, sizeof(decodedFrame), DECODER_QUEUE_SIZE) != GE_OK){
+        return GE_IO;
+    }
+    if(pPin == -1){
+        return GE_OK;
+    }
+
+    //Each edge ends a pulse
+    pirror err = GIPY_pinSetDirectionIn(pPin);
+    err = (err == GE_OK) ? GIPY_pinSetEdgeBoth(pPin) : err;
+    err = (err == GE_OK) ? GIPY_pinSetEdgeHook(pPin, &decoderHook, pDecoder) : err;
+    if(err != GE_OK){
+        dbgError("Unable to configure decoder pin %d", pPin);
+        GIPY_queueFree(&pDecoder->frames);
+        return err;
+    }
+    err = GIPY_pinCreateInterrupt(pPin, NULL);
+    if(err != GE_OK){
+        dbgError("Unable to start decoder interrupt on pin %d", pPin);
+        GIPY_pinSetEdgeHook(pPin, NULL, NULL);
+        GIPY_queueFree(&pDecoder->frames);
+        return err;
+    }
+    dbgInfo("Decoder %s opened on pin %d", pProtocol->name, pPin);
+    return GE_OK;
+}
+
+void GIPY_decoderClose(pulseDecoder *pDecoder){
+    if(pDecoder->pin != -1){
+        GIPY_pinSetEdgeNone(pDecoder->pin);
+        GIPY_pinSetEdgeHook(pDecoder->pin, NULL, NULL);
+    }
+    GIPY_queueFree(&pDecoder->frames);
+}
+
+int GIPY_decoderGetFrame(pulseDecoder *pDecoder, decodedFrame *pFrame){
+    return GIPY_queuePop(&pDecoder->frames, pFrame);
+}
+
+uint64_t GIPY_decoderGetErrors(pulseDecoder *pDecoder){
+    return __atomic_load_n(&pDecoder->errors, __ATOMIC_RELAXED);
+}
+
+int GIPY_decoderPushBit(pulseDecoder *pDecoder, int pBit, int pLsbFirst){
+    uint16_t n = pDecoder->nbBits;
+    if(n >= DECODER_MAX_BYTES * 8){
+        return FALSE;
+    }
+    if(pBit != 0){
+        pDecoder->data[n / 8] |= (uint8_t)(1U << ((pLsbFirst == TRUE) ? n % 8 : 7 - n % 8));
+    }
+    pDecoder->nbBits++;
+    return TRUE;
+}
+
+pirror GIPY_decoderDht22Request(pulseDecoder *pDecoder){
+    int pin = pDecoder->pin;
+    if(pin == -1){
+        return GE_PARAM;
+    }
+
+    //No edge while the line is an output (Refused by the kernel)
+    pirror err = GIPY_pinSetEdgeNone(pin);
+    err = (err == GE_OK) ? GIPY_pinSetDirectionLow(pin) : err;
+    if(err == GE_OK){
+        GIPY_clockSleep(DHT22_START);
+    }
+    err = (err == GE_OK) ? GIPY_pinSetDirectionIn(pin) : err;
+    err = (err == GE_OK) ? GIPY_pinSetEdgeBoth(pin) : err;
+    if(err != GE_OK){
+        dbgError("Unable to send the DHT22 start signal on pin %d", pin);
+        return GE_IO;
+    }
+    return GE_OK;
+}
+
+void GIPY_decoderDht22Values(const decodedFrame *pFrame, double *pHumidity, double *pTemp){
+    const uint8_t *d = pFrame->data;
+    *pHumidity  = (double)((d[0] << 8) | d[1]) / 10.0;
+    *pTemp      = (double)(((d[2] & 0x7F) << 8) | d[3]) / 10.0;
+    *pTemp      = (d[2] & 0x80) ? -*pTemp : *pTemp;
+}
+
+
+//------------------------------------------------------------------------------
+// Event path
+//------------------------------------------------------------------------------
+static void decoderHook(int pPin, int pValue, uint64_t pStamp, void *pContext){
+    GIPY_decoderEdge((pulseDecoder *)pContext, pValue, pStamp);
+}
+
+void GIPY_decoderEdge(pulseDecoder *pDecoder, int pValue, uint64_t pStamp){
+    int level = pDecoder->level;
+
+    //First edge or missed edge: no pulse to measure
+    pDecoder->level = pValue;
+    if(level == -1 || level == pValue || pStamp < pDecoder->lastEdge){
+        if(level != -1 && pDecoder->state != 0){
+            __atomic_add_fetch(&pDecoder->errors, 1, __ATOMIC_RELAXED);
+        }
+        decoderReset(pDecoder);
+        pDecoder->lastEdge = pStamp;
+        return;
+    }
+    uint64_t width      = pStamp - pDecoder->lastEdge;
+    pDecoder->lastEdge  = pStamp;
+
+    //A bad pulse may start the next frame: given again from idle
+    int res = pDecoder->protocol->pulse(pDecoder, level, width);
+    if(res == DECODE_ERROR){
+        __atomic_add_fetch(&pDecoder->errors, 1, __ATOMIC_RELAXED);
+        decoderReset(pDecoder);
+        res = pDecoder->protocol->pulse(pDecoder, level, width);
+    }
+    if(res == DECODE_FRAME){
+        decodedFrame frame;
+        frame.stamp     = pStamp;
+        frame.nbBits    = pDecoder->nbBits;
+        frame.flags     = pDecoder->flags;
+        memcpy(frame.data, pDecoder->data, DECODER_MAX_BYTES);
+        GIPY_queuePush(&pDecoder->frames, &frame);
+        __atomic_add_fetch(&pDecoder->decoded, 1, __ATOMIC_RELAXED);
+    }
+    if(res != DECODE_MORE){
+        decoderReset(pDecoder);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Protocols
+//------------------------------------------------------------------------------
+static int necPulse(pulseDecoder *pDecoder, int pLevel, uint64_t pWidth){
+    int isMark = (pLevel == 0);
+    switch(pDecoder->state){
+        case NEC_IDLE:
+            if(isMark && isNear(pWidth, NEC_LEADER_MARK)){
+                pDecoder->state = NEC_LEADER;
+            }
+            return DECODE_MORE;
+
+        case NEC_LEADER:
+            if(!isMark && isNear(pWidth, NEC_LEADER_SPACE)){
+                pDecoder->state = NEC_MARK;
+                return DECODE_MORE;
+            }
+            if(!isMark && isNear(pWidth, NEC_REPEAT_SPACE)){
+                pDecoder->state = NEC_REPEAT;
+                return DECODE_MORE;
+            }
+            return DECODE_ERROR;
+
+        case NEC_MARK:
+            if(!isMark || !isNear(pWidth, NEC_BIT_MARK)){
+                return DECODE_ERROR;
+            }
+            if(pDecoder->nbBits < NEC_BITS){
+                pDecoder->state = NEC_SPACE;
+                return DECODE_MORE;
+            }
+            //Stop mark. Command is checked (Extended NEC has a 16 bits address)
+            return ((pDecoder->data[2] ^ pDecoder->data[3]) == 0xFF) ? DECODE_FRAME : DECODE_ERROR;
+
+        case NEC_SPACE:
+            if(isMark){
+                return DECODE_ERROR;
+            }
+            if(isNear(pWidth, NEC_ZERO_SPACE) || isNear(pWidth, NEC_ONE_SPACE)){
+                GIPY_decoderPushBit(pDecoder, isNear(pWidth, NEC_ONE_SPACE), TRUE);
+                pDecoder->state = NEC_MARK;
+                return DECODE_MORE;
+            }
+            return DECODE_ERROR;
+
+        case NEC_REPEAT:
+            if(!isMark || !isNear(pWidth, NEC_BIT_MARK)){
+                return DECODE_ERROR;
+            }
+            pDecoder->flags |= DECODER_REPEAT;
+            return DECODE_FRAME;
+    }
+    return DECODE_ERROR;
+}
+
+static int dht22Pulse(pulseDecoder *pDecoder, int pLevel, uint64_t pWidth){
+    const uint8_t *d = pDecoder->data;
+    switch(pDecoder->state){
+        case DHT22_IDLE: //High before the response is the start signal end
+            if(pLevel == 0 && isWithin(pWidth, DHT22_RESPONSE_MIN, DHT22_RESPONSE_MAX)){
+                pDecoder->state = DHT22_RESPONSE;
+            }
+            return DECODE_MORE;
+
+        case DHT22_RESPONSE:
+            if(pLevel == 0 || !isWithin(pWidth, DHT22_RESPONSE_MIN, DHT22_RESPONSE_MAX)){
+                return DECODE_ERROR;
+            }
+            pDecoder->state = DHT22_LOW;
+            return DECODE_MORE;
+
+        case DHT22_LOW:
+            if(pLevel != 0 || !isWithin(pWidth, DHT22_LOW_MIN, DHT22_LOW_MAX)){
+                return DECODE_ERROR;
+            }
+            pDecoder->state = DHT22_HIGH;
+            return DECODE_MORE;
+
+        case DHT22_HIGH:
+            if(pLevel == 0 || !isWithin(pWidth, DHT22_ZERO_MIN, DHT22_ONE_MAX)){
+                return DECODE_ERROR;
+            }
+            GIPY_decoderPushBit(pDecoder, isWithin(pWidth, DHT22_ONE_MIN, DHT22_ONE_MAX), FALSE);
+            if(pDecoder->nbBits < DHT22_BITS){
+                pDecoder->state = DHT22_LOW;
+                return DECODE_MORE;
+            }
+            return ((uint8_t)(d[0] + d[1] + d[2] + d[3]) == d[4]) ? DECODE_FRAME : DECODE_ERROR;
+    }
+    return DECODE_ERROR;
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static void decoderReset(pulseDecoder *pDecoder){
+    pDecoder->state     = 0;
+    pDecoder->nbBits    = 0;
+    pDecoder->flags     = 0;
+    memset(pDecoder->data, 0, DECODER_MAX_BYTES);
+}
+
+static int isNear(uint64_t pWidth, uint32_t pNominal){
+    uint64_t nominal = (uint64_t)pNominal * NSEC_PER_USEC;
+    return pWidth * 100 >= nominal * (100 - NEC_TOLERANCE)
+        && pWidth * 100 <= nominal * (100 + NEC_TOLERANCE);
+}
+
+static int isWithin(uint64_t pWidth, uint32_t pMin, uint32_t pMax){
+    return pWidth >= (uint64_t)pMin * NSEC_PER_USEC && pWidth <= (uint64_t)pMax * NSEC_PER_USEC;
+}
@@ -0,0 +1,191 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Decoder
+ * Pulse width protocol decoders (Single wire: NEC infrared, DHT22)
+ *
+ * PULSES
+ * The decoder is an edge hook of the pin (See GIPY_pinSetEdgeHook): each
+ * edge ends a pulse, given to the protocol as (level, width) in the event
+ * path. Widths come from the edge timestamps, not from the time the hook
+ * runs. An edge is missed if the level did not change since the previous
+ * one (Both lost, or coalesced): the frame in progress is dropped.
+ *
+ * PROTOCOLS
+ * A protocol is a state machine called for each pulse. It reads and
+ * updates the decoder state (0 is idle, waiting for a frame start), pushes
+ * the decoded bits and returns DECODE_MORE, DECODE_FRAME or DECODE_ERROR.
+ * On DECODE_FRAME, the bits are queued as a frame. On DECODE_ERROR, the
+ * framing error is counted and the pulse is given again from the idle
+ * state (It may start the next frame). The state is reset in both cases.
+ * NEC and DHT22 are provided. Lines are active low (IR receivers, DHT22).
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_DECODER_H_
+#define _HEADER_DECODER_H_
+
+#include "gipy.h"
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define DECODER_MAX_BYTES   8 //Max bits of a frame is 8 times this
+#define DECODER_QUEUE_SIZE  32
+#define DECODER_REPEAT      0x01 //Frame flag: repeat code (NEC, no data)
+#define DECODE_MORE         0
+#define DECODE_FRAME        1
+#define DECODE_ERROR        -1
+#define DHT22_START         (2 * NSEC_PER_MSEC) //Start signal (Low, 1 ms min)
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Decoded frame delivered through the decoder queue
+ */
+typedef struct {
+    uint64_t    stamp;      //Edge that ended the frame (Library clock)
+    uint16_t    nbBits;
+    uint8_t     flags;      //DECODER_REPEAT...
+    uint8_t     data[DECODER_MAX_BYTES]; //Bit order of the protocol
+} decodedFrame;
+
+typedef struct pulseDecoder pulseDecoder;
+
+/**
+ * \brief Pulse width protocol (See PROTOCOLS)
+ */
+typedef struct {
+    const char  *name;
+    int         (*pulse)(pulseDecoder*, int, uint64_t); //Level and width (ns)
+} pulseProtocol;
+
+/**
+ * \brief Decoder of one pin (State is only used by the event path)
+ */
+struct pulseDecoder {
+    int                 pin;        //-1 if edges are given by the caller
+    const pulseProtocol *protocol;
+    eventQueue          frames;
+    int                 level;      //Level after the last edge, -1 if unknown
+    uint64_t            lastEdge;   //Timestamp of the last edge
+    uint32_t            state;      //Protocol state, 0 if idle
+    uint16_t            nbBits;     //Bits of the frame in progress
+    uint8_t             flags;      //Flags of the frame in progress
+    uint8_t             data[DECODER_MAX_BYTES];
+    uint64_t            decoded;    //Frames decoded (Queued or dropped)
+    uint64_t            errors;     //Framing errors
+};
+
+extern const pulseProtocol GIPY_protocolNec;
+extern const pulseProtocol GIPY_protocolDht22;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a decoder on a pin and start decoding
+ * \details         The pin must be exported. It is set as input with both
+ *                  edges and gets an interrupt (Hook only). With pin -1,
+ *                  edges are given with GIPY_decoderEdge (Replay).
+ *                  The decoder must stay valid while opened.
+ *
+ * \param pDecoder  Decoder to initialize
+ * \param pPin      Pin of the line, -1 for none
+ * \param pProtocol Protocol to decode
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid parameters
+ * \return GE_PIN   If invalid pin
+ * \return GE_PERM  If the pin is not exported
+ * \return GE_IO    If unable to configure the pin or allocate the queue
+ */
+pirror GIPY_decoderOpen(pulseDecoder*, int, const pulseProtocol*);
+
+/**
+ * \brief           Stop decoding (Edge set to none, hook removed)
+ *
+ * \param pDecoder  Opened decoder
+ * \return void
+ */
+void GIPY_decoderClose(pulseDecoder*);
+
+/**
+ * \brief           Give one edge to the decoder (Called by the edge hook)
+ * \details         Edges of one decoder must be given by one thread, in
+ *                  order.
+ *
+ * \param pDecoder  Opened decoder
+ * \param pValue    Level after the edge
+ * \param pStamp    Timestamp of the edge (ns)
+ * \return void
+ */
+void GIPY_decoderEdge(pulseDecoder*, int, uint64_t);
+
+/**
+ * \brief           Get the next decoded frame (Does not block)
+ *
+ * \param pDecoder  Opened decoder
+ * \param pFrame    Filled with the oldest frame
+ * \return          TRUE if a frame was available, otherwise FALSE
+ */
+int GIPY_decoderGetFrame(pulseDecoder*, decodedFrame*);
+
+/**
+ * \brief           Get the number of framing errors
+ *
+ * \param pDecoder  Opened decoder
+ * \return          Framing errors (Bad pulse width, missed edge, checksum)
+ */
+uint64_t GIPY_decoderGetErrors(pulseDecoder*);
+
+/**
+ * \brief           Add one bit to the frame in progress (Protocols)
+ *
+ * \param pDecoder  Decoder
+ * \param pBit      Bit value
+ * \param pLsbFirst TRUE if bytes are sent LSB first
+ * \return          TRUE if added, FALSE if the frame is full
+ */
+int GIPY_decoderPushBit(pulseDecoder*, int, int);
+
+/**
+ * \brief           Ask a DHT22 for a reading (Start signal)
+ * \details         Drives the line low for DHT22_START, then back as input
+ *                  with both edges. The reading is a frame of 40 bits.
+ *                  A DHT22 can be read every 2 seconds at most.
+ *
+ * \param pDecoder  Decoder opened with GIPY_protocolDht22
+ * \return GE_OK    If no error
+ * \return GE_PARAM If no pin
+ * \return GE_IO    If unable to configure the pin
+ */
+pirror GIPY_decoderDht22Request(pulseDecoder*);
+
+/**
+ * \brief           Convert a DHT22 frame
+ *
+ * \param pFrame    Frame decoded by GIPY_protocolDht22
+ * \param pHumidity Filled with the relative humidity (%)
+ * \param pTemp     Filled with the temperature (Celsius)
+ * \return void
+ */
+void GIPY_decoderDht22Values(const decodedFrame*, double*, double*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Encoder
+ * Quadrature rotary encoder decoder
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "encoder.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Edge hook of both encoder pins
+ */
+static void encoderHook(int, int, uint64_t, void*);
+
+/*
+ * \brief   Quadrature state table. Index is (old AB << 2) | new AB
+ * \details 0 no move, 1 forward, -1 backward, 2 illegal (Both lines changed)
+ */
+static const int8_t quadTable[16] = {
+     0, -1,  1,  2,
+     1,  0,  2, -1,
+    -1,  2,  0,  1,
+     2,  1, -1,  0
+};
+#define QUAD_ILLEGAL 2
+
+
+//------------------------------------------------------------------------------
+// Encoder functions
+//------------------------------------------------------------------------------
+pirror GIPY_encoderOpen(quadEncoder *pEncoder, int pPinA, int pPinB){
+    dbgInfo("Try to open encoder (A: %d, B: %d)", pPinA, pPinB);
+    if(pEncoder == NULL || pPinA == pPinB){
+        dbgError("Invalid encoder parameters");
+        return GE_PARAM;
+    }
+    memset(pEncoder, 0, sizeof(quadEncoder));
+    pEncoder->pinA = pPinA;
+    pEncoder->pinB = pPinB;
+
+    //Both lines are inputs, each edge is an event
+    pirror err = GIPY_pinSetDirectionIn(pPinA);
+    err = (err == GE_OK) ? GIPY_pinSetDirectionIn(pPinB) : err;
+    err = (err == GE_OK) ? GIPY_pinSetEdgeBoth(pPinA) : err;
+    err = (err == GE_OK) ? GIPY_pinSetEdgeBoth(pPinB) : err;
+    if(err != GE_OK){
+        dbgError("Unable to configure encoder pins");
+        return err;
+    }
+    int pins[2] = {pPinA, pPinB};
+    err = GIPY_bankOpen(&pEncoder->lines, pins, 2);
+    if(err != GE_OK){
+        return err;
+    }
+
+    //Initial state, then start decoding
+    uint32_t levels = 0;
+    GIPY_bankRead(&pEncoder->lines, 0x03, &levels);
+    pEncoder->state = ((levels & 0x01) << 1) | ((levels >> 1) & 0x01);
+    err = GIPY_pinSetEdgeHook(pPinA, &encoderHook, pEncoder);
+    err = (err == GE_OK) ? GIPY_pinSetEdgeHook(pPinB, &encoderHook, pEncoder) : err;
+    err = (err == GE_OK) ? GIPY_pinCreateInterrupt(pPinA, NULL) : err;
+    err = (err == GE_OK) ? GIPY_pinCreateInterrupt(pPinB, NULL) : err;
+    if(err != GE_OK){
+        dbgError("Unable to start encoder interrupts");
+        GIPY_pinSetEdgeHook(pPinA, NULL, NULL);
+        GIPY_pinSetEdgeHook(pPinB, NULL, NULL);
+        GIPY_bankClose(&pEncoder->lines);
+        return err;
+    }
+    dbgInfo("Encoder opened (State: %u)", pEncoder->state);
+    return GE_OK;
+}
+
+void GIPY_encoderClose(quadEncoder *pEncoder){
+    GIPY_pinSetEdgeNone(pEncoder->pinA);
+    GIPY_pinSetEdgeNone(pEncoder->pinB);
+    GIPY_pinSetEdgeHook(pEncoder->pinA, NULL, NULL);
+    GIPY_pinSetEdgeHook(pEncoder->pinB, NULL, NULL);
+    GIPY_bankClose(&pEncoder->lines);
+}
+
+int64_t GIPY_encoderGetPosition(quadEncoder *pEncoder){
+    return __atomic_load_n(&pEncoder->position, __ATOMIC_RELAXED);
+}
+
+void GIPY_encoderSetPosition(quadEncoder *pEncoder, int64_t pPosition){
+    __atomic_store_n(&pEncoder->position, pPosition, __ATOMIC_RELAXED);
+}
+
+double GIPY_encoderGetVelocity(quadEncoder *pEncoder){
+    int64_t     interval    = __atomic_load_n(&pEncoder->interval, __ATOMIC_RELAXED);
+    uint64_t    lastStep    = __atomic_load_n(&pEncoder->lastStep, __ATOMIC_RELAXED);
+    uint64_t    now         = GIPY_clockNow();
+    if(interval == 0){
+        return 0.0;
+    }
+
+    //No step for longer than the last interval: the encoder slows down
+    uint64_t period = (uint64_t)((interval < 0) ? -interval : interval);
+    if(now > lastStep && now - lastStep > period){
+        period = now - lastStep;
+    }
+    double velocity = (double)NSEC_PER_SEC / (double)period;
+    return (interval < 0) ? -velocity : velocity;
+}
+
+uint64_t GIPY_encoderGetIllegal(quadEncoder *pEncoder){
+    return __atomic_load_n(&pEncoder->illegal, __ATOMIC_RELAXED);
+}
+
+
+//------------------------------------------------------------------------------
+// Event path
+//------------------------------------------------------------------------------
+static void encoderHook(int pPin, int pValue, uint64_t pStamp, void *pContext){
+    quadEncoder *enc = (quadEncoder *)pContext;
+    uint32_t    oldState, newState, levels;
+
+    /*
+     * Both pins have their own interrupt thread. The lines are sampled
+     * after loading the old state: if another thread commits a state in
+     * between, the exchange fails and the lines are sampled again.
+     */
+    oldState = __atomic_load_n(&enc->state, __ATOMIC_ACQUIRE);
+    do{
+        if(GIPY_bankRead(&enc->lines, 0x03, &levels) != GE_OK){
+            return;
+        }
+        newState = ((levels & 0x01) << 1) | ((levels >> 1) & 0x01);
+        if(newState == oldState){
+            return; //Already handled by the other line
+        }
+    }while(!__atomic_compare_exchange_n(&enc->state, &oldState, newState,
+                FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    //Apply the transition
+    int8_t move = quadTable[(oldState << 2) | newState];
+    if(move == QUAD_ILLEGAL){
+        __atomic_add_fetch(&enc->illegal, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_add_fetch(&enc->position, move, __ATOMIC_RELAXED);
+    uint64_t last = __atomic_exchange_n(&enc->lastStep, pStamp, __ATOMIC_RELAXED);
+    if(last != 0 && pStamp > last){
+        int64_t interval = (int64_t)(pStamp - last);
+        __atomic_store_n(&enc->interval, (move > 0) ? interval : -interval, __ATOMIC_RELAXED);
+    }
+}
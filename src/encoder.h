@@ -0,0 +1,116 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Encoder
+ * Quadrature rotary encoder decoder
+ *
+ * The decoder is an edge hook on both pins (See GIPY_pinSetEdgeHook):
+ * at each edge, both lines are sampled and the quadrature state table is
+ * applied in the event path. Position, velocity and illegal transitions
+ * (Both lines changed between two samples) are updated with atomic
+ * operations, so the application only polls the counters (No lock).
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_ENCODER_H_
+#define _HEADER_ENCODER_H_
+
+#include "gipy.h"
+#include "bank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Quadrature encoder (Counters are updated by the event path)
+ */
+typedef struct {
+    int         pinA;
+    int         pinB;
+    pinBank     lines;      //Bit 0: A, bit 1: B
+    uint32_t    state;      //Last sampled AB state (A is bit 1)
+    int64_t     position;   //Steps (Four per encoder cycle)
+    uint64_t    illegal;    //Illegal transitions
+    uint64_t    lastStep;   //Timestamp of the last step
+    int64_t     interval;   //Last step interval (ns), negative if backward
+} quadEncoder;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Bind an encoder on two pins and start decoding
+ * \details         Pins must be exported. They are set as input with both
+ *                  edges and get an interrupt (Hook only, no debounce).
+ *                  The encoder must stay valid while opened.
+ *
+ * \param pEncoder  Encoder to initialize
+ * \param pPinA     Pin of the A line
+ * \param pPinB     Pin of the B line
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid parameters
+ * \return GE_PIN   If invalid pin
+ * \return GE_PERM  If a pin is not exported
+ * \return GE_IO    If unable to configure a pin
+ */
+pirror GIPY_encoderOpen(quadEncoder*, int, int);
+
+/**
+ * \brief           Stop decoding (Edge set to none, hooks removed)
+ *
+ * \param pEncoder  Opened encoder
+ * \return void
+ */
+void GIPY_encoderClose(quadEncoder*);
+
+/**
+ * \brief           Get the current position (Steps)
+ *
+ * \param pEncoder  Opened encoder
+ * \return          Position
+ */
+int64_t GIPY_encoderGetPosition(quadEncoder*);
+
+/**
+ * \brief           Set the current position (Steps)
+ *
+ * \param pEncoder  Opened encoder
+ * \param pPosition New position
+ * \return void
+ */
+void GIPY_encoderSetPosition(quadEncoder*, int64_t);
+
+/**
+ * \brief           Get the velocity estimate (Steps per second)
+ * \details         Computed from the last step interval. It decays when no
+ *                  step happens for longer than this interval.
+ *
+ * \param pEncoder  Opened encoder
+ * \return          Velocity (Negative if backward)
+ */
+double GIPY_encoderGetVelocity(quadEncoder*);
+
+/**
+ * \brief           Get the number of illegal transitions (Missed steps)
+ *
+ * \param pEncoder  Opened encoder
+ * \return          Illegal transitions count
+ */
+uint64_t GIPY_encoderGetIllegal(quadEncoder*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
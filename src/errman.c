@@ -1,4 +1,4 @@
-
+/*
  * -----------------------------------------------------------------------------
  * Function for error management and display
  * All the possible error are set from pirror
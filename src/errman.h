@@ -13,6 +13,10 @@
 #include <stdio.h>
 #include <stdarg.h> // For va_list
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 // -----------------------------------------------------------------------------
 // Enum
@@ -51,5 +55,9 @@ typedef enum {
 void printError(FILE *pStream, const char *fmt, ...);
 
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
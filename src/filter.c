@@ -0,0 +1,280 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Filter
+ * N-of-M glitch filter for sampled inputs
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "filter.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Sample thread. One sample every 1/sampleRate
+ */
+static void *sampleThread(void*);
+
+/**
+ * \brief   Read all the pins in lanes (One bank read per 32 pins)
+ *
+ * \param   pFilter Opened filter
+ * \param   pSample Filled with one word per lane
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror readSample(pinFilter*, uint64_t*);
+
+/**
+ * \brief   Compare the counters of all pins with a constant
+ *
+ * \param   pFilter Filter
+ * \param   pValue  Value to compare with
+ * \param   pResult Filled with one word per lane: bit set if count >= pValue
+ * \return  void
+ */
+static void countAtLeast(const pinFilter*, int, uint64_t*);
+
+
+//------------------------------------------------------------------------------
+// Filter functions
+//------------------------------------------------------------------------------
+pirror GIPY_filterOpen(pinFilter *pFilter, const filterConfig *pConfig){
+    dbgInfo("Try to open filter");
+    if(pFilter == NULL || pConfig == NULL || pConfig->sampleRate == 0
+            || GIPY_filterInit(pFilter, pConfig->nbPins, pConfig->samples, pConfig->threshold) != GE_OK){
+        dbgError("Invalid filter configuration");
+        return GE_PARAM;
+    }
+    pFilter->config = *pConfig;
+
+    pirror  err = GE_OK;
+    int     k;
+    for(k=0; k<pConfig->nbPins && err == GE_OK; k++){
+        err = GIPY_pinSetDirectionIn(pConfig->pins[k]);
+    }
+    if(err != GE_OK){
+        dbgError("Unable to configure filter pins");
+        return err;
+    }
+
+    //One bank per 32 pins: bank b is the half (b % 2) of lane (b / 2)
+    for(k=0; k*BANK_MAX_PINS < pConfig->nbPins && err == GE_OK; k++){
+        int nb  = pConfig->nbPins - k * BANK_MAX_PINS;
+        err     = GIPY_bankOpen(&pFilter->banks[k], &pConfig->pins[k * BANK_MAX_PINS],
+                (nb > BANK_MAX_PINS) ? BANK_MAX_PINS : nb);
+        if(err == GE_OK){
+            pFilter->nbBanks++;
+        }
+    }
+    if(err == GE_OK){
+        err = GIPY_queueInit(&pFilter->events, sizeof(filterEvent), FILTER_QUEUE_SIZE);
+    }
+    if(err != GE_OK){
+        for(k=0; k<pFilter->nbBanks; k++){
+            GIPY_bankClose(&pFilter->banks[k]);
+        }
+        return err;
+    }
+
+    pFilter->running = TRUE;
+    pthread_create(&pFilter->thread, NULL, &sampleThread, pFilter);
+    dbgInfo("Filter opened (%d pins, %d of %d, %u samples/s)", pConfig->nbPins,
+            pConfig->threshold, pConfig->samples, pConfig->sampleRate);
+    return GE_OK;
+}
+
+void GIPY_filterClose(pinFilter *pFilter){
+    int k;
+    __atomic_store_n(&pFilter->running, FALSE, __ATOMIC_RELEASE);
+    pthread_join(pFilter->thread, NULL);
+    for(k=0; k<pFilter->nbBanks; k++){
+        GIPY_bankClose(&pFilter->banks[k]);
+    }
+    GIPY_queueFree(&pFilter->events);
+}
+
+int GIPY_filterGetEvent(pinFilter *pFilter, filterEvent *pEvent){
+    return GIPY_queuePop(&pFilter->events, pEvent);
+}
+
+int GIPY_filterGetLevel(pinFilter *pFilter, int pIndex){
+    if(pIndex < 0 || pIndex >= pFilter->config.nbPins){
+        return -1;
+    }
+    uint64_t lane = __atomic_load_n(&pFilter->levels[pIndex / FILTER_LANE_BITS], __ATOMIC_ACQUIRE);
+    return (lane >> (pIndex % FILTER_LANE_BITS)) & 0x01;
+}
+
+pirror GIPY_filterInit(pinFilter *pFilter, int pNbPins, int pSamples, int pThreshold){
+    if(pFilter == NULL || pNbPins < 1 || pNbPins > FILTER_MAX_PINS
+            || pSamples < 1 || pSamples > FILTER_MAX_SAMPLES
+            || pThreshold > pSamples || 2 * pThreshold <= pSamples){
+        return GE_PARAM;
+    }
+    memset(pFilter, 0, sizeof(pinFilter));
+    pFilter->config.nbPins      = pNbPins;
+    pFilter->config.samples     = pSamples;
+    pFilter->config.threshold   = pThreshold;
+    pFilter->nbLanes            = (pNbPins + FILTER_LANE_BITS - 1) / FILTER_LANE_BITS;
+    pFilter->nbPlanes           = 32 - __builtin_clz((unsigned)pSamples);
+    return GE_OK;
+}
+
+int GIPY_filterPush(pinFilter *pFilter, const uint64_t *pSample, uint64_t *pChanged){
+    uint64_t    carry[FILTER_MAX_LANES];
+    uint64_t    borrow[FILTER_MAX_LANES];
+    uint64_t    high[FILTER_MAX_LANES];
+    uint64_t    keep[FILTER_MAX_LANES];
+    uint64_t    *oldest = pFilter->history[pFilter->head];
+    int         nbLanes = pFilter->nbLanes;
+    int         nbSamples = pFilter->config.samples;
+    uint64_t    any     = 0;
+    int         l, p;
+
+    //First sample: the window is full of it
+    if(pFilter->samples++ == 0){
+        for(p=0; p<nbSamples; p++){
+            memcpy(pFilter->history[p], pSample, nbLanes * sizeof(uint64_t));
+        }
+        for(p=0; p<pFilter->nbPlanes; p++){
+            for(l=0; l<nbLanes; l++){
+                pFilter->counters[p][l] = ((nbSamples >> p) & 0x01) ? pSample[l] : 0;
+            }
+        }
+        for(l=0; l<nbLanes; l++){
+            __atomic_store_n(&pFilter->levels[l], pSample[l], __ATOMIC_RELEASE);
+            if(pChanged != NULL){
+                pChanged[l] = 0;
+            }
+        }
+        return FALSE;
+    }
+
+    //Pins counting one more (New high sample replaces a low one) or one less
+    for(l=0; l<nbLanes; l++){
+        carry[l]    = pSample[l] & ~oldest[l];
+        borrow[l]   = oldest[l] & ~pSample[l];
+        oldest[l]   = pSample[l];
+    }
+    pFilter->head = (pFilter->head + 1 == nbSamples) ? 0 : pFilter->head + 1;
+
+    //Vertical counters: ripple the carries (Increment) and borrows (Decrement)
+    //A pin has a carry or a borrow, never both
+    for(p=0; p<pFilter->nbPlanes; p++){
+        uint64_t *plane = pFilter->counters[p];
+        for(l=0; l<nbLanes; l++){
+            uint64_t nextCarry  = plane[l] & carry[l];
+            uint64_t nextBorrow = ~plane[l] & borrow[l];
+            plane[l]            ^= carry[l] | borrow[l];
+            carry[l]            = nextCarry;
+            borrow[l]           = nextBorrow;
+        }
+    }
+
+    //High if count >= N, kept high if count > M - N
+    countAtLeast(pFilter, pFilter->config.threshold, high);
+    countAtLeast(pFilter, nbSamples - pFilter->config.threshold + 1, keep);
+    for(l=0; l<nbLanes; l++){
+        uint64_t level  = pFilter->levels[l];
+        uint64_t next   = high[l] | (level & keep[l]);
+        uint64_t change = level ^ next;
+        if(pChanged != NULL){
+            pChanged[l] = change;
+        }
+        any |= change;
+        __atomic_store_n(&pFilter->levels[l], next, __ATOMIC_RELEASE);
+    }
+    return (any != 0) ? TRUE : FALSE;
+}
+
+
+//------------------------------------------------------------------------------
+// Sample functions
+//------------------------------------------------------------------------------
+static void *sampleThread(void *pFilter){
+    pinFilter   *filter = (pinFilter *)pFilter;
+    uint64_t    period  = NSEC_PER_SEC / filter->config.sampleRate;
+    uint64_t    next    = GIPY_clockNow();
+    uint64_t    sample[FILTER_MAX_LANES];
+    uint64_t    changed[FILTER_MAX_LANES];
+    int         l;
+    dbgInfo("Start filter sample thread");
+
+    while(__atomic_load_n(&filter->running, __ATOMIC_ACQUIRE) == TRUE){
+        if(readSample(filter, sample) == GE_OK
+                && GIPY_filterPush(filter, sample, changed) == TRUE){
+            //Stable changes only: one event per changed pin
+            for(l=0; l<filter->nbLanes; l++){
+                while(changed[l] != 0){
+                    int         k       = __builtin_ctzll(changed[l]);
+                    int         index   = l * FILTER_LANE_BITS + k;
+                    filterEvent event;
+                    changed[l]          &= changed[l] - 1;
+                    event.stamp         = next;
+                    event.pin           = filter->config.pins[index];
+                    event.level         = (filter->levels[l] >> k) & 0x01;
+                    GIPY_queuePush(&filter->events, &event);
+                    filter->changes++;
+                }
+            }
+        }
+
+        //Fixed rate: the next sample time does not drift with the read duration
+        next += period;
+        uint64_t now = GIPY_clockNow();
+        if(next > now){
+            GIPY_clockSleep(next - now);
+        }
+        else{
+            next = now; //Late, do not try to catch up
+        }
+    }
+    dbgInfo("Filter sample thread stopped");
+    return NULL;
+}
+
+static pirror readSample(pinFilter *pFilter, uint64_t *pSample){
+    uint32_t    values;
+    int         b;
+    memset(pSample, 0, pFilter->nbLanes * sizeof(uint64_t));
+    for(b=0; b<pFilter->nbBanks; b++){
+        if(GIPY_bankRead(&pFilter->banks[b], ~0U, &values) != GE_OK){
+            return GE_IO;
+        }
+        pSample[b / 2] |= (uint64_t)values << ((b % 2) * BANK_MAX_PINS);
+    }
+    return GE_OK;
+}
+
+static void countAtLeast(const pinFilter *pFilter, int pValue, uint64_t *pResult){
+    uint64_t    greater[FILTER_MAX_LANES];
+    int         l, p;
+
+    //From the highest plane: pins still equal to pValue, pins already greater
+    for(l=0; l<pFilter->nbLanes; l++){
+        greater[l]  = 0;
+        pResult[l]  = ~0ULL; //Equal so far
+    }
+    for(p=pFilter->nbPlanes-1; p>=0; p--){
+        const uint64_t *plane = pFilter->counters[p];
+        if((pValue >> p) & 0x01){
+            for(l=0; l<pFilter->nbLanes; l++){
+                pResult[l] &= plane[l];
+            }
+        }
+        else{
+            for(l=0; l<pFilter->nbLanes; l++){
+                greater[l]  |= pResult[l] & plane[l];
+                pResult[l]  &= ~plane[l];
+            }
+        }
+    }
+    for(l=0; l<pFilter->nbLanes; l++){
+        pResult[l] |= greater[l];
+    }
+}
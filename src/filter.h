@@ -0,0 +1,167 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Filter
+ * N-of-M glitch filter for sampled inputs
+ *
+ * SAMPLING
+ * A sample thread reads all the pins at a fixed rate with bank reads (See
+ * bank.h, one bank per 32 pins) and packs them in 64 bits lanes: bit k of
+ * lane l is pin (l * 64 + k). No edge interrupt is used.
+ *
+ * FILTER
+ * Each pin counts its ones among the last M samples. All pins of a lane are
+ * counted together with vertical counters: counter bit p of all pins is one
+ * word (Plane p), a sample costs a few bitwise operations per plane and per
+ * lane, whatever the number of pins set. A pin goes high when at least N
+ * samples are high, low when at most M - N samples are high, and keeps its
+ * level in between (N > M / 2: N = (M + 1) / 2 with M odd is a majority
+ * vote). Only these stable changes are queued as events.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_FILTER_H_
+#define _HEADER_FILTER_H_
+
+#include "gipy.h"
+#include "bank.h"
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define FILTER_MAX_PINS     256
+#define FILTER_LANE_BITS    64
+#define FILTER_MAX_LANES    (FILTER_MAX_PINS / FILTER_LANE_BITS)
+#define FILTER_MAX_BANKS    (FILTER_MAX_PINS / BANK_MAX_PINS)
+#define FILTER_MAX_SAMPLES  32 //Max window (M)
+#define FILTER_MAX_PLANES   6  //Counter bits for FILTER_MAX_SAMPLES
+#define FILTER_QUEUE_SIZE   256
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Filter configuration
+ */
+typedef struct {
+    int         nbPins;
+    int         pins[FILTER_MAX_PINS];
+    int         samples;    //Window (M)
+    int         threshold;  //High samples to go high (N), M - N to go low
+    uint32_t    sampleRate; //Samples per second
+} filterConfig;
+
+/**
+ * \brief Filtered edge delivered through the filter queue
+ */
+typedef struct {
+    uint64_t    stamp;      //Sample time (Library clock)
+    int32_t     pin;        //Pin number
+    uint8_t     level;      //New filtered level
+} filterEvent;
+
+/**
+ * \brief Filter engine. Bit k of lane l is pin index (l * 64 + k)
+ */
+typedef struct {
+    filterConfig    config;
+    int             nbLanes;
+    int             nbPlanes;
+    uint64_t        history[FILTER_MAX_SAMPLES][FILTER_MAX_LANES]; //Last M samples
+    int             head;       //Oldest sample in history
+    uint64_t        counters[FILTER_MAX_PLANES][FILTER_MAX_LANES];
+    uint64_t        levels[FILTER_MAX_LANES]; //Filtered levels
+    uint64_t        samples;    //Samples pushed
+    uint64_t        changes;    //Filtered level changes
+    int             nbBanks;
+    pinBank         banks[FILTER_MAX_BANKS];
+    eventQueue      events;
+    int             running;
+    pthread_t       thread;
+} pinFilter;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a filter on pins and start sampling
+ * \details         Pins must be exported. They are set as inputs. The
+ *                  first sample sets the filtered levels (No event).
+ *
+ * \param pFilter   Filter to initialize
+ * \param pConfig   Filter configuration
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid configuration
+ * \return GE_PERM  If a pin is not exported
+ * \return GE_IO    If unable to configure a pin
+ */
+pirror GIPY_filterOpen(pinFilter*, const filterConfig*);
+
+/**
+ * \brief           Stop sampling and close the filter
+ *
+ * \param pFilter   Opened filter
+ * \return void
+ */
+void GIPY_filterClose(pinFilter*);
+
+/**
+ * \brief           Get the next filtered edge (Does not block)
+ *
+ * \param pFilter   Opened filter
+ * \param pEvent    Filled with the oldest event
+ * \return          TRUE if an event was available, otherwise FALSE
+ */
+int GIPY_filterGetEvent(pinFilter*, filterEvent*);
+
+/**
+ * \brief           Get the filtered level of a pin
+ *
+ * \param pFilter   Opened filter
+ * \param pIndex    Index of the pin in the configuration
+ * \return          Filtered level, -1 if invalid index
+ */
+int GIPY_filterGetLevel(pinFilter*, int);
+
+/**
+ * \brief           Initialize the filter state only (No pin, no thread)
+ * \details         For samples from another source (See GIPY_filterPush).
+ *                  Nothing to free.
+ *
+ * \param pFilter   Filter to initialize
+ * \param pNbPins   Number of pins (Bits) per sample
+ * \param pSamples  Window (M)
+ * \param pThreshold High samples to go high (N)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid parameters (2 * N must be more than M)
+ */
+pirror GIPY_filterInit(pinFilter*, int, int, int);
+
+/**
+ * \brief           Push one sample in the filter
+ *
+ * \param pFilter   Initialized filter
+ * \param pSample   One word per lane (Bits over the number of pins are 0)
+ * \param pChanged  Filled with the changed levels, one word per lane (Or NULL)
+ * \return          TRUE if a filtered level changed, otherwise FALSE
+ */
+int GIPY_filterPush(pinFilter*, const uint64_t*, uint64_t*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -8,20 +8,320 @@
  * -----------------------------------------------------------------------------
  */
 
+#include <errno.h>
+#include <sys/eventfd.h>
+
 #include "gipy.h"
+#include "simul.h"
+#include "bank.h"
+#include "trace.h"
 
 
 //------------------------------------------------------------------------------
 // Private header (Static functions / Vars)
 //------------------------------------------------------------------------------
 
+/*
+ * \brief   Pin handle. Resolved once at export, used without any lookup
+ */
+struct gipyPin {
+    int                 pin;
+    int                 fd;         //Opened value file, -1 if pin is unexported (Atomic)
+    volatile uint32_t   *registers; //Mapped registers, NULL for sysfs backend
+    uint32_t            gpioBit;    //Bit of the pin in the registers
+    int                 value;      //Last value written by the library, -1 if unknown (Atomic)
+};
+
+/*
+ * \brief   Parameter of an interrupt handler thread
+ */
+typedef struct {
+    int         pin;
+    uint32_t    generation;     //Handler stops when the pin generation changes
+} handlerArg;
+
+/*
+ * \brief   Adaptive mode setting of a pin (See GIPY_pinSetAdaptive)
+ */
+typedef struct {
+    uint32_t    highRate;       //Edges/s to switch to sampled mode, 0 if disabled
+    uint32_t    lowRate;        //Edges/s to switch back to interrupt mode
+    uint64_t    period;         //Sampling period (ns)
+} pinAdapt;
+
+/*
+ * \brief   Rate limit setting of a pin (See GIPY_pinSetRateLimit)
+ */
+typedef struct {
+    uint64_t    minInterval;    //Min time between two events, 0 if disabled
+    uint32_t    stormRate;      //Edges/s of a storm, 0 if disabled
+    uint64_t    backOff;        //Base time the edge is disabled after a storm
+} pinLimit;
+
+/*
+ * \brief   Input mirror of a pin (See GIPY_pinSetMirror)
+ * \details Seqlock (See seqWriteBegin): the sampler, the interrupt handler
+ *          and the callers may publish.
+ */
+typedef struct {
+    uint32_t    seq;
+    int         value;          //Mirrored level (Atomic)
+    uint64_t    stamp;          //Time the level was read, 0 if none (Atomic)
+    uint64_t    maxAge;         //Max age of the level (ns), 0 if not mirrored
+} pinMirror;
+
+/*
+ * \brief   State of one GPIO line
+ */
+typedef struct {
+    GIPY_Pin    handle;
+    void        (*isr)(void);   //ISR function
+    pinEdgeHook hook;           //Edge hook, called before the ISR function
+    void        *hookContext;
+    int         isHookBusy;     //TRUE while the handler may call the hook
+    pthread_mutex_t lock;       //Configuration changes (Export, direction, edge)
+    int         users;          //Int functions using the value file
+    uint32_t    generation;     //Changed by each export / unexport
+    uint32_t    handlerGeneration; //Generation of the last interrupt handler
+    int         wakeFile;       //Eventfd waking the handler on unexport, -1 if none
+    uint32_t    statsSeq;       //Seqlock of stats (See seqWriteBegin)
+    pinStats    stats;          //Written by the interrupt handler and reset
+    pinEdge     edge;           //Edge set by the user (Restored after sampling)
+    int         direction;      //IN or OUT, -1 if not known (See pinDirectionOf)
+    pinAdapt    adapt;
+    pinLimit    limit;
+    pinMirror   mirror;
+    uint32_t    eventCount;     //Edges of the event being handled
+} pinSlot;
+
+/*
+ * \brief   Range of virtual pins (Free if count is 0)
+ */
+typedef struct {
+    int                 base;
+    int                 count;      //Atomic, set once the range is filled
+    const virtualPinOps *ops;
+    void                *context;
+} virtualRange;
+
+/*
+ * \brief   Pin table, built from the discovered gpiochips
+ * \details slotIndex[pin - pinBase] is the slot of the pin (-1 if no line).
+ *          Slots exist only for real lines, the index costs 4 bytes per 
+ *          number between the lowest and the highest line.
+ */
+typedef struct {
+    int         pinBase;
+    int         pinSpan;
+    int         nbSlots;
+    int32_t     *slotIndex;
+    pinSlot     *slots;
+    int         nbChips;
+    gpioChip    *chips;
+    int         nbExported;
+} pinTable;
+
+/**
+ * \brief   Get the slot of a pin (Build the pin table if not done yet)
+ *
+ * \param   int the pin number
+ * \return  Slot of the pin, NULL if not a valid pin number
+ */
+static pinSlot *getPinSlot(const int);
+
 /**
- * \brief   Check whether the pin number is valid
+ * \brief   Get the virtual range of a pin (See gipyAddVirtualPins)
  *
  * \param   int the pin number
- * \return  TRUE if valid, otherwise, return FALSE
+ * \return  Range of the pin, NULL if not a virtual pin
+ */
+static virtualRange *getVirtualRange(const int);
+
+/**
+ * \brief   Use the value file of a pin in an int function (See pinRelease)
+ * \details Unexport closes the value file once no int function uses it.
+ *
+ * \param   slot of the pin
+ * \return  TRUE if the pin is exported, otherwise FALSE (Nothing to release)
+ */
+static int pinAcquire(pinSlot*);
+
+/**
+ * \brief   Stop using the value file of a pin (See pinAcquire)
+ */
+static void pinRelease(pinSlot*);
+
+/**
+ * \brief   Replace the value file of a pin (Configuration lock held)
+ * \details The interrupt handler of the previous file stops. The previous
+ *          file is closed once no int function uses it.
+ *
+ * \param   slot of the pin
+ * \param   new value file, -1 if unexported
+ * \return  previous value file, -1 if the pin was not exported
+ */
+static int swapValueFile(pinSlot*, int);
+
+/**
+ * \brief   Export a pin (Configuration lock held, see GIPY_pinExport)
+ */
+static pirror exportPin(pinSlot*, int);
+
+/**
+ * \brief   Read back the state of a pin exported before this process
+ *          (Configuration lock held, see GIPY_pinExport)
+ * \details Edge and output level are taken from the sysfs files. Nothing
+ *          is written: an output keeps its level.
+ *
+ * \param   slot of the pin (Value file opened)
+ * \param   pin number
+ * \return void
+ */
+static void adoptState(pinSlot*, int);
+
+/**
+ * \brief   Unexport a pin (Configuration lock held, see GIPY_pinUnexport)
+ */
+static pirror unexportPin(pinSlot*, int);
+
+/**
+ * \brief   Build the pin table from the gpiochips found in sysfs root
+ * \details If no gpiochip is found, PINS_AVAILABLE are used
+ *
+ * \return  New table, NULL if not enough memory
+ */
+static pinTable *discoverPins(void);
+
+/**
+ * \brief   Read an integer from a sysfs attribute file
+ *
+ * \param   path of the file
+ * \param   filled with the read value
+ * \return  TRUE if read, otherwise FALSE
+ */
+static int readSysfsInt(const char*, int*);
+
+/**
+ * \brief   Read the text of a sysfs attribute file
+ *
+ * \param   path of the file
+ * \param   filled with the text (Null terminated)
+ * \param   size of the buffer
+ * \return  TRUE if read, otherwise FALSE
+ */
+static int readSysfsText(const char*, char*, size_t);
+
+/**
+ * \brief   Convert the text of an edge file ("none", "rising"...)
+ *
+ * \param   text read in the file
+ * \return  Edge, NONE if unknown
+ */
+static pinEdge parseEdge(const char*);
+
+/**
+ * \brief   Compare two pin numbers (qsort)
+ */
+static int comparePins(const void*, const void*);
+
+/**
+ * \brief   Get the direction of an exported pin (Configuration lock held)
+ * \details Read from the direction file once if not known yet.
+ *
+ * \param   slot of the pin
+ * \param   pin number
+ * \return  IN or OUT, -1 if unreadable
+ */
+static int pinDirectionOf(pinSlot*, int);
+
+/**
+ * \brief   Apply the snapshot of one pin (See GIPY_snapshotRestore)
+ *
+ * \param   snapshot of the pin
+ * \param   incremented for each change
+ * \return  GE_OK if no error, otherwise error of the pin function
+ */
+static pirror restorePin(const pinSnapshot*, int*);
+
+/**
+ * \brief           Start writing data protected by a seqlock
+ * \details         Odd while written. Writers take it with a CAS: several
+ *                  threads may write, readers never wait for them.
+ *
+ * \param           sequence counter
+ * \return void
+ */
+static void seqWriteBegin(uint32_t*);
+
+/**
+ * \brief           End writing data protected by a seqlock
+ */
+static void seqWriteEnd(uint32_t*);
+
+/**
+ * \brief           Start reading data protected by a seqlock
+ *
+ * \param           sequence counter
+ * \return          Sequence to check with seqReadRetry (Even)
+ */
+static uint32_t seqReadBegin(uint32_t*);
+
+/**
+ * \brief           Check whether the data read may be inconsistent
+ *
+ * \param           sequence counter
+ * \param           sequence returned by seqReadBegin
+ * \return          TRUE if written meanwhile (Read again)
  */
-static int isValidPinNumber(const int);
+static int seqReadRetry(uint32_t*, uint32_t);
+
+/**
+ * \brief           Get the value file of the export of an interrupt handler
+ *                  and use it (See pinAcquire, release it with pinRelease)
+ *
+ * \param           slot of the pin
+ * \param           generation of the handler
+ * \return          Value file, -1 if the pin was unexported (Nothing to
+ *                  release)
+ */
+static int handlerAcquire(pinSlot*, uint32_t);
+
+/**
+ * \brief           Publish a level in the mirror of a pin
+ * \details         Ignored if older than the mirrored one (The sampler may
+ *                  read before an edge and publish after it). A stamp of 0
+ *                  clears the mirror.
+ *
+ * \param           slot of the pin
+ * \param           level
+ * \param           time the level was read (Library clock)
+ * \return void
+ */
+static void mirrorPublish(pinSlot*, int, uint64_t);
+
+/**
+ * \brief           Read the mirror of a pin (Lock free, retried while written)
+ *
+ * \param           slot of the pin
+ * \param           filled with the mirrored level
+ * \return          Time the level was read, 0 if none
+ */
+static uint64_t mirrorLoad(pinSlot*, int*);
+
+/**
+ * \brief           Read all the mirrored pins of the current table once
+ *
+ * \param           filled with the sampling period (Half of the smallest
+ *                  max age), unchanged if no pin is mirrored
+ * \return          Number of mirrored pins
+ */
+static int mirrorSample(uint64_t*);
+
+/**
+ * \brief           Sampler thread of the input mirror. Stops once no pin is
+ *                  mirrored (Started again by GIPY_pinSetMirror)
+ */
+static void *mirrorSampler(void*);
 
 /**
  * \brief           create the pin interrupt process for a pin
@@ -35,139 +335,1514 @@ static int isValidPinNumber(const int);
  */
 static void *pinInterruptHandler(void*);
 
-/*
- * \brief   Match the /sys/class/gpio/gpioX/value opened file
- * \details If this file is -1, means that pin is unexported
- *          Note that many elt in array are useless, the goal here 
- *          is to get the value for pin x just by using [x]
- */
-static int valueFds[30] = {
-    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-};
+/**
+ * \brief           Handle one event: statistics, hook then ISR function
+ *
+ * \param           slot of the pin
+ * \param           pin number
+ * \param           value read after the edge
+ * \param           timestamp of the edge (Library clock)
+ * \param           number of edges of the event (More than 1 if coalesced)
+ * \return void
+ */
+static void dispatchEvent(pinSlot*, int, int, uint64_t, uint32_t);
+
+/**
+ * \brief           Switch the mode of a pin if its edge rate crossed a
+ *                  threshold (Called by the interrupt handler)
+ *
+ * \param           slot of the pin
+ * \param           pin number
+ * \param           generation of the handler
+ * \param           edge rate of the last window (Edges/s)
+ * \param           last value handled, updated when back in interrupt mode
+ * \return          TRUE if the mode changed
+ */
+static int adaptMode(pinSlot*, int, uint32_t, uint64_t, int*);
+
+/**
+ * \brief           Disable the edge of a pin for a back-off (Edge storm)
+ *                  then re-arm it (Called by the interrupt handler)
+ *
+ * \param           slot of the pin
+ * \param           pin number
+ * \param           generation of the handler
+ * \param           edge rate of the last window (Edges/s)
+ * \param           back-off (ns)
+ * \param           last value handled, updated after the re-arm
+ * \return void
+ */
+static void stormBackOff(pinSlot*, int, uint32_t, uint64_t, uint64_t, int*);
+
+/**
+ * \brief           Write back the user edge of a pin, clear the pending
+ *                  notification and handle the change since the last value
+ *                  (Nothing done if the pin was exported again meanwhile)
+ *
+ * \param           slot of the pin
+ * \param           pin number
+ * \param           generation of the handler
+ * \param           last value handled, updated
+ * \return          TRUE if an event was handled
+ */
+static int rearmEdge(pinSlot*, int, uint32_t, int*);
+
+/**
+ * \brief           Check whether a level change is notified by an edge
+ *
+ * \param           edge setting
+ * \param           new value
+ * \return          TRUE if the change matches the edge
+ */
+static int isEdgeMatch(pinEdge, int);
+
+/**
+ * \brief           Write the direction file of a pin
+ *
+ * \param           pin number
+ * \param           direction to write
+ * \return          GE_OK if no error, otherwise GE_NOENT, GE_PINDIR or GE_IO
+ */
+static pirror writeDirection(int, pinDirection);
+
+/**
+ * \brief           Write the edge file of a pin
+ *
+ * \param           pin number
+ * \param           edge to write
+ * \return          GE_OK if no error, otherwise GE_NOENT or GE_IO
+ */
+static pirror writeEdge(int, pinEdge);
+
+/**
+ * \brief           Set the level of a pin through a handle (Registers or
+ *                  value file). The level known by the handle is not changed
+ *
+ * \param           pin handle
+ * \param           level to write (LOGIC_ZERO or LOGIC_ONE)
+ * \return          GE_OK if no error, otherwise GE_IO
+ */
+static pirror writeLevel(GIPY_Pin*, pinValue);
+
+/**
+ * \brief           Record a handled event in the pin statistics
+ *
+ * \param           slot of the pin where the event was handled
+ * \param           timestamp of the edge (Library clock)
+ * \return void
+ */
+static void recordEvent(pinSlot*, uint64_t);
+
+/*
+ * \brief   Current pin table (NULL means not discovered yet)
+ * \details A table replaced after a sysfs root change is never freed: 
+ *          interrupt handlers may still use their slot.
+ */
+static pinTable         *pinsTable = NULL;
+static pthread_mutex_t  pinsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * \brief   Virtual pins ranges (Added and removed under pinsLock)
+ */
+static virtualRange     virtualRanges[VIRTUAL_MAX_RANGES];
+
+/*
+ * \brief   Input mirror sampler thread (State changed under mirrorLock)
+ */
+static pthread_mutex_t  mirrorLock = PTHREAD_MUTEX_INITIALIZER;
+static int              isMirrorRunning = FALSE;
+
+/*
+ * \brief   Current sysfs root (Empty means not resolved yet)
+ */
+static char sysfsRoot[PATH_MAX];
+
+
+
+//------------------------------------------------------------------------------
+// Sysfs root functions
+//------------------------------------------------------------------------------
+pirror GIPY_setSysfsRoot(const char *pRoot){
+    pinTable *table = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+    if(table != NULL && table->nbExported > 0){
+        dbgError("Sysfs root can not change while pins are exported");
+        return GE_PERM;
+    }
+    if(pRoot == NULL){
+        pRoot = getenv(GPIO_ROOT_ENV);
+        pRoot = (pRoot == NULL || pRoot[0] == '\0') ? GPIO_PATH : pRoot;
+    }
+    size_t len = strlen(pRoot);
+    if(len == 0 || len + 2 > sizeof(sysfsRoot)){
+        dbgError("Invalid sysfs root: %s", pRoot);
+        return GE_PARAM;
+    }
+    strcpy(sysfsRoot, pRoot);
+    if(sysfsRoot[len-1] != '/'){
+        strcat(sysfsRoot, "/");
+    }
+    __atomic_store_n(&pinsTable, NULL, __ATOMIC_RELEASE); //New discovery
+    dbgInfo("Sysfs root set to %s", sysfsRoot);
+    return GE_OK;
+}
+
+const char *GIPY_getSysfsRoot(void){
+    if(sysfsRoot[0] == '\0'){
+        GIPY_setSysfsRoot(NULL);
+    }
+    return sysfsRoot;
+}
+
+
+//------------------------------------------------------------------------------
+// Pin table functions
+//------------------------------------------------------------------------------
+pirror GIPY_init(void){
+    getPinSlot(-1); //Build the table
+    if(__atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE) == NULL){
+        dbgError("Unable to build the pin table");
+        return GE_IO;
+    }
+    GIPY_pinAdoptAll();
+    return GE_OK;
+}
+
+int GIPY_getChips(gpioChip *pChips, int pMax){
+    getPinSlot(-1); //Make sure the table is built
+    pinTable *table = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+    if(table == NULL){
+        return 0;
+    }
+    int k;
+    for(k=0; k<table->nbChips && k<pMax && pChips != NULL; k++){
+        pChips[k] = table->chips[k];
+    }
+    return table->nbChips;
+}
+
+int GIPY_isValidPin(int pPin){
+    return (getPinSlot(pPin) != NULL || getVirtualRange(pPin) != NULL) ? TRUE : FALSE;
+}
+
+int gipyPinSlot(int pPin){
+    pinSlot *slot = getPinSlot(pPin);
+    return (slot == NULL) ? -1 : (int)(slot - __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE)->slots);
+}
+
+int gipyPinSlotCount(void){
+    getPinSlot(-1);
+    pinTable *table = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+    return (table == NULL) ? 0 : table->nbSlots;
+}
+
+pirror gipyAddVirtualPins(int pBase, int pCount, const virtualPinOps *pOps, void *pContext){
+    int k;
+    if(pCount <= 0 || pOps == NULL){
+        return GE_PARAM;
+    }
+    for(k=0; k<pCount; k++){
+        if(getPinSlot(pBase + k) != NULL || getVirtualRange(pBase + k) != NULL){
+            dbgError("Virtual pin %d is already a pin", pBase + k);
+            return GE_PARAM;
+        }
+    }
+    pthread_mutex_lock(&pinsLock);
+    for(k=0; k<VIRTUAL_MAX_RANGES && virtualRanges[k].count != 0; k++){
+        //Find a free range
+    }
+    if(k == VIRTUAL_MAX_RANGES){
+        pthread_mutex_unlock(&pinsLock);
+        dbgError("No virtual pins range left");
+        return GE_PARAM;
+    }
+    virtualRanges[k].base       = pBase;
+    virtualRanges[k].ops        = pOps;
+    virtualRanges[k].context    = pContext;
+    __atomic_store_n(&virtualRanges[k].count, pCount, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&pinsLock);
+    dbgInfo("Virtual pins %d to %d added", pBase, pBase + pCount - 1);
+    return GE_OK;
+}
+
+void gipyRemoveVirtualPins(int pBase){
+    int k;
+    pthread_mutex_lock(&pinsLock);
+    for(k=0; k<VIRTUAL_MAX_RANGES; k++){
+        if(virtualRanges[k].count != 0 && virtualRanges[k].base == pBase){
+            __atomic_store_n(&virtualRanges[k].count, 0, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&pinsLock);
+}
+
+
+
+//------------------------------------------------------------------------------
+// GPIO Export / Unexport functions
+//------------------------------------------------------------------------------
+pirror GIPY_pinExport(int pPin){
+    dbgInfo("Try to enable pin %d", pPin);
+
+    //Check if pin is valid (Virtual pins are always enabled)
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        if(getVirtualRange(pPin) != NULL){
+            return GE_OK;
+        }
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Export of a pin is serialized with its other configuration changes
+    pthread_mutex_lock(&slot->lock);
+    pirror error = exportPin(slot, pPin);
+    pthread_mutex_unlock(&slot->lock);
+    return error;
+}
+
+int GIPY_pinAdoptAll(void){
+    const char  *root   = GIPY_getSysfsRoot();
+    int         nb      = 0;
+    int         pin;
+    char        tail;
+
+    //One pass on the gpioN folders (gpiochipN do not match)
+    DIR *dir = opendir(root);
+    if(dir == NULL){
+        dbgError("Unable to open sysfs root: %s", root);
+        return 0;
+    }
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL){
+        if(sscanf(entry->d_name, "gpio%d%c", &pin, &tail) != 1){
+            continue;
+        }
+        pinSlot *slot = getPinSlot(pin);
+        if(slot == NULL){
+            continue; //Not a line of a discovered chip
+        }
+        pthread_mutex_lock(&slot->lock);
+        if(slot->handle.fd == -1 && exportPin(slot, pin) == GE_OK){
+            nb++;
+        }
+        pthread_mutex_unlock(&slot->lock);
+    }
+    closedir(dir);
+    dbgInfo("%d exported pins adopted", nb);
+    return nb;
+}
+
+int GIPY_pinListExported(int *pPins, int pMax){
+    const char  *root   = GIPY_getSysfsRoot();
+    int         nb      = 0;
+    int         pin;
+    char        tail;
+
+    DIR *dir = opendir(root);
+    if(dir == NULL){
+        dbgError("Unable to open sysfs root: %s", root);
+        return 0;
+    }
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL){
+        if(sscanf(entry->d_name, "gpio%d%c", &pin, &tail) != 1){
+            continue;
+        }
+        if(pPins != NULL && nb < pMax){
+            pPins[nb] = pin;
+        }
+        nb++;
+    }
+    closedir(dir);
+    if(pPins != NULL){
+        qsort(pPins, (nb < pMax) ? nb : pMax, sizeof(int), &comparePins);
+    }
+    return nb;
+}
+
+pirror GIPY_pinGetState(int pPin, pinState *pState){
+    char stamp[BUFSIZ];
+    char text[16];
+    if(pState == NULL){
+        return GE_PARAM;
+    }
+    memset(pState, 0, sizeof(pinState));
+    pState->value = -1;
+
+    //Direction file exists only if exported
+    sprintf(stamp, GPIO_PATH_DIRECTION, GIPY_getSysfsRoot(), pPin);
+    if(readSysfsText(stamp, text, sizeof(text)) == FALSE){
+        pState->isExported = FALSE;
+        return GE_OK;
+    }
+    pState->isExported  = TRUE;
+    pState->direction   = (text[0] == 'i') ? IN : OUT;
+    sprintf(stamp, GPIO_PATH_EDGE, GIPY_getSysfsRoot(), pPin);
+    if(readSysfsText(stamp, text, sizeof(text)) == TRUE){
+        pState->edge = parseEdge(text);
+    }
+    sprintf(stamp, GPIO_PATH_VALUE, GIPY_getSysfsRoot(), pPin);
+    if(readSysfsText(stamp, text, sizeof(text)) == TRUE){
+        pState->value = (text[0] == '1') ? 1 : 0;
+    }
+    return GE_OK;
+}
+
+pirror GIPY_pinUnexport(int pPin){
+    dbgInfo("Try to disable pin %d", pPin);
+
+    //Check whether pin number is valid
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        if(getVirtualRange(pPin) != NULL){
+            return GE_OK;
+        }
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    pthread_mutex_lock(&slot->lock);
+    pirror error = unexportPin(slot, pPin);
+    pthread_mutex_unlock(&slot->lock);
+    return error;
+}
+
+
+//------------------------------------------------------------------------------
+// Pin set direction functions
+//------------------------------------------------------------------------------
+pirror GIPY_pinSetDirectionIn(int pPin){
+    return GIPY_pinSetDirection(pPin, IN);
+}
+
+pirror GIPY_pinSetDirectionOut(int pPin){
+    return GIPY_pinSetDirection(pPin, OUT);
+}
+
+pirror GIPY_pinSetDirectionLow(int pPin){
+    return GIPY_pinSetDirection(pPin, LOW);
+}
+
+pirror GIPY_pinSetDirectionHigh(int pPin){
+    return GIPY_pinSetDirection(pPin, HIGH);
+}
+
+pirror GIPY_pinSetDirection(int pPin, pinDirection pPinDir){
+    dbgInfo("Try to change direction pin %d to %d", pPin, pPinDir);
+
+    //Check whether pin number is valid
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        virtualRange *range = getVirtualRange(pPin);
+        if(range != NULL){
+            return range->ops->setDirection(range->context, pPin - range->base, pPinDir);
+        }
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Pin must be enabled (Not unexported meanwhile)
+    pthread_mutex_lock(&slot->lock);
+    pirror error = GE_PERM;
+    if(slot->handle.fd != -1){
+        error = writeDirection(pPin, pPinDir);
+    }
+    if(error == GE_OK){
+        __atomic_store_n(&slot->handle.value,
+                (pPinDir == LOW) ? 0 : (pPinDir == HIGH) ? 1 : -1, __ATOMIC_RELAXED);
+        slot->direction = (pPinDir == IN) ? IN : OUT;
+    }
+    pthread_mutex_unlock(&slot->lock);
+    if(error == GE_PERM){
+        dbgError("Try to set a direction to unexported pin %d", pPin);
+        return error;
+    }
+    if(error == GE_OK){
+        traceProbe2(pin_direction, pPin, pPinDir);
+        dbgInfo("Direction pin %d is now %d", pPin, pPinDir);
+    }
+    return error;
+}
+
+
+//------------------------------------------------------------------------------
+// GPIO set edge functions
+//------------------------------------------------------------------------------
+
+pirror GIPY_pinSetEdgeNone(int pPin){
+    return GIPY_pinSetEdge(pPin, NONE);
+}
+
+pirror GIPY_pinSetEdgeRising(int pPin){
+    return GIPY_pinSetEdge(pPin, RISING);
+}
+
+pirror GIPY_pinSetEdgeFalling(int pPin){
+    return GIPY_pinSetEdge(pPin, FALLING);
+}
+
+pirror GIPY_pinSetEdgeBoth(int pPin){
+    return GIPY_pinSetEdge(pPin, BOTH);
+}
+
+pirror GIPY_pinSetEdge(int pPin, pinEdge pEdge){
+    dbgInfo("Try to set the edge (Pin: %d, value: %d)", pPin, pEdge);
+
+    //Check whether the pin is valid
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Pin must be enabled (Not unexported meanwhile)
+    //In sampled or storm mode, the edge is written back by the handler
+    pthread_mutex_lock(&slot->lock);
+    pirror error = GE_PERM;
+    if(slot->handle.fd != -1){
+        error = (__atomic_load_n(&slot->stats.mode, __ATOMIC_RELAXED) == PIN_MODE_INTERRUPT)
+            ? writeEdge(pPin, pEdge) : GE_OK;
+    }
+    if(error == GE_OK){
+        __atomic_store_n(&slot->edge, pEdge, __ATOMIC_RELAXED); //Read by the handler
+    }
+    pthread_mutex_unlock(&slot->lock);
+    if(error == GE_PERM){
+        dbgError("Try to set edge %d to unexported pin %d", pEdge,  pPin);
+    }
+    if(error != GE_OK){
+        return error;
+    }
+    traceProbe2(pin_edge, pPin, pEdge);
+    dbgInfo("Pin %d edge set", pPin);
+    return GE_OK;
+}
+
+
+//------------------------------------------------------------------------------
+// GPIO Read / Write functions
+//------------------------------------------------------------------------------
+pirror GIPY_pinRead(int pPin, int *pRead){
+    dbgInfo("Try to read pin %d", pPin);
+
+    //Check if pin is valid
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        virtualRange *range = getVirtualRange(pPin);
+        if(range != NULL){
+            return range->ops->read(range->context, pPin - range->base, pRead);
+        }
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Mirrored level if fresh enough: no syscall
+    uint64_t maxAge = __atomic_load_n(&slot->mirror.maxAge, __ATOMIC_RELAXED);
+    uint64_t stamp  = 0;
+    if(maxAge != 0 && __atomic_load_n(&slot->handle.fd, __ATOMIC_RELAXED) != -1){
+        int value;
+        stamp = mirrorLoad(slot, &value);
+        if(stamp != 0 && GIPY_clockNow() <= stamp + maxAge){
+            *pRead = value;
+            return GE_OK;
+        }
+    }
+
+    //Pin must be enabled (Value file kept open till released)
+    if(pinAcquire(slot) == FALSE){
+        dbgError("Try to read from unexported pin %d",  pPin);
+        return GE_PERM;
+    }
+
+    //Read from the file (Published while acquired, see swapValueFile)
+    stamp = (maxAge != 0) ? GIPY_clockNow() : 0;
+    pirror error = GIPY_handleRead(&slot->handle, pRead);
+    if(error == GE_OK && stamp != 0){
+        mirrorPublish(slot, *pRead, stamp);
+    }
+    pinRelease(slot);
+    if(error != GE_OK){
+        dbgError("Unable to read from value file for pin: %d", pPin);
+        return GE_IO;
+    }
+    dbgInfo("Pin %d read, value: %d", pPin, *pRead);
+    return GE_OK;
+}
+
+pirror GIPY_pinWrite(int pPin, pinValue pValue){
+    dbgInfo("Try to write %d in pin %d", pValue, pPin);
+
+    //check whether the pValue is valid
+    if(pValue != LOGIC_ZERO && pValue != LOGIC_ONE){
+        dbgError("Invalid value (%d) for pin: %d", pValue, pPin);
+        return GE_PINVAL;
+    }
+
+    //Check if pin is valid
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        virtualRange *range = getVirtualRange(pPin);
+        if(range != NULL){
+            return range->ops->write(range->context, pPin - range->base, pValue);
+        }
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Pin must be enabled (Value file kept open till released)
+    if(pinAcquire(slot) == FALSE){
+        dbgError("Try to write in unexported pin %d",  pPin);
+        return GE_PERM;
+    }
+
+    //try to write the value in the gpio value file
+    pirror error = GIPY_handleWrite(&slot->handle, pValue);
+    if(error == GE_OK && __atomic_load_n(&slot->mirror.maxAge, __ATOMIC_RELAXED) != 0){
+        mirrorPublish(slot, pValue, GIPY_clockNow());
+    }
+    pinRelease(slot);
+    if(error != GE_OK){
+        dbgError("Unable to write in value file for pin: %d", pPin);
+        return GE_IO;
+    }
+    dbgInfo("Successfully written %d in pin %d", pValue, pPin);
+    return GE_OK;
+}
+
+
+//------------------------------------------------------------------------------
+// Pin handle functions
+//------------------------------------------------------------------------------
+GIPY_Pin *GIPY_pinOpen(int pPin){
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL || __atomic_load_n(&slot->handle.fd, __ATOMIC_ACQUIRE) == -1){
+        dbgError("Unable to open handle of pin %d (Invalid or unexported)", pPin);
+        return NULL;
+    }
+    dbgInfo("Handle of pin %d opened (%s)", pPin,
+            (slot->handle.registers != NULL) ? "gpiomem" : "sysfs");
+    return &slot->handle;
+}
+
+int GIPY_handlePin(const GIPY_Pin *pHandle){
+    return pHandle->pin;
+}
+
+int GIPY_handleBackend(const GIPY_Pin *pHandle, volatile uint32_t **pRegisters){
+    *pRegisters = pHandle->registers;
+    return __atomic_load_n(&pHandle->fd, __ATOMIC_ACQUIRE);
+}
+
+uint32_t GIPY_handleRegisterBit(const GIPY_Pin *pHandle){
+    return pHandle->gpioBit;
+}
+
+pirror GIPY_handleRead(GIPY_Pin *pHandle, int *pRead){
+    if(pHandle->registers != NULL){
+        *pRead = (pHandle->registers[GPIOMEM_GPLEV0] & pHandle->gpioBit) ? 1 : 0;
+        traceProbe2(pin_read, pHandle->pin, *pRead);
+        return GE_OK;
+    }
+    char buff;
+    if(pread(__atomic_load_n(&pHandle->fd, __ATOMIC_RELAXED), &buff, 1, 0) != 1){
+        return GE_IO;
+    }
+    *pRead = buff-'0';
+    traceProbe2(pin_read, pHandle->pin, *pRead);
+    return GE_OK;
+}
+
+pirror GIPY_handleWrite(GIPY_Pin *pHandle, pinValue pValue){
+    if(pValue != LOGIC_ZERO && pValue != LOGIC_ONE){
+        return GE_PINVAL;
+    }
+    if(writeLevel(pHandle, pValue) != GE_OK){
+        __atomic_store_n(&pHandle->value, -1, __ATOMIC_RELAXED);
+        return GE_IO;
+    }
+    __atomic_store_n(&pHandle->value, pValue, __ATOMIC_RELAXED);
+    traceProbe2(pin_write, pHandle->pin, pValue);
+    return GE_OK;
+}
+
+pirror GIPY_handleToggle(GIPY_Pin *pHandle){
+    //The CAS gives each concurrent toggle its own level (None lost)
+    int value = __atomic_load_n(&pHandle->value, __ATOMIC_ACQUIRE);
+    int level;
+    do{
+        if(value == -1 && GIPY_handleRead(pHandle, &value) != GE_OK){
+            return GE_IO; //Unknown level, read once
+        }
+        level = (value == 1) ? LOGIC_ZERO : LOGIC_ONE;
+    } while(!__atomic_compare_exchange_n(&pHandle->value, &value, level, FALSE,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    //Writes may land out of order: written again till the pin has the last level
+    do{
+        if(writeLevel(pHandle, level) != GE_OK){
+            __atomic_store_n(&pHandle->value, -1, __ATOMIC_RELAXED);
+            return GE_IO;
+        }
+        traceProbe2(pin_write, pHandle->pin, level);
+        value = level;
+        level = __atomic_load_n(&pHandle->value, __ATOMIC_ACQUIRE);
+    } while(level != value && level != -1);
+    return GE_OK;
+}
+
+
+//------------------------------------------------------------------------------
+// Interrupt functions
+//------------------------------------------------------------------------------
+pirror GIPY_pinCreateInterrupt(int pPin, void (*function)(void)){
+    dbgInfo("Try to create interrupt for pin %d", pPin);
+
+    //Check wither pin is valid
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Pin must be enabled (Not unexported meanwhile)
+    pthread_mutex_lock(&slot->lock);
+    if(slot->handle.fd == -1){
+        pthread_mutex_unlock(&slot->lock);
+        dbgError("Try to set interrupt to unexported pin %d", pPin);
+        return GE_PERM;
+    }
+
+    //Create a thread which check for event (One per export). The function isr is saved
+    __atomic_store_n(&slot->isr, function, __ATOMIC_RELEASE); //Change handler function
+    pirror error = GE_OK;
+    if(slot->wakeFile == -1){
+        __atomic_store_n(&slot->wakeFile, eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), __ATOMIC_RELEASE);
+    }
+    if(slot->handlerGeneration != slot->generation){
+        handlerArg  *arg = malloc(sizeof(handlerArg));
+        pthread_t   threadId;
+        if(arg == NULL || slot->wakeFile == -1){
+            free(arg);
+            error = GE_IO;
+        }
+        else{
+            arg->pin        = pPin;
+            arg->generation = slot->generation;
+            pthread_create(&threadId, NULL, &pinInterruptHandler, arg);
+            pthread_detach(threadId);
+            slot->handlerGeneration = slot->generation;
+        }
+    }
+    pthread_mutex_unlock(&slot->lock);
+    return error;
+}
+
+pirror GIPY_pinSetEdgeHook(int pPin, pinEdgeHook pHook, void *pContext){
+    dbgInfo("Try to set edge hook for pin %d", pPin);
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Context is set first, the handler may already run
+    //A running call of the previous hook is waited (Its context may be freed)
+    __atomic_store_n(&slot->hook, NULL, __ATOMIC_SEQ_CST);
+    while(__atomic_load_n(&slot->isHookBusy, __ATOMIC_SEQ_CST) == TRUE){
+        sched_yield();
+    }
+    slot->hookContext = pContext;
+    __atomic_store_n(&slot->hook, pHook, __ATOMIC_RELEASE);
+    return GE_OK;
+}
+
+pirror GIPY_pinSetAdaptive(int pPin, uint32_t pHighRate, uint32_t pLowRate, uint64_t pPeriod){
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    if(pHighRate != 0 && (pLowRate >= pHighRate || pPeriod == 0)){
+        dbgError("Invalid adaptive setting for pin %d", pPin);
+        return GE_PARAM;
+    }
+
+    //Disabled while changed, the handler may already run
+    __atomic_store_n(&slot->adapt.highRate, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->adapt.lowRate, pLowRate, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->adapt.period, pPeriod, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->adapt.highRate, pHighRate, __ATOMIC_RELEASE);
+    traceProbe4(pin_adaptive, pPin, pHighRate, pLowRate, pPeriod);
+    return GE_OK;
+}
+
+pirror GIPY_pinSetRateLimit(int pPin, uint64_t pMinInterval, uint32_t pStormRate, uint64_t pBackOff){
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    if(pStormRate != 0 && pBackOff == 0){
+        dbgError("Invalid storm back-off for pin %d", pPin);
+        return GE_PARAM;
+    }
+
+    //Storm detection disabled while changed, the handler may already run
+    __atomic_store_n(&slot->limit.stormRate, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->limit.backOff, pBackOff, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->limit.minInterval, pMinInterval, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->limit.stormRate, pStormRate, __ATOMIC_RELEASE);
+    traceProbe4(pin_rate_limit, pPin, pMinInterval, pStormRate, pBackOff);
+    return GE_OK;
+}
+
+uint32_t GIPY_pinGetEventCount(int pPin){
+    pinSlot *slot = getPinSlot(pPin);
+    return (slot != NULL) ? slot->eventCount : 0;
+}
+
+pirror GIPY_pinGetStats(int pPin, pinStats *pStats){
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    if(pStats == NULL){
+        return GE_PARAM;
+    }
+    uint32_t seq;
+    do{
+        seq     = seqReadBegin(&slot->statsSeq);
+        *pStats = slot->stats;
+    } while(seqReadRetry(&slot->statsSeq, seq) == TRUE);
+    return GE_OK;
+}
+
+pirror GIPY_pinResetStats(int pPin){
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    seqWriteBegin(&slot->statsSeq);
+    pinMode mode = slot->stats.mode;
+    memset(&slot->stats, 0, sizeof(pinStats));
+    __atomic_store_n(&slot->stats.mode, mode, __ATOMIC_RELAXED);
+    seqWriteEnd(&slot->statsSeq);
+    return GE_OK;
+}
+
+static void *pinInterruptHandler(void *pArg){
+    int         intPin      = ((handlerArg *)pArg)->pin;
+    uint32_t    generation  = ((handlerArg *)pArg)->generation;
+    pinSlot     *slot       = getPinSlot(intPin);
+    char        buff[2];
+    int         file;
+    free(pArg);
+    dbgInfo("Start pinInterruptHandler for pin %d", intPin);
+
+    //Value file used only while acquired: unexport may close it in between
+    struct pollfd       pollstruct[2];
+    pollstruct[0].events    = POLLPRI;
+    pollstruct[1].fd        = __atomic_load_n(&slot->wakeFile, __ATOMIC_ACQUIRE);
+    pollstruct[1].events    = POLLIN;
+
+    //Edge rate measure (Adaptive mode and storm detection)
+    int         value           = -1; //Last handled value (-1 if unknown)
+    uint64_t    windowStart     = GIPY_clockNow();
+    uint64_t    windowEvents    = 0;
+    uint64_t    stormEnd        = 0; //Re-arm time of the last storm
+    int         stormShift      = 0; //Back-off is doubled for each shift
+
+    //Rate limit: edges coalesced since the last handled event
+    uint64_t    lastEvent       = 0;
+    uint64_t    lastStamp       = 0;
+    uint32_t    nbCoalesced     = 0;
+
+    GIPY_clockSleep(NSEC_PER_SEC);
+    //Loop blocked by poll. Wait for any event and call function if interrupt
+    for(;;){
+        dbgInfo("* Wait for event (pin: %d)", intPin);
+        //If the pin has been unexported since the interrupt creation
+        if(__atomic_load_n(&slot->generation, __ATOMIC_ACQUIRE) != generation){
+            dbgInfo("Attention: pin %d unexported will interrupt running", intPin);
+            break; //Stop interrupt handling
+        }
+
+        //Sampled mode: edge notification is disabled, value is read instead
+        if(__atomic_load_n(&slot->stats.mode, __ATOMIC_RELAXED) == PIN_MODE_SAMPLED){
+            GIPY_clockSleep(__atomic_load_n(&slot->adapt.period, __ATOMIC_RELAXED));
+            if((file = handlerAcquire(slot, generation)) == -1){
+                continue;
+            }
+            int len = pread(file, buff, 2, 0);
+            pinRelease(slot);
+            if(len > 0 && buff[0]-'0' != value){
+                value = buff[0]-'0';
+                if(isEdgeMatch(__atomic_load_n(&slot->edge, __ATOMIC_RELAXED), value)){
+                    seqWriteBegin(&slot->statsSeq);
+                    slot->stats.sampledEvents++;
+                    seqWriteEnd(&slot->statsSeq);
+                    windowEvents++;
+                    dispatchEvent(slot, intPin, value, GIPY_clockNow(), 1);
+                }
+            }
+        }
+        else{
+            //Wait for an edge (Simulated lines are notified by the simulator)
+            //Coalesced edges are handled at the end of the min interval
+            uint64_t    deadline    = UINT64_MAX;
+            uint64_t    minInterval = __atomic_load_n(&slot->limit.minInterval, __ATOMIC_RELAXED);
+            uint64_t    stamp;
+            int         isEvent;
+            if(nbCoalesced > 0){
+                deadline = lastEvent + minInterval;
+            }
+            if(GIPY_simIsEnabled() == TRUE){
+                isEvent = simWaitEdge(intPin, deadline, &stamp);
+            }
+            else{
+                int timeout = -1;
+                if(deadline != UINT64_MAX){
+                    uint64_t now    = GIPY_clockNow();
+                    timeout         = (deadline > now) ? (int)((deadline - now + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC) : 0;
+                }
+                //Woken up by unexport (wakeFile): the file is released
+                if((file = handlerAcquire(slot, generation)) == -1){
+                    continue;
+                }
+                pollstruct[0].fd = file;
+                isEvent = (poll(pollstruct, 2, timeout) > 0) && (pollstruct[0].revents & POLLPRI);
+                stamp   = GIPY_clockNow();
+                pinRelease(slot);
+                if(pollstruct[1].revents & POLLIN){
+                    eventfd_t count;
+                    eventfd_read(pollstruct[1].fd, &count);
+                }
+            }
+
+            //Interval elapsed without new edge: coalesced edges are handled
+            if(!isEvent && nbCoalesced > 0 && GIPY_clockNow() >= deadline){
+                dispatchEvent(slot, intPin, value, lastStamp, nbCoalesced);
+                lastEvent   = GIPY_clockNow();
+                nbCoalesced = 0;
+            }
+
+            //If an event is detected, call isr function
+            if(isEvent){
+                //Dummy read to clear the interrupt (Positional: the file
+                //offset is shared with the other threads)
+                if((file = handlerAcquire(slot, generation)) == -1){
+                    continue;
+                }
+                int len = pread(file, buff, 2, 0);
+                pinRelease(slot);
+                dbgInfo("Poll pin %d, df %d", intPin, file);
+                if(len <= 0){
+                    continue;
+                }
+                value = buff[0]-'0';
+                windowEvents++;
+                if(stamp < lastEvent + minInterval){
+                    nbCoalesced++; //Handled with the next event
+                    lastStamp = stamp;
+                }
+                else{
+                    dispatchEvent(slot, intPin, value, stamp, nbCoalesced + 1);
+                    lastEvent   = stamp;
+                    nbCoalesced = 0;
+                }
+
+                /*
+                 * WARNING: Because of electronic behavior, when the button 
+                 * is pushed down, the signal is 'disturbed' and several 
+                 * poll could be catch till the signal is stable. 
+                 * In order to avoid this, the delay prevent poll to be called 
+                 * again to early. 
+                 * Some milliseconds should be enough to avoid loosing another 
+                 * interrupt even and avoid this issue.
+                 */
+                if(__atomic_load_n(&slot->isr, __ATOMIC_RELAXED) != NULL && nbCoalesced == 0){
+                    GIPY_clockSleep(200*NSEC_PER_USEC); //Not after a coalesced edge
+                }
+            }
+        }
+
+        //Check the edge rate once per window
+        uint64_t elapsed = GIPY_clockNow() - windowStart;
+        if(elapsed >= ADAPT_WINDOW){
+            uint64_t rate       = windowEvents * NSEC_PER_SEC / elapsed;
+            uint32_t stormRate  = __atomic_load_n(&slot->limit.stormRate, __ATOMIC_ACQUIRE);
+            if(__atomic_load_n(&slot->stats.mode, __ATOMIC_RELAXED) == PIN_MODE_INTERRUPT
+                    && stormRate != 0 && rate >= stormRate){
+                if(nbCoalesced > 0){
+                    dispatchEvent(slot, intPin, value, lastStamp, nbCoalesced);
+                    nbCoalesced = 0;
+                }
+                //Storm right after the previous one: back-off is doubled
+                if(stormEnd != 0 && windowStart - stormEnd < 2 * ADAPT_WINDOW){
+                    stormShift += (stormShift < STORM_BACKOFF_MAX_SHIFT) ? 1 : 0;
+                }
+                else{
+                    stormShift = 0;
+                }
+                stormBackOff(slot, intPin, generation, rate,
+                        __atomic_load_n(&slot->limit.backOff, __ATOMIC_RELAXED) << stormShift, &value);
+                stormEnd    = GIPY_clockNow();
+                lastEvent   = stormEnd;
+            }
+            else{
+                adaptMode(slot, intPin, generation, rate, &value);
+            }
+            windowStart     = GIPY_clockNow();
+            windowEvents    = 0;
+        }
+    }
+    dbgInfo("Error pinInterrupHandler for pin %d: end of function reached", intPin);
+    return NULL;
+}
+
+
+//------------------------------------------------------------------------------
+// Input mirror functions
+//------------------------------------------------------------------------------
+pirror GIPY_pinSetMirror(int pPin, uint64_t pMaxAge){
+    dbgInfo("Try to set mirror of pin %d (Max age %llu ns)", pPin, (unsigned long long)pMaxAge);
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    if(pMaxAge != 0 && pMaxAge < 2 * MIRROR_MIN_PERIOD){
+        dbgError("Invalid mirror max age for pin %d", pPin);
+        return GE_PARAM;
+    }
+
+    //Set before the sampler check (See mirrorSampler). Under the slot lock:
+    //an unexport meanwhile disables it after
+    pthread_mutex_lock(&slot->lock);
+    if(pMaxAge != 0 && slot->handle.fd == -1){
+        pthread_mutex_unlock(&slot->lock);
+        dbgError("Pin %d not exported: can not be mirrored", pPin);
+        return GE_PERM;
+    }
+    __atomic_store_n(&slot->mirror.maxAge, pMaxAge, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&slot->lock);
+    if(pMaxAge == 0){
+        mirrorPublish(slot, 0, 0);
+        return GE_OK;
+    }
+    pirror error = GE_OK;
+    pthread_mutex_lock(&mirrorLock);
+    if(isMirrorRunning == FALSE){
+        pthread_t threadId;
+        if(pthread_create(&threadId, NULL, &mirrorSampler, NULL) != 0){
+            __atomic_store_n(&slot->mirror.maxAge, 0, __ATOMIC_SEQ_CST);
+            dbgError("Unable to start the input mirror sampler");
+            error = GE_IO;
+        }
+        else{
+            pthread_detach(threadId);
+            isMirrorRunning = TRUE;
+        }
+    }
+    pthread_mutex_unlock(&mirrorLock);
+    return error;
+}
+
+pirror GIPY_pinReadMirror(int pPin, int *pRead, uint64_t *pStamp){
+    pinSlot *slot = getPinSlot(pPin);
+    if(slot == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    if(pRead == NULL){
+        return GE_PARAM;
+    }
+    if(__atomic_load_n(&slot->mirror.maxAge, __ATOMIC_RELAXED) == 0){
+        return GE_PERM;
+    }
+    int         value;
+    uint64_t    stamp = mirrorLoad(slot, &value);
+    if(stamp == 0){
+        return GE_PERM;
+    }
+    *pRead = value;
+    if(pStamp != NULL){
+        *pStamp = stamp;
+    }
+    return GE_OK;
+}
+
+
+//------------------------------------------------------------------------------
+// Snapshot functions
+//------------------------------------------------------------------------------
+size_t GIPY_snapshotCapture(void *pBuffer, size_t pSize){
+    getPinSlot(-1); //Make sure the table is built
+    pinTable    *table  = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+    int         nb      = 0;
+    int         k;
+
+    //First pass: size of the blob
+    for(k=0; table != NULL && k<table->pinSpan; k++){
+        int32_t index = table->slotIndex[k];
+        if(index != -1 && __atomic_load_n(&table->slots[index].handle.fd, __ATOMIC_ACQUIRE) != -1){
+            nb++;
+        }
+    }
+    nb = (nb > UINT16_MAX) ? UINT16_MAX : nb;
+    size_t size = sizeof(snapshotHeader) + nb * sizeof(pinSnapshot);
+    if(pBuffer == NULL || size > pSize){
+        return size;
+    }
+
+    //Second pass: pins in increasing order (Exported meanwhile are ignored)
+    snapshotHeader  *header = (snapshotHeader *)pBuffer;
+    pinSnapshot     *pins   = (pinSnapshot *)(header + 1);
+    int             count   = 0;
+    for(k=0; count<nb && k<table->pinSpan; k++){
+        int32_t index = table->slotIndex[k];
+        if(index == -1){
+            continue;
+        }
+        pinSlot *slot   = &table->slots[index];
+        int     pin     = table->pinBase + k;
+        pthread_mutex_lock(&slot->lock);
+        if(slot->handle.fd != -1){
+            int direction   = pinDirectionOf(slot, pin);
+            int value       = __atomic_load_n(&slot->handle.value, __ATOMIC_RELAXED);
+            char text;
+            if(direction == OUT && value == -1 && pread(slot->handle.fd, &text, 1, 0) == 1){
+                value = (text == '1') ? 1 : 0;
+                __atomic_store_n(&slot->handle.value, value, __ATOMIC_RELAXED);
+            }
+            pins[count].pin         = pin;
+            pins[count].direction   = (direction == OUT) ? OUT : IN;
+            pins[count].edge        = (uint8_t)slot->edge;
+            pins[count].value       = (direction == OUT && value == 1) ? 1 : 0;
+            pins[count].flags       = (slot->handlerGeneration == slot->generation) ? SNAPSHOT_ARMED : 0;
+            count++;
+        }
+        pthread_mutex_unlock(&slot->lock);
+    }
+    header->magic   = SNAPSHOT_MAGIC;
+    header->version = SNAPSHOT_VERSION;
+    header->count   = (uint16_t)count;
+    dbgInfo("Snapshot of %d pins captured", count);
+    return sizeof(snapshotHeader) + count * sizeof(pinSnapshot);
+}
+
+pirror GIPY_snapshotRestore(const void *pBlob, size_t pSize, int *pChanges){
+    const snapshotHeader    *header = (const snapshotHeader *)pBlob;
+    int                     changes = 0;
+    pirror                  first   = GE_OK;
+    int                     k;
+
+    //Check the whole blob before any change
+    if(pBlob == NULL || pSize < sizeof(snapshotHeader) || header->magic != SNAPSHOT_MAGIC
+            || header->version != SNAPSHOT_VERSION
+            || pSize < sizeof(snapshotHeader) + header->count * sizeof(pinSnapshot)){
+        dbgError("Invalid snapshot");
+        return GE_PARAM;
+    }
+    const pinSnapshot *pins = (const pinSnapshot *)(header + 1);
+    for(k=0; k<header->count; k++){
+        if((k > 0 && pins[k].pin <= pins[k - 1].pin) || pins[k].direction > OUT
+                || pins[k].edge > BOTH || pins[k].value > 1){
+            dbgError("Invalid snapshot entry %d", k);
+            return GE_PARAM;
+        }
+    }
+
+    //Pins not in the snapshot are unexported
+    getPinSlot(-1);
+    pinTable *table = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+    for(k=0; table != NULL && k<table->pinSpan; k++){
+        int32_t index   = table->slotIndex[k];
+        int     pin     = table->pinBase + k;
+        if(index == -1 || __atomic_load_n(&table->slots[index].handle.fd, __ATOMIC_ACQUIRE) == -1
+                || bsearch(&pin, pins, header->count, sizeof(pinSnapshot), &comparePins) != NULL){
+            continue;
+        }
+        pirror err = GIPY_pinUnexport(pin);
+        first = (first == GE_OK) ? err : first;
+        changes++;
+    }
+    for(k=0; k<header->count; k++){
+        pirror err = restorePin(&pins[k], &changes);
+        first = (first == GE_OK) ? err : first;
+    }
+    if(pChanges != NULL){
+        *pChanges = changes;
+    }
+    dbgInfo("Snapshot of %d pins restored (%d changes)", header->count, changes);
+    return first;
+}
+
+static pirror restorePin(const pinSnapshot *pEntry, int *pChanges){
+    int     pin     = pEntry->pin;
+    pirror  err     = GE_OK;
+    pinSlot *slot   = getPinSlot(pin);
+    if(slot == NULL){
+        dbgError("Invalid pin number in snapshot: %d", pin);
+        return GE_PIN;
+    }
+    if(__atomic_load_n(&slot->handle.fd, __ATOMIC_ACQUIRE) == -1){
+        err = GIPY_pinExport(pin);
+        (*pChanges)++;
+    }
 
-/*
- * \brief   ISR function for each pin
- * \details The function for pin x is at [x]
- */
-static void (*isrFunctions[30])(void);
+    //Current state, known by the library
+    pthread_mutex_lock(&slot->lock);
+    int direction   = (slot->handle.fd != -1) ? pinDirectionOf(slot, pin) : -1;
+    int value       = __atomic_load_n(&slot->handle.value, __ATOMIC_RELAXED);
+    int isArmed     = (slot->handlerGeneration == slot->generation);
+    pinEdge edge    = slot->edge;
+    pthread_mutex_unlock(&slot->lock);
+
+    //Output level with the direction write (No glitch), or a value write
+    if(err == GE_OK && pEntry->direction == OUT && direction != OUT){
+        err = GIPY_pinSetDirection(pin, (pEntry->value == 1) ? HIGH : LOW);
+        (*pChanges)++;
+    }
+    else if(err == GE_OK && pEntry->direction == OUT && value != pEntry->value){
+        err = GIPY_pinWrite(pin, (pEntry->value == 1) ? LOGIC_ONE : LOGIC_ZERO);
+        (*pChanges)++;
+    }
+    else if(err == GE_OK && pEntry->direction == IN && direction != IN){
+        err = GIPY_pinSetDirection(pin, IN);
+        (*pChanges)++;
+    }
+    if(err == GE_OK && pEntry->edge != edge){
+        err = GIPY_pinSetEdge(pin, (pinEdge)pEntry->edge);
+        (*pChanges)++;
+    }
+    if(err == GE_OK && (pEntry->flags & SNAPSHOT_ARMED) && isArmed == FALSE){
+        err = GIPY_pinCreateInterrupt(pin, __atomic_load_n(&slot->isr, __ATOMIC_ACQUIRE));
+        (*pChanges)++;
+    }
+    return err;
+}
 
+static int pinDirectionOf(pinSlot *pSlot, int pPin){
+    if(pSlot->direction == -1){
+        char stamp[BUFSIZ];
+        char text[16];
+        sprintf(stamp, GPIO_PATH_DIRECTION, GIPY_getSysfsRoot(), pPin);
+        if(readSysfsText(stamp, text, sizeof(text)) == TRUE){
+            pSlot->direction = (text[0] == 'i') ? IN : OUT;
+        }
+    }
+    return pSlot->direction;
+}
 
 
 //------------------------------------------------------------------------------
-// GPIO Export / Unexport functions
+// Export functions
 //------------------------------------------------------------------------------
-pirror GIPY_pinExport(int pPin){
-    dbgInfo("Try to enable pin %d", pPin);
-
-    //Check if pin is valid
-    if(isValidPinNumber(pPin)==FALSE){
-        dbgError("Invalid pin number: %d", pPin);
-        return GE_PIN;
+static pirror exportPin(pinSlot *pSlot, int pPin){
+    //Already exported by this process: value file and interrupt kept
+    if(pSlot->handle.fd != -1){
+        dbgInfo("Pin %d already enabled (fd: %d)", pPin, pSlot->handle.fd);
+        return GE_OK;
     }
 
-    //Open the export sys file, check if successfully opened
-    int file = open(GPIO_PATH_EXPORT, O_WRONLY);
-    if(file == -1){
-        dbgError("Unable to open (WRONLY) export file: "GPIO_PATH_EXPORT);
-        return GE_PERM;
-    }
+    //Already exported (Previous run, other process): adopted as it is
+    char stamp[BUFSIZ];
+    sprintf(stamp, GPIO_PATH_VALUE, GIPY_getSysfsRoot(), pPin);
+    int isAdopted = (access(stamp, F_OK) == 0) ? TRUE : FALSE;
+
+    if(isAdopted == FALSE){
+        //Open the export sys file, check if successfully opened
+        sprintf(stamp, GPIO_PATH_EXPORT, GIPY_getSysfsRoot());
+        int file = open(stamp, O_WRONLY);
+        if(file == -1){
+            dbgError("Unable to open (WRONLY) export file: %s", stamp);
+            return GE_PERM;
+        }
 
-    //Write into file that this pin is set
-    char tamp[3];
-    sprintf(tamp, "%d", pPin);
-    if(write(file, tamp, sizeof(pPin)) != sizeof(pPin)){
-        dbgError("Unable to write %d in file: "GPIO_PATH_EXPORT, pPin);
-        close(file);
-        return GE_IO;
+        //Write into file that this pin is set (EBUSY: exported meanwhile)
+        char tamp[16];
+        int len = sprintf(tamp, "%d", pPin);
+        int res = write(file, tamp, len);
+        int err = errno;
+        close(file); //This close the export file
+        if(res != len && err != EBUSY){
+            dbgError("Unable to write %d in file: %s", pPin, stamp);
+            return GE_IO;
+        }
+        isAdopted = (res != len) ? TRUE : FALSE;
+    }
+    if(GIPY_simIsEnabled() == TRUE && simExport(pPin) != GE_OK){
+        return GE_IO; //Simulated gpioX folder is created on export (Or kept)
     }
-    close(file); //This close the export file
 
-    //Open the value file (And keep it open in valueFds array)
-    char stamp[BUFSIZ];
-    sprintf(stamp, GPIO_PATH_VALUE, pPin);
-    file = open(stamp, O_RDWR);
+    //Open the value file (And keep it open in the pin slot)
+    sprintf(stamp, GPIO_PATH_VALUE, GIPY_getSysfsRoot(), pPin);
+    int file = open(stamp, O_RDWR);
     if(file == -1){
         dbgError("Unable to open (RDWR) value file: %s", stamp);
         return GE_PERM;
     }
-    valueFds[pPin] = file; //Keep in memory the value file for this pin
-    dbgInfo("Pin %d enabled (fd: %d)", pPin, file);
+
+    //Resolve the handle once (Registers only match the real sysfs root)
+    uint32_t bit;
+    pSlot->handle.pin       = pPin;
+    pSlot->handle.registers = (bankRegisterBit(pPin, &bit) == TRUE) ? bankMapRegisters() : NULL;
+    pSlot->handle.gpioBit   = (pSlot->handle.registers != NULL) ? bit : 0;
+    __atomic_store_n(&pSlot->handle.value, -1, __ATOMIC_RELAXED);
+    swapValueFile(pSlot, file);
+    __atomic_add_fetch(&pinsTable->nbExported, 1, __ATOMIC_RELAXED);
+    pSlot->edge = NONE; //Kernel default of a new export
+    pSlot->direction = -1; //Kernel keeps the line direction
+    if(isAdopted == TRUE){
+        adoptState(pSlot, pPin);
+    }
+    traceProbe2(pin_export, pPin, file);
+    dbgInfo("Pin %d enabled (fd: %d, adopted: %d)", pPin, file, isAdopted);
     return GE_OK;
 }
 
-pirror GIPY_pinUnexport(int pPin){
-    dbgInfo("Try to disable pin %d", pPin);
+static void adoptState(pinSlot *pSlot, int pPin){
+    char stamp[BUFSIZ];
+    char text[16];
 
-    //Check whether pin number is valid
-    if(isValidPinNumber(pPin)==FALSE){
-        dbgError("Invalid pin number: %d", pPin);
-        return GE_PIN;
+    //Kernel reads "none", "rising", "falling" or "both"
+    sprintf(stamp, GPIO_PATH_EDGE, GIPY_getSysfsRoot(), pPin);
+    if(readSysfsText(stamp, text, sizeof(text)) == TRUE){
+        pSlot->edge = parseEdge(text);
+    }
+    if(GIPY_simIsEnabled() == TRUE){
+        simSetEdge(pPin, pSlot->edge);
+    }
+
+    //Kernel reads "in" or "out": the level of an output is its last write
+    sprintf(stamp, GPIO_PATH_DIRECTION, GIPY_getSysfsRoot(), pPin);
+    if(readSysfsText(stamp, text, sizeof(text)) == TRUE){
+        pSlot->direction = (text[0] == 'i') ? IN : OUT;
+    }
+    if(pSlot->direction == OUT && pread(pSlot->handle.fd, text, 1, 0) == 1){
+        __atomic_store_n(&pSlot->handle.value, (text[0] == '1') ? 1 : 0, __ATOMIC_RELAXED);
     }
+    dbgInfo("Pin %d adopted (Edge: %d, value: %d)", pPin, pSlot->edge,
+            __atomic_load_n(&pSlot->handle.value, __ATOMIC_RELAXED));
+}
 
+static pirror unexportPin(pinSlot *pSlot, int pPin){
     //Try to open unexport file
-    int file = open(GPIO_PATH_UNEXPORT, O_WRONLY);
+    char stamp[BUFSIZ];
+    sprintf(stamp, GPIO_PATH_UNEXPORT, GIPY_getSysfsRoot());
+    int file = open(stamp, O_WRONLY);
     if(file == -1){
-        dbgError("Unable to read (Write) export file: "GPIO_PATH_UNEXPORT);
+        dbgError("Unable to read (Write) export file: %s", stamp);
         return GE_NOENT;
     }
 
     //Write this pin in unexport file
-    char tamp[3];
-    sprintf(tamp, "%d", pPin);
-    if(write(file, tamp, sizeof(tamp)) != sizeof(tamp)){
-        dbgError("Unable to write %d in export file: "GPIO_PATH_UNEXPORT, pPin);
+    char tamp[16];
+    int len = sprintf(tamp, "%d", pPin);
+    if(write(file, tamp, len) != len){
+        dbgError("Unable to write %d in export file: %s", pPin, stamp);
         close(file);
         return GE_IO;
     }
     close(file);
 
-    //Close the value file descriptor for this pin
-    close(valueFds[pPin]);
-    dbgInfo("Pin %d disabled (fd: %d)", pPin, valueFds[pPin]);
-    valueFds[pPin] = -1;
+    //Mirror disabled (The sampler stops with the last one), then cleared by
+    //the swap. Close the value file descriptor for this pin
+    __atomic_store_n(&pSlot->mirror.maxAge, 0, __ATOMIC_SEQ_CST);
+    int previous = swapValueFile(pSlot, -1);
+    if(previous != -1){
+        __atomic_sub_fetch(&pinsTable->nbExported, 1, __ATOMIC_RELAXED);
+    }
+    traceProbe1(pin_unexport, pPin);
+    dbgInfo("Pin %d disabled (fd: %d)", pPin, previous);
+    if(GIPY_simIsEnabled() == TRUE){
+        simUnexport(pPin);
+    }
     return GE_OK;
 }
 
+static int pinAcquire(pinSlot *pSlot){
+    //Count first, then check: unexport clears the file first, then waits
+    __atomic_add_fetch(&pSlot->users, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&pSlot->handle.fd, __ATOMIC_SEQ_CST) == -1){
+        __atomic_sub_fetch(&pSlot->users, 1, __ATOMIC_RELEASE);
+        return FALSE;
+    }
+    return TRUE;
+}
 
-//------------------------------------------------------------------------------
-// Pin set direction functions
-//------------------------------------------------------------------------------
-pirror GIPY_pinSetDirectionIn(int pPin){
-    return GIPY_pinSetDirection(pPin, IN);
+static void pinRelease(pinSlot *pSlot){
+    __atomic_sub_fetch(&pSlot->users, 1, __ATOMIC_RELEASE);
 }
 
-pirror GIPY_pinSetDirectionOut(int pPin){
-    return GIPY_pinSetDirection(pPin, OUT);
+static virtualRange *getVirtualRange(const int pPin){
+    int k;
+    for(k=0; k<VIRTUAL_MAX_RANGES; k++){
+        int count = __atomic_load_n(&virtualRanges[k].count, __ATOMIC_ACQUIRE);
+        if(count != 0 && pPin >= virtualRanges[k].base && pPin - virtualRanges[k].base < count){
+            return &virtualRanges[k];
+        }
+    }
+    return NULL;
 }
 
-pirror GIPY_pinSetDirectionLow(int pPin){
-    return GIPY_pinSetDirection(pPin, LOW);
+static int swapValueFile(pinSlot *pSlot, int pFile){
+    int previous = __atomic_exchange_n(&pSlot->handle.fd, pFile, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&pSlot->generation, 1, __ATOMIC_RELEASE);
+    if(previous != -1){
+        //Interrupt handler waiting on the previous file: woken up to release it
+        int wake = __atomic_load_n(&pSlot->wakeFile, __ATOMIC_ACQUIRE);
+        if(wake != -1 && eventfd_write(wake, 1) != 0){
+            dbgError("Unable to wake the interrupt handler of pin %d", pSlot->handle.pin);
+        }
+        while(__atomic_load_n(&pSlot->users, __ATOMIC_SEQ_CST) > 0){
+            sched_yield(); //One read or write at most
+        }
+        close(previous);
+    }
+    mirrorPublish(pSlot, 0, 0); //Level of the previous file
+    return previous;
 }
 
-pirror GIPY_pinSetDirectionHigh(int pPin){
-    return GIPY_pinSetDirection(pPin, HIGH);
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static void dispatchEvent(pinSlot *pSlot, int pPin, int pValue, uint64_t pStamp, uint32_t pCount){
+    if(__atomic_load_n(&pSlot->mirror.maxAge, __ATOMIC_RELAXED) != 0){
+        mirrorPublish(pSlot, pValue, pStamp); //Before the hook, which may read it
+    }
+    seqWriteBegin(&pSlot->statsSeq);
+    recordEvent(pSlot, pStamp);
+    pSlot->stats.coalesced  += pCount - 1;
+    seqWriteEnd(&pSlot->statsSeq);
+    pSlot->eventCount       = pCount;
+    traceProbe4(edge, pPin, pValue, pStamp, pCount);
+
+    //Hook runs in the event path, for every edge
+    traceProbe3(callback_start, pPin, pValue, pStamp);
+    __atomic_store_n(&pSlot->isHookBusy, TRUE, __ATOMIC_SEQ_CST);
+    pinEdgeHook hook = __atomic_load_n(&pSlot->hook, __ATOMIC_SEQ_CST);
+    if(hook != NULL){
+        hook(pPin, pValue, pStamp, pSlot->hookContext);
+    }
+    __atomic_store_n(&pSlot->isHookBusy, FALSE, __ATOMIC_RELEASE);
+    void (*isr)(void) = __atomic_load_n(&pSlot->isr, __ATOMIC_ACQUIRE);
+    if(isr != NULL){
+        isr();
+    }
+    traceProbe3(callback_end, pPin, pValue, pStamp);
 }
 
-pirror GIPY_pinSetDirection(int pPin, pinDirection pPinDir){
-    dbgInfo("Try to change direction pin %d to %d", pPin, pPinDir);
+static int adaptMode(pinSlot *pSlot, int pPin, uint32_t pGeneration, uint64_t pRate, int *pValue){
+    uint32_t highRate = __atomic_load_n(&pSlot->adapt.highRate, __ATOMIC_ACQUIRE);
 
-    //Check whether pin number is valid
-    if(isValidPinNumber(pPin)==FALSE){
-        dbgError("Invalid pin number: %d", pPin);
-        return GE_PIN;
+    if(__atomic_load_n(&pSlot->stats.mode, __ATOMIC_RELAXED) == PIN_MODE_INTERRUPT){
+        if(highRate == 0 || pRate < highRate){
+            return FALSE;
+        }
+        //Notification disabled: the sampling starts from the last handled value
+        pthread_mutex_lock(&pSlot->lock);
+        if(pSlot->generation != pGeneration || writeEdge(pPin, NONE) != GE_OK){
+            pthread_mutex_unlock(&pSlot->lock);
+            return FALSE;
+        }
+        seqWriteBegin(&pSlot->statsSeq);
+        __atomic_store_n(&pSlot->stats.mode, PIN_MODE_SAMPLED, __ATOMIC_RELAXED);
+        pSlot->stats.modeSwitches++;
+        seqWriteEnd(&pSlot->statsSeq);
+        pthread_mutex_unlock(&pSlot->lock);
+        traceProbe3(pin_mode, pPin, PIN_MODE_SAMPLED, pRate);
+        dbgInfo("Pin %d in sampled mode (%llu edges/s)", pPin, (unsigned long long)pRate);
+        return TRUE;
     }
 
-    //Pin must be enabled
-    if(valueFds[pPin] == -1){
-        dbgError("Try to set a direction to unexported pin %d", pPin);
-        return GE_PERM;
+    //Back to interrupt mode when rate is low enough (Or adaptive disabled)
+    if(highRate != 0 && pRate > __atomic_load_n(&pSlot->adapt.lowRate, __ATOMIC_RELAXED)){
+        return FALSE;
+    }
+    seqWriteBegin(&pSlot->statsSeq);
+    __atomic_store_n(&pSlot->stats.mode, PIN_MODE_INTERRUPT, __ATOMIC_RELAXED);
+    pSlot->stats.modeSwitches++;
+    seqWriteEnd(&pSlot->statsSeq);
+    traceProbe3(pin_mode, pPin, PIN_MODE_INTERRUPT, pRate);
+    dbgInfo("Pin %d in interrupt mode (%llu edges/s)", pPin, (unsigned long long)pRate);
+    if(rearmEdge(pSlot, pPin, pGeneration, pValue) == TRUE){
+        seqWriteBegin(&pSlot->statsSeq);
+        pSlot->stats.sampledEvents++;
+        seqWriteEnd(&pSlot->statsSeq);
+    }
+    return TRUE;
+}
+
+static void stormBackOff(pinSlot *pSlot, int pPin, uint32_t pGeneration, uint64_t pRate,
+        uint64_t pBackOff, int *pValue){
+    pthread_mutex_lock(&pSlot->lock);
+    if(pSlot->generation != pGeneration || writeEdge(pPin, NONE) != GE_OK){
+        pthread_mutex_unlock(&pSlot->lock);
+        return;
+    }
+    seqWriteBegin(&pSlot->statsSeq);
+    __atomic_store_n(&pSlot->stats.mode, PIN_MODE_STORM, __ATOMIC_RELAXED);
+    pSlot->stats.storms++;
+    seqWriteEnd(&pSlot->statsSeq);
+    pthread_mutex_unlock(&pSlot->lock);
+    traceProbe3(pin_mode, pPin, PIN_MODE_STORM, pRate);
+    dbgError("Edge storm on pin %d (%llu edges/s): edge disabled for %llu us",
+            pPin, (unsigned long long)pRate, (unsigned long long)(pBackOff / NSEC_PER_USEC));
+    GIPY_clockSleep(pBackOff);
+
+    //Unexported (And maybe exported again) meanwhile: the handler stops.
+    //Generation changes under the slot lock, unlike the file number
+    pthread_mutex_lock(&pSlot->lock);
+    if(pSlot->generation != pGeneration){
+        pthread_mutex_unlock(&pSlot->lock);
+        return;
+    }
+    seqWriteBegin(&pSlot->statsSeq);
+    __atomic_store_n(&pSlot->stats.mode, PIN_MODE_INTERRUPT, __ATOMIC_RELAXED);
+    seqWriteEnd(&pSlot->statsSeq);
+    pthread_mutex_unlock(&pSlot->lock);
+    traceProbe3(pin_mode, pPin, PIN_MODE_INTERRUPT, 0);
+    rearmEdge(pSlot, pPin, pGeneration, pValue);
+}
+
+static int rearmEdge(pinSlot *pSlot, int pPin, uint32_t pGeneration, int *pValue){
+    char    buff[2];
+    int     isEvent = FALSE;
+    pthread_mutex_lock(&pSlot->lock);
+    if(pSlot->generation != pGeneration){
+        pthread_mutex_unlock(&pSlot->lock);
+        return FALSE; //New export: its own handler owns the notification
+    }
+    pinEdge edge    = pSlot->edge; //User edge may change meanwhile
+    writeEdge(pPin, edge);
+
+    //Read clears the notification. A change since the last value is an event
+    int     len     = pread(pSlot->handle.fd, buff, 2, 0);
+    pthread_mutex_unlock(&pSlot->lock);
+    if(len > 0 && buff[0]-'0' != *pValue){
+        *pValue = buff[0]-'0';
+        if(isEdgeMatch(edge, *pValue)){
+            dispatchEvent(pSlot, pPin, *pValue, GIPY_clockNow(), 1);
+            isEvent = TRUE;
+        }
     }
+    return isEvent;
+}
+
+static int isEdgeMatch(pinEdge pEdge, int pValue){
+    return (pEdge == BOTH)
+        || (pEdge == RISING && pValue == 1)
+        || (pEdge == FALLING && pValue == 0);
+}
 
+static pirror writeDirection(int pPin, pinDirection pPinDir){
     //Open direction folder
     char stamp[BUFSIZ];
-    sprintf(stamp, GPIO_PATH_DIRECTION, pPin);
+    sprintf(stamp, GPIO_PATH_DIRECTION, GIPY_getSysfsRoot(), pPin);
     int file = open(stamp, O_WRONLY);
     if(file == -1){
         dbgError("Unable to open (Write) file %s for pin %d", stamp, pPin);
@@ -193,60 +1868,32 @@ pirror GIPY_pinSetDirection(int pPin, pinDirection pPinDir){
             //Default mean the pin dir is not valid
             close(file);
             dbgError("Invalid pin dir");
-            writeError = GE_PINDIR;
-            break;
+            return GE_PINDIR;
     }
 
     //Check the write process was successfully done
+    close(file);
     if(writeError != 1){
-        close(file);
         dbgError("Unable to write in %s with value %d", stamp, pPinDir);
         return GE_IO;
     }
-    close(file);
-    dbgInfo("Direction pin %d is now %d", pPin, pPinDir);
     return GE_OK;
 }
 
-
-//------------------------------------------------------------------------------
-// GPIO set edge functions
-//------------------------------------------------------------------------------
-
-pirror GIPY_pinSetEdgeNone(int pPin){
-    return GIPY_pinSetEdge(pPin, NONE);
-}
-
-pirror GIPY_pinSetEdgeRising(int pPin){
-    return GIPY_pinSetEdge(pPin, RISING);
-}
-
-pirror GIPY_pinSetEdgeFalling(int pPin){
-    return GIPY_pinSetEdge(pPin, FALLING);
-}
-
-pirror GIPY_pinSetEdgeBoth(int pPin){
-    return GIPY_pinSetEdge(pPin, BOTH);
-}
-
-pirror GIPY_pinSetEdge(int pPin, pinEdge pEdge){
-    dbgInfo("Try to set the edge (Pin: %d, value: %d)", pPin, pEdge);
-
-    //Check whether the pin is valid
-    if(isValidPinNumber(pPin)==FALSE){
-        dbgError("Invalid pin number: %d", pPin);
-        return GE_PIN;
-    }
-
-    //Pin must be enabled
-    if(valueFds[pPin] == -1){
-        dbgError("Try to set edge %d to unexported pin %d", pEdge,  pPin);
-        return GE_PERM;
+static pirror writeLevel(GIPY_Pin *pHandle, pinValue pValue){
+    if(pHandle->registers != NULL){
+        pHandle->registers[(pValue == LOGIC_ONE) ? GPIOMEM_GPSET0 : GPIOMEM_GPCLR0]
+            = pHandle->gpioBit;
+        return GE_OK;
     }
+    return (pwrite(__atomic_load_n(&pHandle->fd, __ATOMIC_RELAXED),
+                (pValue == LOGIC_ONE) ? "1" : "0", 1, 0) == 1) ? GE_OK : GE_IO;
+}
 
+static pirror writeEdge(int pPin, pinEdge pEdge){
     //Open the edge file
     char stamp[BUFSIZ];
-    sprintf(stamp, GPIO_PATH_EDGE, pPin);
+    sprintf(stamp, GPIO_PATH_EDGE, GIPY_getSysfsRoot(), pPin);
     int file = open(stamp, O_RDWR);
     if(file == -1){
         dbgError("Unable to open (Write) edge file %s", stamp);
@@ -278,155 +1925,299 @@ pirror GIPY_pinSetEdge(int pPin, pinEdge pEdge){
         return GE_IO;
     }
     close(file);
-    dbgInfo("Pin %d edge set", pPin);
+    if(GIPY_simIsEnabled() == TRUE){
+        simSetEdge(pPin, pEdge); //Simulated lines notify according to edge
+    }
     return GE_OK;
 }
 
+static void seqWriteBegin(uint32_t *pSeq){
+    uint32_t seq = __atomic_load_n(pSeq, __ATOMIC_RELAXED);
+    do{
+        while((seq & 1) != 0){
+            sched_yield(); //Other writer, a few stores at most
+            seq = __atomic_load_n(pSeq, __ATOMIC_RELAXED);
+        }
+    } while(!__atomic_compare_exchange_n(pSeq, &seq, seq + 1, FALSE,
+                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
 
-//------------------------------------------------------------------------------
-// GPIO Read / Write functions
-//------------------------------------------------------------------------------
-pirror GIPY_pinRead(int pPin, int *pRead){
-    dbgInfo("Try to read pin %d (fd: %d)", pPin, valueFds[pPin]);
+static void seqWriteEnd(uint32_t *pSeq){
+    __atomic_add_fetch(pSeq, 1, __ATOMIC_RELEASE);
+}
 
-    //Check if pin is valid
-    if(isValidPinNumber(pPin)==FALSE){
-        dbgError("Invalid pin number: %d", pPin);
-        return GE_PIN;
+static uint32_t seqReadBegin(uint32_t *pSeq){
+    uint32_t seq;
+    while(((seq = __atomic_load_n(pSeq, __ATOMIC_ACQUIRE)) & 1) != 0){
+        //Written: a few stores at most
     }
+    return seq;
+}
 
-    //Pin must be enabled
-    if(valueFds[pPin] == -1){
-        dbgError("Try to read from unexported pin %d",  pPin);
-        return GE_PERM;
+static int seqReadRetry(uint32_t *pSeq, uint32_t pStart){
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return (__atomic_load_n(pSeq, __ATOMIC_RELAXED) != pStart) ? TRUE : FALSE;
+}
+
+static int handlerAcquire(pinSlot *pSlot, uint32_t pGeneration){
+    if(pinAcquire(pSlot) == FALSE){
+        return -1;
     }
+    //Same file while used: unexport waits for the users before closing it
+    int file = __atomic_load_n(&pSlot->handle.fd, __ATOMIC_SEQ_CST);
+    if(file == -1 || __atomic_load_n(&pSlot->generation, __ATOMIC_SEQ_CST) != pGeneration){
+        pinRelease(pSlot);
+        return -1;
+    }
+    return file;
+}
 
-    //Read from the file
-    char buff;
-    lseek(valueFds[pPin], 0, SEEK_SET); //Go back beginning file
-    if(read(valueFds[pPin], &buff, 1) == -1){
-        dbgError("Unable to read from value file for pin: %d", pPin);
-        return GE_IO;
+static void mirrorPublish(pinSlot *pSlot, int pValue, uint64_t pStamp){
+    pinMirror *mirror = &pSlot->mirror;
+    seqWriteBegin(&mirror->seq);
+    if(pStamp == 0 || pStamp >= __atomic_load_n(&mirror->stamp, __ATOMIC_RELAXED)){
+        __atomic_store_n(&mirror->value, pValue, __ATOMIC_RELAXED);
+        __atomic_store_n(&mirror->stamp, pStamp, __ATOMIC_RELAXED);
     }
-    *pRead = buff-'0'; //n equals read value
-    dbgInfo("Pin %d read, value: %d", pPin, *pRead);
-    return GE_OK;
+    seqWriteEnd(&mirror->seq);
 }
 
-pirror GIPY_pinWrite(int pPin, pinValue pValue){
-    dbgInfo("Try to write %d in pin %d (fd: %d)", pValue, pPin, valueFds[pPin]);
+static uint64_t mirrorLoad(pinSlot *pSlot, int *pValue){
+    pinMirror   *mirror = &pSlot->mirror;
+    uint32_t    seq;
+    uint64_t    stamp;
+    int         value;
+    do{
+        seq     = seqReadBegin(&mirror->seq);
+        value   = __atomic_load_n(&mirror->value, __ATOMIC_RELAXED);
+        stamp   = __atomic_load_n(&mirror->stamp, __ATOMIC_RELAXED);
+    } while(seqReadRetry(&mirror->seq, seq) == TRUE);
+    *pValue = value;
+    return stamp;
+}
 
-    //Check if pin is valid
-    if(isValidPinNumber(pPin)==FALSE){
-        dbgError("Invalid pin number: %d", pPin);
-        return GE_PIN;
+static int mirrorSample(uint64_t *pPeriod){
+    pinTable    *table  = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+    int         count   = 0;
+    int         k;
+    for(k=0; table != NULL && k<table->nbSlots; k++){
+        pinSlot     *slot   = &table->slots[k];
+        uint64_t    maxAge  = __atomic_load_n(&slot->mirror.maxAge, __ATOMIC_RELAXED);
+        if(maxAge == 0){
+            continue;
+        }
+        if(count == 0 || maxAge / 2 < *pPeriod){
+            *pPeriod = maxAge / 2;
+        }
+        count++;
+        if(pinAcquire(slot) == FALSE){
+            continue; //Unexported: nothing to read
+        }
+        int         value;
+        uint64_t    stamp = GIPY_clockNow(); //The level is at least this recent
+        if(GIPY_handleRead(&slot->handle, &value) == GE_OK){
+            mirrorPublish(slot, value, stamp);
+        }
+        pinRelease(slot);
     }
+    return count;
+}
 
-    //check whether the pValue is valid
-    if(pValue != LOGIC_ZERO && pValue != LOGIC_ONE){
-        dbgError("Invalid value (%d) for pin: %d", pValue, pPin);
-        return GE_PINVAL;
+static void *mirrorSampler(void *pArg){
+    uint64_t period = MIRROR_MIN_PERIOD;
+    (void)pArg;
+    dbgInfo("Input mirror sampler started");
+    for(;;){
+        uint64_t start = GIPY_clockNow();
+        if(mirrorSample(&period) == 0){
+            //Checked again under the lock: GIPY_pinSetMirror may not start us
+            pthread_mutex_lock(&mirrorLock);
+            if(mirrorSample(&period) == 0){
+                isMirrorRunning = FALSE;
+                pthread_mutex_unlock(&mirrorLock);
+                break;
+            }
+            pthread_mutex_unlock(&mirrorLock);
+        }
+        uint64_t elapsed = GIPY_clockNow() - start;
+        if(elapsed < period){
+            GIPY_clockSleep(period - elapsed);
+        }
     }
+    dbgInfo("Input mirror sampler stopped");
+    return NULL;
+}
 
-    //Pin must be enabled
-    if(valueFds[pPin] == -1){
-        dbgError("Try to read from unexported pin %d",  pPin);
-        return GE_PERM;
+static void recordEvent(pinSlot *pSlot, uint64_t pStamp){
+    pinStats    *stats      = &pSlot->stats;
+    uint64_t    now         = GIPY_clockNow();
+    uint64_t    latency     = (now > pStamp) ? now - pStamp : 0;
+    if(stats->events == 0 || latency < stats->latencyMin){
+        stats->latencyMin = latency;
     }
-
-    //try to write the value in the gpio value file
-    char buff = (char) (pValue+'0');
-    lseek(valueFds[pPin], 0, SEEK_SET); //Go back beginning file
-    if(write(valueFds[pPin], &buff, 1) != 1){
-        dbgError("Unable to write in value file for pin: %d", pPin);
-        return GE_IO;
+    if(latency > stats->latencyMax){
+        stats->latencyMax = latency;
     }
-    dbgInfo("Successfully written %d in pin %d", pValue, pPin);
-    return GE_OK;
+    stats->latencyTotal += latency;
+    stats->events++;
 }
 
-
-//------------------------------------------------------------------------------
-// Interrupt functions
-//------------------------------------------------------------------------------
-pirror GIPY_pinCreateInterrupt(int pPin, void (*function)(void)){
-    dbgInfo("Try to create interrupt for pin %d", pPin);
-
-    //Check wither pin is valid
-    if(isValidPinNumber(pPin)==FALSE){
-        dbgError("Invalid pin number: %d", pPin);
-        return GE_PIN;
+static pinSlot *getPinSlot(const int pPin){
+    pinTable *table = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+    if(table == NULL){
+        pthread_mutex_lock(&pinsLock);
+        table = __atomic_load_n(&pinsTable, __ATOMIC_ACQUIRE);
+        if(table == NULL){
+            table = discoverPins();
+            __atomic_store_n(&pinsTable, table, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&pinsLock);
+        if(table == NULL){
+            return NULL;
+        }
     }
 
-    //Pin must be enabled
-    if(valueFds[pPin] == -1){
-        dbgError("Try to set interrupt to unexported pin %d", pPin);
-        return GE_PERM;
+    //O(1): one range check and one index read
+    unsigned int offset = (unsigned int)(pPin - table->pinBase);
+    if(offset >= (unsigned int)table->pinSpan || table->slotIndex[offset] == -1){
+        return NULL;
     }
-
-    //Create a thread which check for event. The function isr is saved
-    pthread_t threadId;
-    isrFunctions[pPin] = function; //Change handler function
-    pthread_create(&threadId,NULL,&pinInterruptHandler,(void *)(intptr_t)pPin);
-    return GE_OK;
+    return &table->slots[table->slotIndex[offset]];
 }
 
-static void *pinInterruptHandler(void *pPin){
-    int intPin = (intptr_t)pPin;
-    char buff[2];
-    dbgInfo("Start pinInterruptHandler for pin %d", intPin);
-    struct pollfd       pollstruct;
-    pollstruct.fd       = valueFds[intPin];
-    pollstruct.events   = POLLPRI;
+static pinTable *discoverPins(void){
+    const char  *root = GIPY_getSysfsRoot();
+    char        path[PATH_MAX + NAME_MAX + 16];
+    int         k, n;
 
-    sleep(1);
-    //Loop blocked by poll. Wait for any event and call function if interrupt
-    for(;;){
-        dbgInfo("* Wait for event (pin: %d, df: %d)", intPin, pollstruct.fd);
-        //If the pin has been unexported since the interrupt creation
-        if(pollstruct.fd == -1){
-            dbgInfo("Attention: pin %d unexported will interrupt running", intPin);
-            break; //Stop interrupt handling
+    pinTable *table = calloc(1, sizeof(pinTable));
+    if(table == NULL){
+        return NULL;
+    }
+
+    //Find all gpiochipN folders (Sorted by base)
+    DIR *dir = opendir(root);
+    struct dirent *entry;
+    while(dir != NULL && (entry = readdir(dir)) != NULL){
+        gpioChip chip;
+        if(strncmp(entry->d_name, "gpiochip", 8) != 0){
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s%s/base", root, entry->d_name);
+        if(readSysfsInt(path, &chip.base) == FALSE){
+            continue;
         }
+        snprintf(path, sizeof(path), "%s%s/ngpio", root, entry->d_name);
+        if(readSysfsInt(path, &chip.ngpio) == FALSE || chip.ngpio <= 0 || chip.base < 0){
+            continue;
+        }
+        chip.label[0] = '\0';
+        snprintf(path, sizeof(path), "%s%s/label", root, entry->d_name);
+        int file = open(path, O_RDONLY);
+        if(file != -1){
+            ssize_t len = read(file, chip.label, sizeof(chip.label) - 1);
+            chip.label[(len > 0) ? len : 0] = '\0';
+            chip.label[strcspn(chip.label, "\n")] = '\0';
+            close(file);
+        }
+        gpioChip *chips = realloc(table->chips, (table->nbChips + 1) * sizeof(gpioChip));
+        if(chips == NULL){
+            break;
+        }
+        table->chips = chips;
+        for(k=table->nbChips; k>0 && table->chips[k-1].base > chip.base; k--){
+            table->chips[k] = table->chips[k-1];
+        }
+        table->chips[k] = chip;
+        table->nbChips++;
+    }
+    if(dir != NULL){
+        closedir(dir);
+    }
 
-        //If an event is detected, call isr function
-        if(poll(&pollstruct, 1, -1) > 0){
-            if(pollstruct.revents & POLLPRI){
-                //Dummy read to clear the interrupt
-                read(pollstruct.fd, buff, 2);
-                lseek(pollstruct.fd, 0, SEEK_SET);
-                dbgInfo("Poll pin %d, df %d", intPin, pollstruct.fd);
-                isrFunctions[intPin]();
+    //Range of pin numbers (PINS_AVAILABLE if no chip found)
+    static const int defaultPins[NB_PINS] = {PINS_AVAILABLE};
+    int first = (table->nbChips > 0) ? table->chips[0].base : defaultPins[0];
+    int last  = defaultPins[NB_PINS-1];
+    for(k=0; k<table->nbChips; k++){
+        int end = table->chips[k].base + table->chips[k].ngpio - 1;
+        last = (k == 0 || end > last) ? end : last;
+    }
+    table->pinBase      = first;
+    table->pinSpan      = last - first + 1;
+    table->slotIndex    = malloc(table->pinSpan * sizeof(int32_t));
+    if(table->slotIndex == NULL){
+        free(table->chips);
+        free(table);
+        return NULL;
+    }
+    for(k=0; k<table->pinSpan; k++){
+        table->slotIndex[k] = -1;
+    }
 
-                /*
-                 * WARNING: Because of electronic behavior, when the button 
-                 * is pushed down, the signal is 'disturbed' and several 
-                 * poll could be catch till the signal is stable. 
-                 * In order to avoid this, the delay prevent poll to be called 
-                 * again to early. 
-                 * Some milliseconds should be enough to avoid loosing another 
-                 * interrupt even and avoid this issue.
-                 */
-                usleep(200);
+    //One slot per line (Overlapping chips are ignored)
+    if(table->nbChips == 0){
+        for(k=0; k<NB_PINS; k++){
+            table->slotIndex[defaultPins[k] - first] = table->nbSlots++;
+        }
+    }
+    for(k=0; k<table->nbChips; k++){
+        for(n=0; n<table->chips[k].ngpio; n++){
+            int32_t *index = &table->slotIndex[table->chips[k].base + n - first];
+            if(*index == -1){
+                *index = table->nbSlots++;
             }
         }
     }
-    dbgInfo("Error pinInterrupHandler for pin %d: end of function reached", intPin);
-    return NULL;
+    table->slots = malloc(((table->nbSlots > 0) ? table->nbSlots : 1) * sizeof(pinSlot));
+    if(table->slots == NULL){
+        free(table->slotIndex);
+        free(table->chips);
+        free(table);
+        return NULL;
+    }
+    for(k=0; k<table->nbSlots; k++){
+        memset(&table->slots[k], 0, sizeof(pinSlot));
+        table->slots[k].handle.fd = -1;
+        table->slots[k].wakeFile  = -1;
+        pthread_mutex_init(&table->slots[k].lock, NULL);
+    }
+    dbgInfo("Pin table: %d chips, %d lines, numbers %d to %d", table->nbChips,
+            table->nbSlots, first, last);
+    return table;
 }
 
-
-//------------------------------------------------------------------------------
-// Tools functions
-//------------------------------------------------------------------------------
-static int isValidPinNumber(const int pPin){
-    static int validPins[NB_PINS] = {PINS_AVAILABLE}; //Init during first call
-    int k = 0;
-    for(k=0; k<NB_PINS; k++){
-        if(validPins[k] == pPin){
-            return TRUE;
-        }
+static int readSysfsInt(const char *pPath, int *pValue){
+    char buff[32];
+    if(readSysfsText(pPath, buff, sizeof(buff)) == FALSE){
+        return FALSE;
     }
-    return FALSE;
+    *pValue = atoi(buff);
+    return TRUE;
+}
+
+static pinEdge parseEdge(const char *pText){
+    return (pText[0] == 'r') ? RISING : (pText[0] == 'f') ? FALLING
+         : (pText[0] == 'b') ? BOTH : NONE;
+}
+
+static int comparePins(const void *pA, const void *pB){
+    int a = *(const int *)pA;
+    int b = *(const int *)pB;
+    return (a > b) - (a < b);
 }
 
+static int readSysfsText(const char *pPath, char *pBuffer, size_t pSize){
+    int file = open(pPath, O_RDONLY);
+    if(file == -1){
+        return FALSE;
+    }
+    ssize_t len = read(file, pBuffer, pSize - 1);
+    close(file);
+    if(len <= 0){
+        return FALSE;
+    }
+    pBuffer[len] = '\0';
+    return TRUE;
+}
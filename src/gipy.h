@@ -3,6 +3,12 @@
  * GIPY Library Header
  * Manage Raspberry Pi GPIO
  *
+ * THREADS
+ * All functions can be called from many threads. Values are accessed with
+ * positional reads / writes (No shared file offset) and the state of each
+ * pin is atomic: pins never wait for each other. Configuration changes of
+ * a pin (Export, direction, edge) are serialized per pin.
+ *
  * Since:   Nov 29, 2015
  * Author:  Constantin MASSON
  * -----------------------------------------------------------------------------
@@ -20,9 +26,16 @@
 #include <poll.h> //For interrupt thread
 #include <pthread.h>
 #include <stdint.h> //Used for pointer convert
+#include <limits.h> //For PATH_MAX
+#include <dirent.h> //For gpiochip discovery
 
 #include "errman.h" //Error management
 #include "debug.h" //Debug lib
+#include "clock.h" //Timestamps and timeouts
+
+#ifdef __cplusplus
+extern "C" { //Also used from C++ (See gipy.hpp)
+#endif
 
 
 //------------------------------------------------------------------------------
@@ -30,17 +43,27 @@
 //------------------------------------------------------------------------------
 #define TRUE                    (1==1)
 #define FALSE                   (1==42)
-#define GPIO_PATH               "/sys/class/gpio/"
-#define GPIO_PATH_EXPORT        GPIO_PATH"export"
-#define GPIO_PATH_UNEXPORT      GPIO_PATH"unexport"
-#define GPIO_PATH_DIRECTION     GPIO_PATH"gpio%d/direction"
-#define GPIO_PATH_EDGE          GPIO_PATH"gpio%d/edge"
-#define GPIO_PATH_VALUE         GPIO_PATH"gpio%d/value"
+#define GPIO_PATH               "/sys/class/gpio/" //Default sysfs root
+#define GPIO_ROOT_ENV           "GIPY_SYSFS_ROOT" //Env var to relocate root
+#define GPIO_PATH_EXPORT        "%sexport"
+#define GPIO_PATH_UNEXPORT      "%sunexport"
+#define GPIO_PATH_DIRECTION     "%sgpio%d/direction"
+#define GPIO_PATH_EDGE          "%sgpio%d/edge"
+#define GPIO_PATH_VALUE         "%sgpio%d/value"
 
 //This list of pins accept the Raspberry Pi Model B Revision 1 and 2
+//Only used if no gpiochip is found in the sysfs root
 #define PINS_AVAILABLE 0,1,2,3,4,7,8,9,10,11,14,15,17,18,21,22,23,24,25,27
 #define NB_PINS 20 //Actually 17, but this mixt R1 and R2
 
+#define ADAPT_WINDOW            (10 * NSEC_PER_MSEC) //Edge rate measure period
+#define STORM_BACKOFF_MAX_SHIFT 6 //Back-off doubles up to 64 times the base
+#define VIRTUAL_MAX_RANGES      8 //Max ranges of virtual pins
+#define SNAPSHOT_MAGIC          0x53504947 //"GIPS" (Host byte order)
+#define SNAPSHOT_VERSION        1
+#define SNAPSHOT_ARMED          0x01 //Snapshot flag: interrupt armed
+#define MIRROR_MIN_PERIOD       (10 * NSEC_PER_USEC) //Min input mirror sampling period
+
 
 //------------------------------------------------------------------------------
 // STRUCTURES
@@ -74,12 +97,191 @@ typedef enum {
     BOTH
 } pinEdge;
 
+/**
+ * \brief Describe how the interrupt handler of a pin detects edges
+ */
+typedef enum {
+    PIN_MODE_INTERRUPT, //Wait for the kernel notification (poll)
+    PIN_MODE_SAMPLED,   //Read the value periodically (See GIPY_pinSetAdaptive)
+    PIN_MODE_STORM      //Edge disabled by the storm detector (See GIPY_pinSetRateLimit)
+} pinMode;
+
+/**
+ * \brief Event statistics of a pin (Filled by the interrupt handler)
+ * \details Latency is measured from the edge timestamp till the start of the
+ *          callback, using the library clock (ns).
+ */
+typedef struct {
+    uint64_t events; //Number of handled events (Callbacks called)
+    uint64_t latencyMin;
+    uint64_t latencyMax;
+    uint64_t latencyTotal;
+    pinMode  mode; //Current mode (Kept by reset)
+    uint64_t modeSwitches; //Number of mode changes
+    uint64_t sampledEvents; //Events detected in sampled mode
+    uint64_t coalesced; //Edges merged in another event (Rate limit)
+    uint64_t storms; //Number of edge storms (Edge disabled for a back-off)
+} pinStats;
+
+/**
+ * \brief GPIO controller found in the sysfs root (gpiochipN folder)
+ * \details Lines of the chip are the pins base to base + ngpio - 1
+ */
+typedef struct {
+    int     base;
+    int     ngpio;
+    char    label[32];
+} gpioChip;
+
+/**
+ * \brief State of a pin read in the sysfs root (See GIPY_pinGetState)
+ */
+typedef struct {
+    int             isExported;
+    pinDirection    direction;  //IN or OUT
+    pinEdge         edge;
+    int             value;      //Level read, -1 if unreadable
+} pinState;
+
+/**
+ * \brief Snapshot blob header, followed by 'count' pinSnapshot sorted by pin
+ */
+typedef struct {
+    uint32_t    magic;      //SNAPSHOT_MAGIC
+    uint16_t    version;    //SNAPSHOT_VERSION
+    uint16_t    count;
+} snapshotHeader;
+
+/**
+ * \brief Configuration of one exported pin in a snapshot (8 bytes)
+ */
+typedef struct {
+    int32_t     pin;
+    uint8_t     direction;  //IN or OUT
+    uint8_t     edge;
+    uint8_t     value;      //Output level (0 for an input)
+    uint8_t     flags;      //SNAPSHOT_ARMED...
+} pinSnapshot;
+
+/**
+ * \brief Pin handle (Opaque). See GIPY_pinOpen
+ */
+typedef struct gipyPin GIPY_Pin;
+
+/**
+ * \brief Function called in the event path for each edge of a pin
+ * \details Parameters are the pin, its value read after the edge, the edge
+ *          timestamp (Library clock, ns) and the context given with the hook.
+ *          Runs in the interrupt thread of the pin: must not block.
+ */
+typedef void (*pinEdgeHook)(int, int, uint64_t, void*);
+
+/**
+ * \brief Operations of virtual pins (Pins of an engine, see gipyAddVirtualPins)
+ * \details Parameters are the context given with the pins, the pin index in
+ *          the range, then the value or direction.
+ */
+typedef struct {
+    pirror  (*read)(void*, int, int*);
+    pirror  (*write)(void*, int, int);
+    pirror  (*setDirection)(void*, int, pinDirection);
+} virtualPinOps;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Sysfs root functions
+//------------------------------------------------------------------------------
+/**
+ * \brief           Relocate the GPIO sysfs root
+ * \details         Must be called while no pin is exported. 
+ *                  The root should end with a '/' (Added if missing). 
+ *                  If NULL, GIPY_SYSFS_ROOT env var (or GPIO_PATH) is used.
+ *                  The gpiochips are discovered again on next use.
+ *
+ * \param pRoot     Path of the folder to use instead of /sys/class/gpio/
+ * \return GE_OK    If no error
+ * \return GE_PARAM If path is too long
+ * \return GE_PERM  If pins are exported
+ */
+pirror GIPY_setSysfsRoot(const char*);
+
+/**
+ * \brief           Get the current GPIO sysfs root (Always ends with '/')
+ *
+ * \return          Root path
+ */
+const char *GIPY_getSysfsRoot(void);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Pin table functions
+//------------------------------------------------------------------------------
+/**
+ * \brief           Discover the gpiochips and build the pin table
+ * \details         Optional: done on first use otherwise. Pins are the 
+ *                  lines of the chips found in the sysfs root (Any number, 
+ *                  sparse ranges allowed). If no chip is found, the pins 
+ *                  are PINS_AVAILABLE. 
+ *                  Pins still exported by a previous run are adopted 
+ *                  (See GIPY_pinAdoptAll).
+ *
+ * \return GE_OK    If no error
+ * \return GE_IO    If unable to allocate the table
+ */
+pirror GIPY_init(void);
+
+/**
+ * \brief           Get the discovered gpiochips (Sorted by base)
+ *
+ * \param pChips    Filled with at most pMax chips (May be NULL)
+ * \param pMax      Size of pChips
+ * \return          Number of chips found
+ */
+int GIPY_getChips(gpioChip*, int);
+
+/**
+ * \brief           Check whether a pin number is a line of a gpiochip
+ *
+ * \param pPin      Pin number (Global GPIO number)
+ * \return          TRUE if valid, otherwise FALSE
+ */
+int GIPY_isValidPin(int);
+
+/**
+ * \brief           List the exported pins (Any process)
+ * \details         One pass on the gpioN folders of the sysfs root. Pins
+ *                  are sorted. Nothing is opened or adopted.
+ *
+ * \param pPins     Filled with at most pMax pins (May be NULL)
+ * \param pMax      Size of pPins
+ * \return          Number of exported pins (May be more than pMax)
+ */
+int GIPY_pinListExported(int*, int);
+
+/**
+ * \brief           Read the state of a pin in the sysfs root
+ * \details         Reads the direction, edge and value files (No fork, no
+ *                  export, no lookup): works for pins exported by any
+ *                  process. Nothing is changed.
+ *
+ * \param pPin      Pin number
+ * \param pState    Filled with the state (isExported FALSE if not exported)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If pState is NULL
+ */
+pirror GIPY_pinGetState(int, pinState*);
+
 
 //------------------------------------------------------------------------------
 // PROTOTYPES: Pin set direction functions
 //------------------------------------------------------------------------------
 /**
  * \brief           Export (Enable) a GPIO Pin.
+ * \details         A pin already exported (Previous run, other process) is 
+ *                  adopted: its value file is opened and its edge and 
+ *                  output level are read back. Nothing is written, an 
+ *                  output keeps its level. A pin already exported by
+ *                  this process is left as it is (Interrupt kept running).
  *
  * \param pPin      Pin number to enable
  * \return GE_OK    If no error
@@ -89,8 +291,21 @@ typedef enum {
  */
 pirror GIPY_pinExport(int);
 
+/**
+ * \brief           Adopt all the pins exported before this process
+ * \details         One pass on the gpioN folders of the sysfs root, each 
+ *                  pin not exported by the library yet is adopted (See 
+ *                  GIPY_pinExport). Called by GIPY_init: after a crash, the 
+ *                  restart reuses the exports without any output glitch.
+ *
+ * \return          Number of pins adopted
+ */
+int GIPY_pinAdoptAll(void);
+
 /**
  * \brief           Unexport (disable) a pin
+ * \details         Waits for the int functions in progress on the pin.
+ *                  Handles of the pin must not be used anymore.
  *
  * \param pPin      Pin to disable
  * \return GE_OK    If no error
@@ -240,6 +455,8 @@ pirror GIPY_pinSetEdge(int, pinEdge);
 
 /**
  * \brief           Read a pin value
+ * \details         A mirrored pin is read from its mirror if the mirrored
+ *                  level is fresh enough (See GIPY_pinSetMirror)
  *
  * \param pPin      Pin number to read
  * \param pRead     Pointer toward read value to fill
@@ -265,6 +482,90 @@ pirror GIPY_pinRead(int, int*);
 pirror GIPY_pinWrite(int, pinValue);
 
 
+//------------------------------------------------------------------------------
+// PROTOTYPES: Pin handle functions
+//------------------------------------------------------------------------------
+
+/**
+ * \brief               Get the handle of an exported pin
+ * \details             Pin number, export state and backend (Registers or
+ *                      value file) are resolved once here. Handle functions
+ *                      do not check anything else: use them in control 
+ *                      loops. The handle is owned by the library and stays
+ *                      valid till the pin is unexported.
+ *
+ * \param pPin          Pin number
+ * \return              Handle of the pin, NULL if invalid or unexported pin
+ */
+GIPY_Pin *GIPY_pinOpen(int);
+
+/**
+ * \brief               Get the pin number of a handle
+ *
+ * \param pHandle       Pin handle
+ * \return              Pin number
+ */
+int GIPY_handlePin(const GIPY_Pin*);
+
+/**
+ * \brief               Get the backend of a handle (For inlined accesses)
+ * \details             With registers (Not NULL), the bit of the pin (See
+ *                      GIPY_handleRegisterBit) in the GPIOMEM_GPLEV0 /
+ *                      GPSET0 / GPCLR0 words is used (See bank.h), otherwise
+ *                      the value file. Both stay valid till the pin is
+ *                      unexported.
+ *
+ * \param pHandle       Pin handle
+ * \param pRegisters    Filled with the mapped registers, NULL if none
+ * \return              Value file
+ */
+int GIPY_handleBackend(const GIPY_Pin*, volatile uint32_t**);
+
+/**
+ * \brief               Get the register bit of a handle
+ * \details             1 << line of the pin in the BCM gpiochip (Its base
+ *                      is not 0 on recent kernels).
+ *
+ * \param pHandle       Pin handle
+ * \return              Register bit, 0 if the handle has no registers
+ */
+uint32_t GIPY_handleRegisterBit(const GIPY_Pin*);
+
+/**
+ * \brief               Read the value of a pin
+ *
+ * \param pHandle       Pin handle
+ * \param pRead         Filled with the value (0 or 1)
+ * \return GE_OK        If no error
+ * \return GE_IO        If unable to read the value
+ */
+pirror GIPY_handleRead(GIPY_Pin*, int*);
+
+/**
+ * \brief               Write the value of a pin
+ *
+ * \param pHandle       Pin handle
+ * \param pValue        Value to write
+ * \return GE_OK        If no error
+ * \return GE_PINVAL    If invalid value
+ * \return GE_IO        If unable to write the value
+ */
+pirror GIPY_handleWrite(GIPY_Pin*, pinValue);
+
+/**
+ * \brief               Invert the value of a pin
+ * \details             Uses the last value written by the library (Handle,
+ *                      int functions or low / high direction). The pin is
+ *                      read once if this value is unknown. Concurrent
+ *                      toggles of a handle are all applied.
+ *
+ * \param pHandle       Pin handle
+ * \return GE_OK        If no error
+ * \return GE_IO        If unable to read or write the value
+ */
+pirror GIPY_handleToggle(GIPY_Pin*);
+
+
 //------------------------------------------------------------------------------
 // PROTOTYPES: interrupt functions
 //------------------------------------------------------------------------------
@@ -273,7 +574,9 @@ pirror GIPY_pinWrite(int, pinValue);
  * \brief               Create an interrupt for specific pin
  * \details             At most one interrupt can be created for a pin
  *                      Attention: if this pin already got an interrupt set, 
- *                      it will be lost and replaced by this new one.
+ *                      it will be lost and replaced by this new one (Same
+ *                      handler thread, one per export).
+ *                      Function may be NULL if only an edge hook is used.
  *
  * \param               pin linked with interrupt
  * \param               function to execut if interrupt generated
@@ -283,6 +586,230 @@ pirror GIPY_pinWrite(int, pinValue);
  */
 pirror GIPY_pinCreateInterrupt(int, void (*function)(void));
 
+/**
+ * \brief               Set the edge hook of a pin
+ * \details             The hook is called for every edge detected by the 
+ *                      interrupt of the pin (See GIPY_pinCreateInterrupt), 
+ *                      before the interrupt function. Debounce delay is 
+ *                      only applied if the pin has an interrupt function.
+ *                      Returns once the previous hook is not running (Its
+ *                      context can be freed): not to call from a hook.
+ *
+ * \param pPin          Pin number
+ * \param pHook         Hook to call (NULL to remove)
+ * \param pContext      Context given to the hook
+ * \return GE_OK        If no error
+ * \return GE_PIN       If invalid pin number
+ */
+pirror GIPY_pinSetEdgeHook(int, pinEdgeHook, void*);
+
+/**
+ * \brief               Switch the interrupt of a pin between interrupt and
+ *                      sampled mode according to its edge rate
+ * \details             The edge rate is measured every ADAPT_WINDOW. Above
+ *                      pHighRate, the edge notification is disabled (Edge
+ *                      none) and the value is read every pPeriod: level
+ *                      changes matching the edge setting are handled as
+ *                      events (Timestamp is the read time). Below pLowRate,
+ *                      the edge notification is enabled again. Events are
+ *                      handled by the same thread in both modes, in order.
+ *                      Pulses shorter than pPeriod are lost in sampled mode.
+ *                      Disabled by default (pHighRate 0).
+ *
+ * \param pPin          Pin number
+ * \param pHighRate     Edges per second to switch to sampled mode (0 disable)
+ * \param pLowRate      Edges per second to switch back to interrupt mode
+ * \param pPeriod       Sampling period (ns)
+ * \return GE_OK        If no error
+ * \return GE_PIN       If invalid pin number
+ * \return GE_PARAM     If pLowRate >= pHighRate or pPeriod is 0
+ */
+pirror GIPY_pinSetAdaptive(int, uint32_t, uint32_t, uint64_t);
+
+/**
+ * \brief               Limit the event rate of a pin
+ * \details             Edges closer than pMinInterval from the last handled
+ *                      event are coalesced: they are handled as one event,
+ *                      pMinInterval after the last one, with the value and
+ *                      timestamp of the last edge (See GIPY_pinGetEventCount).
+ *                      If the edge rate in interrupt mode (Measured every
+ *                      ADAPT_WINDOW) reaches pStormRate, the edge is set to
+ *                      none for pBackOff (Doubled if the storm goes on after
+ *                      the re-arm, up to STORM_BACKOFF_MAX_SHIFT times).
+ *                      Storms are logged and counted in the pin statistics.
+ *
+ * \param pPin          Pin number
+ * \param pMinInterval  Min time between two events (ns, 0 to disable)
+ * \param pStormRate    Edges per second of a storm (0 to disable)
+ * \param pBackOff      Time the edge is disabled after a storm (ns)
+ * \return GE_OK        If no error
+ * \return GE_PIN       If invalid pin number
+ * \return GE_PARAM     If pStormRate is set with a pBackOff of 0
+ */
+pirror GIPY_pinSetRateLimit(int, uint64_t, uint32_t, uint64_t);
+
+/**
+ * \brief               Get the number of edges of the event being handled
+ * \details             To be called from the ISR function or edge hook of
+ *                      the pin. More than 1 if edges were coalesced.
+ *
+ * \param pPin          Pin number
+ * \return              Number of edges (0 if invalid pin)
+ */
+uint32_t GIPY_pinGetEventCount(int);
+
+/**
+ * \brief               Get the event statistics of a pin
+ *
+ * \param pPin          Pin number
+ * \param pStats        Structure to fill
+ * \return GE_OK        If no error
+ * \return GE_PIN       If invalid pin number
+ * \return GE_PARAM     If pStats is NULL
+ */
+pirror GIPY_pinGetStats(int, pinStats*);
+
+/**
+ * \brief               Reset the event statistics of a pin
+ *
+ * \param pPin          Pin number
+ * \return GE_OK        If no error
+ * \return GE_PIN       If invalid pin number
+ */
+pirror GIPY_pinResetStats(int);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Input mirror functions
+//------------------------------------------------------------------------------
+/**
+ * \brief           Keep the level of a pin in memory (Input mirror)
+ * \details         A sampler thread (One for all the mirrored pins) reads
+ *                  the mirrored pins every half of the smallest max age.
+ *                  Events of the pin (Interrupt or sampled mode), writes
+ *                  and reads also update the mirror. The level and the
+ *                  time it was read are published with a seqlock: readers
+ *                  never wait for the sampler. GIPY_pinRead returns the
+ *                  mirrored level if read less than pMaxAge ago, otherwise
+ *                  it reads the value file. Pulses shorter than the
+ *                  sampling period may be missed if the edge of the pin is
+ *                  not armed. Unexport disables the mirror.
+ *
+ * \param pPin      Pin number
+ * \param pMaxAge   Max age of a mirrored level (ns, 0 to disable)
+ * \return GE_OK    If no error
+ * \return GE_PIN   If invalid pin number
+ * \return GE_PARAM If pMaxAge is less than 2 * MIRROR_MIN_PERIOD
+ * \return GE_PERM  If the pin is not exported (Enabling only)
+ * \return GE_IO    If unable to start the sampler thread
+ */
+pirror GIPY_pinSetMirror(int, uint64_t);
+
+/**
+ * \brief           Read the mirrored level of a pin, without syscall
+ * \details         The level is returned whatever its age: the caller
+ *                  checks the timestamp (Library clock, see GIPY_clockNow).
+ *
+ * \param pPin      Pin number
+ * \param pRead     Pointer toward read value to fill
+ * \param pStamp    Filled with the time the level was read (May be NULL)
+ * \return GE_OK    If no error
+ * \return GE_PIN   If invalid pin number
+ * \return GE_PARAM If pRead is NULL
+ * \return GE_PERM  If the pin is not mirrored (Or unexported), or not read yet
+ */
+pirror GIPY_pinReadMirror(int, int*, uint64_t*);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Snapshot functions
+//------------------------------------------------------------------------------
+/**
+ * \brief           Capture the configuration of the exported pins
+ * \details         Pins exported by the library (Adopted ones included):
+ *                  direction, edge, output level and armed interrupt. The
+ *                  state is known by the library, nothing is read (Except
+ *                  the direction of a pin exported without setting it,
+ *                  read once). The blob is for the same host (Byte order).
+ *
+ * \param pBuffer   Filled with the blob if large enough (May be NULL)
+ * \param pSize     Size of pBuffer
+ * \return          Size of the blob (Nothing written if more than pSize)
+ */
+size_t GIPY_snapshotCapture(void*, size_t);
+
+/**
+ * \brief           Apply a snapshot as a diff against the current state
+ * \details         Only the differences are written: pins not in the
+ *                  snapshot are unexported, missing ones exported (Or
+ *                  adopted), then direction, output level and edge are
+ *                  changed if needed. An output is set with one direction
+ *                  write (low / high, no glitch). Unchanged pins cost no
+ *                  syscall. Armed interrupts are created with the ISR
+ *                  function and hook of the pin (Set them before);
+ *                  an interrupt not in the snapshot keeps running, with
+ *                  the edge of the snapshot. Not atomic: other threads
+ *                  must not configure pins meanwhile.
+ *
+ * \param pBlob     Snapshot (See GIPY_snapshotCapture)
+ * \param pSize     Size of the blob
+ * \param pChanges  Filled with the number of changes done (May be NULL)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid blob
+ * \return          Otherwise first error of a pin (Other pins are applied)
+ */
+pirror GIPY_snapshotRestore(const void*, size_t, int*);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Library internal
+//------------------------------------------------------------------------------
+/**
+ * \brief           Get the slot of a pin (Dense index, 0 to slot count - 1)
+ *
+ * \param pPin      Pin number
+ * \return          Slot of the pin, -1 if not valid
+ */
+int gipyPinSlot(int);
+
+/**
+ * \brief           Get the number of slots of the pin table
+ *
+ * \return          Number of pins
+ */
+int gipyPinSlotCount(void);
+
+/**
+ * \brief           Add a range of virtual pins
+ * \details         Virtual pins are numbers out of the gpiochips, driven by
+ *                  an engine (Shift registers...). GIPY_pinRead,
+ *                  GIPY_pinWrite and GIPY_pinSetDirection call the engine,
+ *                  export and unexport do nothing. Other functions do not
+ *                  accept them (GE_PIN). Only looked up for numbers which
+ *                  are not a line (No cost for the real pins).
+ *
+ * \param pBase     First pin number
+ * \param pCount    Number of pins
+ * \param pOps      Operations of the pins (Must stay valid)
+ * \param pContext  Given to the operations
+ * \return GE_OK    If no error
+ * \return GE_PARAM If a number is already a pin, or no range left
+ */
+pirror gipyAddVirtualPins(int, int, const virtualPinOps*, void*);
+
+/**
+ * \brief           Remove a range of virtual pins
+ * \details         The pins must not be used anymore (Not checked).
+ *
+ * \param pBase     First pin number of the range
+ * \return void
+ */
+void gipyRemoveVirtualPins(int);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
 
@@ -0,0 +1,270 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY C++ Header (Header only, C++17)
+ * Typed pins checked at compile time
+ *
+ * PINS
+ * Pin<N, Direction, Board> is one exported pin: the pin number and its
+ * direction are part of the type. They are checked at compile time against
+ * a board profile (Line exists, direction supported). The pin is exported
+ * and its direction set by the constructor, unexported by the destructor.
+ * Errors are not thrown: status() gives the construction error.
+ *
+ * ACCESSES
+ * Read, write and toggle are inlined: the register bit is a constant, the
+ * value file and registers are resolved once by the constructor (See
+ * GIPY_handleBackend). Only the backend choice is left at runtime, and only
+ * if the board profile has registers for the pin. The profile gives the
+ * base of the BCM gpiochip (0 before Linux 6.6, 512 since): registers are
+ * not used if it does not match the running kernel. Writes through a Pin do
+ * not update the level known by GIPY_handleToggle.
+ *
+ * EDGES
+ * onEdge() takes any callable (Lambda with captures as user context...),
+ * called as f(int value, uint64_t stamp) in the interrupt thread of the pin
+ * through an edge hook (See GIPY_pinSetEdgeHook). The callable is owned by
+ * the Pin.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_GIPY_HPP_
+#define _HEADER_GIPY_HPP_
+
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "gipy.h"
+#include "bank.h"
+
+namespace gipy {
+
+
+//------------------------------------------------------------------------------
+// BOARD PROFILES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Raspberry Pi with 40 pins header (BCM lines 0 to 27). Pins are
+ *        the sysfs numbers: line plus the BCM gpiochip Base
+ */
+template<int Base>
+struct RaspberryPiAt {
+    static constexpr int base = Base;
+    static constexpr bool isPin(int pPin){ return pPin >= Base && pPin <= Base + 27; }
+    static constexpr bool canInput(int pPin){ return isPin(pPin); }
+    static constexpr bool canOutput(int pPin){ return isPin(pPin); }
+    static constexpr bool hasRegisters(int pPin){ return isPin(pPin); }
+    static constexpr int line(int pPin){ return pPin - Base; } //Register bit
+};
+
+using RaspberryPi       = RaspberryPiAt<0>; //Linux before 6.6
+using RaspberryPi512    = RaspberryPiAt<512>; //Linux 6.6 and later
+
+/**
+ * \brief Raspberry Pi Model B revision 1 and 2 (PINS_AVAILABLE)
+ */
+struct RaspberryPiB : RaspberryPi {
+    static constexpr bool isPin(int pPin){
+        constexpr int pins[] = {PINS_AVAILABLE};
+        for(int pin : pins){
+            if(pin == pPin){
+                return true;
+            }
+        }
+        return false;
+    }
+    static constexpr bool hasRegisters(int pPin){ return isPin(pPin); }
+    static constexpr bool canInput(int pPin){ return isPin(pPin); }
+    static constexpr bool canOutput(int pPin){ return isPin(pPin); }
+};
+
+/**
+ * \brief Any sysfs GPIO (Pins checked at runtime only, no registers)
+ */
+struct AnyBoard {
+    static constexpr bool isPin(int pPin){ return pPin >= 0; }
+    static constexpr bool canInput(int){ return true; }
+    static constexpr bool canOutput(int){ return true; }
+    static constexpr bool hasRegisters(int){ return false; }
+};
+
+#ifdef GIPY_DEFAULT_BOARD
+using DefaultBoard = GIPY_DEFAULT_BOARD;
+#else
+using DefaultBoard = RaspberryPi;
+#endif
+
+
+//------------------------------------------------------------------------------
+// DIRECTIONS
+//------------------------------------------------------------------------------
+struct In {
+    static constexpr pinDirection   direction   = IN;
+    static constexpr bool           isOutput    = false;
+};
+
+struct Out { //Starts low
+    static constexpr pinDirection   direction   = LOW;
+    static constexpr bool           isOutput    = true;
+};
+
+struct OutHigh {
+    static constexpr pinDirection   direction   = HIGH;
+    static constexpr bool           isOutput    = true;
+};
+
+
+//------------------------------------------------------------------------------
+// PIN
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Exported pin N (RAII). Not copyable, not movable (Owns the export)
+ */
+template<int N, class Dir, class Board = DefaultBoard>
+class Pin {
+    static_assert(Board::isPin(N), "Pin is not a line of the board profile");
+    static_assert(Dir::isOutput ? Board::canOutput(N) : Board::canInput(N),
+            "Direction is not supported by this pin");
+
+    public:
+        static constexpr int number = N;
+
+        Pin(){
+            status_ = GIPY_pinExport(N);
+            if(status_ == GE_OK){
+                isExported_ = true;
+                status_     = GIPY_pinSetDirection(N, Dir::direction);
+            }
+            GIPY_Pin *handle = (status_ == GE_OK) ? GIPY_pinOpen(N) : nullptr;
+            if(handle != nullptr){
+                fd_ = GIPY_handleBackend(handle, &registers_);
+                if constexpr(Board::hasRegisters(N)){
+                    if(GIPY_handleRegisterBit(handle) != 1U << Board::line(N)){
+                        registers_ = nullptr; //Profile base is not the kernel one
+                    }
+                }
+            }
+            else if(status_ == GE_OK){
+                status_ = GE_PERM;
+            }
+            level_ = (Dir::direction == HIGH) ? 1 : 0;
+        }
+
+        ~Pin(){
+            if(hook_ != nullptr){
+                GIPY_pinSetEdgeHook(N, nullptr, nullptr); //Waits a running call
+            }
+            if(isExported_){
+                GIPY_pinUnexport(N); //Stops the interrupt thread
+            }
+        }
+
+        Pin(const Pin&)             = delete;
+        Pin &operator=(const Pin&)  = delete;
+
+        /**
+         * \brief   Construction error (GE_OK if the pin is usable)
+         */
+        pirror status() const { return status_; }
+        explicit operator bool() const { return status_ == GE_OK; }
+
+        /**
+         * \brief   Read the level of the pin
+         * \return  0 or 1, -1 if unable to read
+         */
+        int read() const {
+            if constexpr(Board::hasRegisters(N)){
+                if(registers_ != nullptr){
+                    return (registers_[GPIOMEM_GPLEV0] >> Board::line(N)) & 0x01;
+                }
+            }
+            char buff;
+            return (pread(fd_, &buff, 1, 0) == 1) ? buff - '0' : -1;
+        }
+
+        /**
+         * \brief   Write the level of an output
+         * \return  GE_OK if no error, otherwise GE_IO
+         */
+        pirror write(bool pHigh){
+            static_assert(Dir::isOutput, "write() needs an output pin");
+            level_ = pHigh ? 1 : 0;
+            if constexpr(Board::hasRegisters(N)){
+                if(registers_ != nullptr){
+                    registers_[pHigh ? GPIOMEM_GPSET0 : GPIOMEM_GPCLR0] = 1U << Board::line(N);
+                    return GE_OK;
+                }
+            }
+            return (pwrite(fd_, pHigh ? "1" : "0", 1, 0) == 1) ? GE_OK : GE_IO;
+        }
+
+        /**
+         * \brief   Invert the level of an output (Last level written by this Pin)
+         */
+        pirror toggle(){
+            static_assert(Dir::isOutput, "toggle() needs an output pin");
+            return write(level_ == 0);
+        }
+
+        /**
+         * \brief   Call a callable on each edge of an input
+         * \details Replaces the previous callable. The interrupt thread is
+         *          created by the first call.
+         *
+         * \param   pEdge       Edges to notify (RISING, FALLING, BOTH)
+         * \param   pCallable   Called as f(int value, uint64_t stamp)
+         * \return  GE_OK if no error, otherwise the error of the pin functions
+         */
+        template<class F>
+        pirror onEdge(pinEdge pEdge, F &&pCallable){
+            static_assert(!Dir::isOutput, "onEdge() needs an input pin");
+            using Callable = std::decay_t<F>;
+            static_assert(std::is_invocable_v<Callable&, int, uint64_t>,
+                    "Callable must accept (int value, uint64_t stamp)");
+
+            pirror err = GIPY_pinSetEdgeHook(N, nullptr, nullptr);
+            hook_.reset(); //Not running anymore
+            if(err != GE_OK || (err = GIPY_pinSetEdge(N, pEdge)) != GE_OK){
+                return err;
+            }
+            Callable *callable = new Callable(std::forward<F>(pCallable));
+            hook_ = HookPtr(callable, &deleteHook<Callable>);
+            err = GIPY_pinSetEdgeHook(N, &callHook<Callable>, callable);
+            if(err == GE_OK && !isInterrupt_){
+                err             = GIPY_pinCreateInterrupt(N, nullptr);
+                isInterrupt_    = (err == GE_OK);
+            }
+            return err;
+        }
+
+    private:
+        using HookPtr = std::unique_ptr<void, void (*)(void*)>;
+
+        template<class Callable>
+        static void callHook(int, int pValue, uint64_t pStamp, void *pContext){
+            (*static_cast<Callable*>(pContext))(pValue, pStamp);
+        }
+
+        template<class Callable>
+        static void deleteHook(void *pContext){
+            delete static_cast<Callable*>(pContext);
+        }
+
+        pirror              status_     = GE_OK;
+        bool                isExported_ = false;
+        bool                isInterrupt_= false;
+        int                 fd_         = -1;
+        volatile uint32_t   *registers_ = nullptr;
+        int                 level_      = 0;    //Last level written
+        HookPtr             hook_       = HookPtr(nullptr, nullptr);
+};
+
+} //namespace gipy
+
+#endif
+
@@ -0,0 +1,387 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Client
+ * Pin functions of gipy.h implemented on top of gipyd (See gipyd.h)
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "gipyd.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Client side state of a pin
+ */
+typedef struct {
+    pinEdge     edge;           //Edges delivered to the ISR function
+    void        (*isr)(void);   //ISR function (NULL if none)
+    int         isWaiting;      //TRUE if the interrupt thread runs
+} clientPin;
+
+/**
+ * \brief   Connect to gipyd and map the shared state (Once)
+ *
+ * \return  GE_OK if connected, otherwise GE_IO
+ */
+static pirror connectDaemon(void);
+
+/**
+ * \brief   Send commands in one message and get the results
+ *
+ * \param   pCommands   Commands to send
+ * \param   pNb         Number of commands
+ * \param   pResults    Filled with one result per command
+ * \return  GE_OK if sent, GE_IO if gipyd not reachable
+ */
+static pirror sendCommands(const gipydCommand*, int, int32_t*);
+
+/**
+ * \brief   Send one command (Or queue it if a batch is started)
+ *
+ * \return  Result of the command
+ */
+static pirror command(gipydOp, int, int);
+
+/**
+ * \brief   Get the shared entry of a pin
+ *
+ * \param   pPin    Pin number
+ * \return  Entry index, -1 if not a pin of gipyd
+ */
+static int getEntry(int);
+
+/**
+ * \brief   Copy a shared entry (Seqlock read)
+ *
+ * \param   pIndex  Entry index
+ * \param   pCopy   Filled with a consistent copy
+ */
+static void readEntry(int, gipydPin*);
+
+/**
+ * \brief   Interrupt thread of a pin. Wait on the entry events futex
+ */
+static void *waitThread(void*);
+
+static int              daemonFd        = -1;
+static gipydState       *state          = NULL;
+static clientPin        *clientPins     = NULL;
+static pthread_mutex_t  clientLock      = PTHREAD_MUTEX_INITIALIZER;
+static gipydCommand     batch[GIPYD_MAX_BATCH];
+static int              batchSize       = -1; //-1 if no batch started
+static pirror           batchError      = GE_OK;
+
+
+//------------------------------------------------------------------------------
+// Pin functions (Same API as gipy.c)
+//------------------------------------------------------------------------------
+pirror GIPY_pinExport(int pPin){
+    dbgInfo("Try to enable pin %d (gipyd)", pPin);
+    return command(GIPYD_EXPORT, pPin, 0);
+}
+
+pirror GIPY_pinUnexport(int pPin){
+    dbgInfo("Try to disable pin %d (gipyd)", pPin);
+    return command(GIPYD_UNEXPORT, pPin, 0);
+}
+
+pirror GIPY_pinSetDirectionIn(int pPin){
+    return GIPY_pinSetDirection(pPin, IN);
+}
+
+pirror GIPY_pinSetDirectionOut(int pPin){
+    return GIPY_pinSetDirection(pPin, OUT);
+}
+
+pirror GIPY_pinSetDirectionLow(int pPin){
+    return GIPY_pinSetDirection(pPin, LOW);
+}
+
+pirror GIPY_pinSetDirectionHigh(int pPin){
+    return GIPY_pinSetDirection(pPin, HIGH);
+}
+
+pirror GIPY_pinSetDirection(int pPin, pinDirection pPinDir){
+    return command(GIPYD_DIRECTION, pPin, pPinDir);
+}
+
+pirror GIPY_pinSetEdgeNone(int pPin){
+    return GIPY_pinSetEdge(pPin, NONE);
+}
+
+pirror GIPY_pinSetEdgeRising(int pPin){
+    return GIPY_pinSetEdge(pPin, RISING);
+}
+
+pirror GIPY_pinSetEdgeFalling(int pPin){
+    return GIPY_pinSetEdge(pPin, FALLING);
+}
+
+pirror GIPY_pinSetEdgeBoth(int pPin){
+    return GIPY_pinSetEdge(pPin, BOTH);
+}
+
+pirror GIPY_pinSetEdge(int pPin, pinEdge pEdge){
+    pirror err = command(GIPYD_EDGE, pPin, pEdge);
+    if(err == GE_OK){
+        clientPins[getEntry(pPin)].edge = pEdge; //Edges are filtered here
+    }
+    return err;
+}
+
+pirror GIPY_pinRead(int pPin, int *pRead){
+    gipydPin copy;
+    if(connectDaemon() != GE_OK){
+        return GE_IO;
+    }
+    int index = getEntry(pPin);
+    if(index == -1){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    readEntry(index, &copy);
+    if(copy.exported == FALSE){
+        dbgError("Try to read from unexported pin %d", pPin);
+        return GE_PERM;
+    }
+    *pRead = copy.value;
+    return GE_OK;
+}
+
+pirror GIPY_pinWrite(int pPin, pinValue pValue){
+    if(pValue != LOGIC_ZERO && pValue != LOGIC_ONE){
+        dbgError("Invalid value (%d) for pin: %d", pValue, pPin);
+        return GE_PINVAL;
+    }
+    return command(GIPYD_WRITE, pPin, pValue);
+}
+
+pirror GIPY_pinCreateInterrupt(int pPin, void (*function)(void)){
+    gipydPin copy;
+    if(connectDaemon() != GE_OK){
+        return GE_IO;
+    }
+    int index = getEntry(pPin);
+    if(index == -1){
+        return GE_PIN;
+    }
+    readEntry(index, &copy);
+    if(copy.exported == FALSE){
+        dbgError("Try to set interrupt to unexported pin %d", pPin);
+        return GE_PERM;
+    }
+
+    //One thread per pin, kept till the program ends
+    pthread_mutex_lock(&clientLock);
+    clientPins[index].isr = function;
+    if(clientPins[index].isWaiting == FALSE){
+        pthread_t thread;
+        clientPins[index].isWaiting = TRUE;
+        pthread_create(&thread, NULL, &waitThread, (void *)(intptr_t)index);
+        pthread_detach(thread);
+    }
+    pthread_mutex_unlock(&clientLock);
+    return GE_OK;
+}
+
+
+//------------------------------------------------------------------------------
+// Batch functions
+//------------------------------------------------------------------------------
+pirror GIPY_batchBegin(void){
+    pthread_mutex_lock(&clientLock);
+    if(batchSize != -1){
+        pthread_mutex_unlock(&clientLock);
+        return GE_PERM;
+    }
+    batchSize   = 0;
+    batchError  = GE_OK;
+    pthread_mutex_unlock(&clientLock);
+    return GE_OK;
+}
+
+pirror GIPY_batchCommit(void){
+    int32_t results[GIPYD_MAX_BATCH];
+    int     k;
+
+    pthread_mutex_lock(&clientLock);
+    pirror err = batchError;
+    if(err == GE_OK && batchSize > 0){
+        err = sendCommands(batch, batchSize, results);
+        for(k=0; k<batchSize && err == GE_OK; k++){
+            err = results[k];
+        }
+    }
+    batchSize = -1;
+    pthread_mutex_unlock(&clientLock);
+    return err;
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static pirror connectDaemon(void){
+    if(__atomic_load_n(&state, __ATOMIC_ACQUIRE) != NULL){
+        return GE_OK;
+    }
+    const char *socketPath  = getenv(GIPYD_SOCKET_ENV);
+    const char *shmName     = getenv(GIPYD_SHM_ENV);
+    socketPath  = (socketPath != NULL) ? socketPath : GIPYD_SOCKET_PATH;
+    shmName     = (shmName != NULL) ? shmName : GIPYD_SHM_NAME;
+
+    pthread_mutex_lock(&clientLock);
+    if(state != NULL){
+        pthread_mutex_unlock(&clientLock);
+        return GE_OK;
+    }
+
+    //Command socket
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    daemonFd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if(daemonFd == -1 || connect(daemonFd, (struct sockaddr *)&address, sizeof(address)) == -1){
+        dbgError("Unable to connect to gipyd (%s)", socketPath);
+        if(daemonFd != -1){
+            close(daemonFd);
+            daemonFd = -1;
+        }
+        pthread_mutex_unlock(&clientLock);
+        return GE_IO;
+    }
+
+    //Shared state (Read only)
+    struct stat info;
+    gipydState  *map    = MAP_FAILED;
+    int         file    = shm_open(shmName, O_RDONLY, 0);
+    if(file != -1 && fstat(file, &info) == 0 && info.st_size >= (off_t)sizeof(gipydState)){
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, file, 0);
+    }
+    if(file != -1){
+        close(file);
+    }
+    if(map == MAP_FAILED || map->magic != GIPYD_MAGIC || map->version != GIPYD_VERSION
+            || info.st_size < (off_t)(sizeof(gipydState) + map->nbPins * sizeof(gipydPin))){
+        dbgError("Unable to map gipyd shared memory %s", shmName);
+        close(daemonFd);
+        daemonFd = -1;
+        pthread_mutex_unlock(&clientLock);
+        return GE_IO;
+    }
+    clientPins = calloc(map->nbPins, sizeof(clientPin));
+    if(clientPins == NULL){
+        munmap(map, info.st_size);
+        close(daemonFd);
+        daemonFd = -1;
+        pthread_mutex_unlock(&clientLock);
+        return GE_IO;
+    }
+    __atomic_store_n(&state, map, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&clientLock);
+    dbgInfo("Connected to gipyd (%u pins)", map->nbPins);
+    return GE_OK;
+}
+
+static pirror sendCommands(const gipydCommand *pCommands, int pNb, int32_t *pResults){
+    ssize_t size = pNb * sizeof(int32_t);
+    if(send(daemonFd, pCommands, pNb * sizeof(gipydCommand), MSG_NOSIGNAL) == -1
+            || recv(daemonFd, pResults, size, 0) != size){
+        dbgError("gipyd not reachable");
+        return GE_IO;
+    }
+    return GE_OK;
+}
+
+static pirror command(gipydOp pOp, int pPin, int pArg){
+    gipydCommand    cmd = {pOp, pPin, pArg};
+    int32_t         result;
+
+    if(connectDaemon() != GE_OK){
+        return GE_IO;
+    }
+    if(getEntry(pPin) == -1){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+    pthread_mutex_lock(&clientLock);
+    if(batchSize != -1){
+        if(batchSize == GIPYD_MAX_BATCH){
+            batchError = GE_PARAM; //Reported by the commit
+        }
+        else{
+            batch[batchSize++] = cmd;
+        }
+        pthread_mutex_unlock(&clientLock);
+        return GE_OK;
+    }
+    pirror err = sendCommands(&cmd, 1, &result);
+    pthread_mutex_unlock(&clientLock);
+    return (err == GE_OK) ? (pirror)result : err;
+}
+
+static int getEntry(int pPin){
+    //Entries are sorted by pin number
+    int first = 0, last = (int)state->nbPins - 1;
+    while(first <= last){
+        int middle = (first + last) / 2;
+        if(state->pins[middle].pin == pPin){
+            return middle;
+        }
+        if(state->pins[middle].pin < pPin){
+            first = middle + 1;
+        }
+        else{
+            last = middle - 1;
+        }
+    }
+    return -1;
+}
+
+static void readEntry(int pIndex, gipydPin *pCopy){
+    const gipydPin  *entry = &state->pins[pIndex];
+    uint32_t        seq;
+    do{
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        memcpy(pCopy, entry, sizeof(gipydPin));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    }while((seq & 1) || seq != __atomic_load_n(&entry->seq, __ATOMIC_RELAXED));
+}
+
+static void *waitThread(void *pIndex){
+    int             index   = (intptr_t)pIndex;
+    const gipydPin  *entry  = &state->pins[index];
+    struct timespec timeout = {0, 100 * NSEC_PER_MSEC};
+    uint32_t        events  = __atomic_load_n(&entry->events, __ATOMIC_ACQUIRE);
+    gipydPin        copy;
+    dbgInfo("Start interrupt thread for pin %d (gipyd)", entry->pin);
+
+    while(TRUE){
+        //Edges seen while busy are merged (As the kernel does)
+        syscall(SYS_futex, &entry->events, FUTEX_WAIT, events, &timeout, NULL, 0);
+        uint32_t now = __atomic_load_n(&entry->events, __ATOMIC_ACQUIRE);
+        if(now == events){
+            continue;
+        }
+        events = now;
+        readEntry(index, &copy);
+        pinEdge edge        = __atomic_load_n(&clientPins[index].edge, __ATOMIC_RELAXED);
+        void    (*isr)(void) = __atomic_load_n(&clientPins[index].isr, __ATOMIC_ACQUIRE);
+        if(isr != NULL && copy.exported == TRUE && (edge == BOTH
+                    || (edge == RISING && copy.value == 1)
+                    || (edge == FALLING && copy.value == 0))){
+            isr();
+        }
+    }
+    return NULL;
+}
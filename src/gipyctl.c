@@ -0,0 +1,485 @@
+/*
+ * ****************************************************************************
+ * GIPY Library
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ *
+ * gipyctl: command line tool for the GPIO (Replaces the tools scripts).
+ *      execGipyctl [-r sysfs root] [-S] <command> [parameters]
+ *  dump [-j] [pins]    State of the exported pins, or of the given ones.
+ *                      One pass on the sysfs root, no fork (-j for JSON).
+ *  watch [pins]        Print the edges of the pins till SIGINT / SIGTERM,
+ *                      through the event path (Edge hook). Pins without
+ *                      edge get both edges, restored at the end.
+ *  export <pins>       Export the pins (Pins exported before are adopted).
+ *  unexport <pins|all> Unexport the pins.
+ *  set <pins> <settings>
+ *                      Apply the settings in order to each pin: in, out,
+ *                      low, high (Direction), none, rising, falling, both
+ *                      (Edge), 0, 1 (Value).
+ *  save <file>         Save the configuration of the exported pins (Binary
+ *                      snapshot, see GIPY_snapshotCapture).
+ *  load <file>         Apply a saved configuration (Only the differences).
+ * Pins are a list of numbers and ranges: 17,18,20-23.
+ * -S runs on the simulated backend (With -r, the tree is kept).
+ * ****************************************************************************
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "gipy.h"
+#include "simul.h"
+
+
+// ****************************************************************************
+// Constants - General variable
+// ****************************************************************************
+#define CTL_MAX_PINS    1024 //Max pins of a command
+#define CTL_MAX_BLOB    (sizeof(snapshotHeader) + CTL_MAX_PINS * sizeof(pinSnapshot))
+
+/**
+ * @brief Describe one command
+ */
+typedef struct {
+    const char  *name;
+    int         (*run)(int, char**);
+} ctlCommand;
+
+int ctlDump(int, char**);
+int ctlWatch(int, char**);
+int ctlExport(int, char**);
+int ctlUnexport(int, char**);
+int ctlSet(int, char**);
+int ctlSave(int, char**);
+int ctlLoad(int, char**);
+
+static const ctlCommand commands[] = {
+    {"dump",        ctlDump},
+    {"watch",       ctlWatch},
+    {"export",      ctlExport},
+    {"unexport",    ctlUnexport},
+    {"set",         ctlSet},
+    {"save",        ctlSave},
+    {"load",        ctlLoad}
+};
+#define NB_COMMANDS (int)(sizeof(commands) / sizeof(commands[0]))
+
+static const char *directionNames[]  = {"in", "out", "low", "high"};
+static const char *edgeNames[]       = {"none", "rising", "falling", "both"};
+static const char *errorNames[]      = {"ok", "not permitted", "no entry", "io error",
+                                        "invalid parameter", "invalid pin",
+                                        "invalid direction", "invalid value"};
+
+static volatile sig_atomic_t isRunning = TRUE;
+
+
+// ****************************************************************************
+// Tools functions
+// ****************************************************************************
+/**
+ * @brief           Parse a list of pins (17,18,20-23)
+ *
+ * @param pText     Text to parse
+ * @param pPins     Filled with the pins
+ * @param pMax      Size of pPins
+ * @return          Number of pins, -1 if invalid list
+ */
+static int parsePins(const char *pText, int *pPins, int pMax){
+    int nb = 0;
+    while(*pText != '\0'){
+        char    *end;
+        long    first   = strtol(pText, &end, 10);
+        long    last    = first;
+        if(end == pText || first < 0){
+            return -1;
+        }
+        pText = end;
+        if(*pText == '-'){
+            last = strtol(pText + 1, &end, 10);
+            if(end == pText + 1 || last < first){
+                return -1;
+            }
+            pText = end;
+        }
+        for(; first <= last; first++){
+            if(nb == pMax){
+                return -1;
+            }
+            pPins[nb++] = (int)first;
+        }
+        if(*pText == ','){
+            pText++;
+        }
+        else if(*pText != '\0'){
+            return -1;
+        }
+    }
+    return nb;
+}
+
+/**
+ * @brief           Get the index of a name in a table
+ *
+ * @param pNames    Names table
+ * @param pNb       Number of names
+ * @param pName     Name to find
+ * @return          Index, -1 if not found
+ */
+static int findName(const char **pNames, int pNb, const char *pName){
+    int k;
+    for(k=0; k<pNb; k++){
+        if(strcmp(pNames[k], pName) == 0){
+            return k;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief           Display the error of a pin operation
+ *
+ * @param pAction   Operation done
+ * @param pPin      Pin number
+ * @param pErr      Error returned
+ * @return          TRUE if an error was displayed, otherwise FALSE
+ */
+static int checkError(const char *pAction, int pPin, pirror pErr){
+    if(pErr == GE_OK){
+        return FALSE;
+    }
+    printError(NULL, "Unable to %s pin %d (%s)", pAction, pPin,
+            (pErr <= GE_PINVAL) ? errorNames[pErr] : "unknown error");
+    return TRUE;
+}
+
+static void stopHandler(int pSignal){
+    (void)pSignal;
+    isRunning = FALSE;
+}
+
+/**
+ * @brief           Edge hook of the watched pins: one line per edge
+ */
+static void printEdge(int pPin, int pValue, uint64_t pStamp, void *pContext){
+    (void)pContext;
+    printf("%llu.%09llu %d %d\n", (unsigned long long)(pStamp / NSEC_PER_SEC),
+            (unsigned long long)(pStamp % NSEC_PER_SEC), pPin, pValue);
+}
+
+
+// ****************************************************************************
+// Commands
+// ****************************************************************************
+/**
+ * @brief   Display the state of the pins (Text table or JSON array)
+ */
+int ctlDump(int argc, char **argv){
+    static int  pins[CTL_MAX_PINS];
+    int         isJson  = (argc > 0 && strcmp(argv[0], "-j") == 0);
+    int         nb, k;
+
+    if(isJson == TRUE){
+        argc--;
+        argv++;
+    }
+    if(argc > 0){
+        nb = parsePins(argv[0], pins, CTL_MAX_PINS);
+    }
+    else{
+        nb = GIPY_pinListExported(pins, CTL_MAX_PINS);
+        nb = (nb > CTL_MAX_PINS) ? CTL_MAX_PINS : nb;
+    }
+    if(nb < 0){
+        printError(NULL, "Invalid pins: %s", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if(isJson == TRUE){
+        printf("[");
+    }
+    else{
+        printf("%-6s %-9s %-8s %s\n", "pin", "direction", "edge", "value");
+    }
+    for(k=0; k<nb; k++){
+        pinState state;
+        GIPY_pinGetState(pins[k], &state);
+        if(isJson == TRUE){
+            printf("%s\n  {\"pin\": %d, \"exported\": %s", (k > 0) ? "," : "", pins[k],
+                    (state.isExported == TRUE) ? "true" : "false");
+            if(state.isExported == TRUE){
+                printf(", \"direction\": \"%s\", \"edge\": \"%s\", \"value\": %d",
+                        directionNames[state.direction], edgeNames[state.edge], state.value);
+            }
+            printf("}");
+        }
+        else if(state.isExported == TRUE){
+            printf("%-6d %-9s %-8s %d\n", pins[k], directionNames[state.direction],
+                    edgeNames[state.edge], state.value);
+        }
+        else{
+            printf("%-6d not exported\n", pins[k]);
+        }
+    }
+    if(isJson == TRUE){
+        printf("%s]\n", (nb > 0) ? "\n" : "");
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief   Print the edges of the pins till SIGINT / SIGTERM
+ */
+int ctlWatch(int argc, char **argv){
+    static int      pins[CTL_MAX_PINS];
+    static pinEdge  edges[CTL_MAX_PINS]; //Edge before the watch
+    static int      wasExported[CTL_MAX_PINS];
+    int             nb, k;
+
+    if(argc > 0){
+        nb = parsePins(argv[0], pins, CTL_MAX_PINS);
+    }
+    else{
+        nb = GIPY_pinListExported(pins, CTL_MAX_PINS);
+        nb = (nb > CTL_MAX_PINS) ? CTL_MAX_PINS : nb;
+    }
+    if(nb <= 0){
+        printError(NULL, "No pin to watch");
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &stopHandler;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    //Exported pins are adopted: outputs keep their level
+    for(k=0; k<nb; k++){
+        pinState state;
+        GIPY_pinGetState(pins[k], &state);
+        wasExported[k]  = state.isExported;
+        edges[k]        = state.edge;
+        if(checkError("export", pins[k], GIPY_pinExport(pins[k])) == TRUE){
+            pins[k] = -1;
+            continue;
+        }
+        if(edges[k] == NONE){
+            checkError("set edge of", pins[k], GIPY_pinSetEdgeBoth(pins[k]));
+        }
+        GIPY_pinSetEdgeHook(pins[k], &printEdge, NULL);
+        checkError("watch", pins[k], GIPY_pinCreateInterrupt(pins[k], NULL));
+    }
+    while(isRunning == TRUE){
+        pause();
+    }
+
+    //Leave the pins as found
+    for(k=0; k<nb; k++){
+        if(pins[k] == -1){
+            continue;
+        }
+        GIPY_pinSetEdgeHook(pins[k], NULL, NULL);
+        if(wasExported[k] == FALSE){
+            GIPY_pinUnexport(pins[k]);
+        }
+        else if(edges[k] == NONE){
+            GIPY_pinSetEdgeNone(pins[k]);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief   Export the pins
+ */
+int ctlExport(int argc, char **argv){
+    static int  pins[CTL_MAX_PINS];
+    int         nb      = (argc > 0) ? parsePins(argv[0], pins, CTL_MAX_PINS) : -1;
+    int         status  = EXIT_SUCCESS;
+    int         k;
+
+    if(nb <= 0){
+        printError(NULL, "Usage: export <pins>");
+        return EXIT_FAILURE;
+    }
+    for(k=0; k<nb; k++){
+        if(checkError("export", pins[k], GIPY_pinExport(pins[k])) == TRUE){
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief   Unexport the pins (All the exported pins with 'all')
+ */
+int ctlUnexport(int argc, char **argv){
+    static int  pins[CTL_MAX_PINS];
+    int         status  = EXIT_SUCCESS;
+    int         nb      = -1;
+    int         k;
+
+    if(argc > 0 && strcmp(argv[0], "all") == 0){
+        nb = GIPY_pinListExported(pins, CTL_MAX_PINS);
+        nb = (nb > CTL_MAX_PINS) ? CTL_MAX_PINS : nb;
+    }
+    else if(argc > 0){
+        nb = parsePins(argv[0], pins, CTL_MAX_PINS);
+    }
+    if(nb < 0){
+        printError(NULL, "Usage: unexport <pins|all>");
+        return EXIT_FAILURE;
+    }
+
+    //Exported pins are adopted first (Unexport needs the library state)
+    for(k=0; k<nb; k++){
+        pirror err = GIPY_pinExport(pins[k]);
+        err = (err == GE_OK) ? GIPY_pinUnexport(pins[k]) : err;
+        if(checkError("unexport", pins[k], err) == TRUE){
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief   Apply the settings in order to each pin
+ */
+int ctlSet(int argc, char **argv){
+    static int  pins[CTL_MAX_PINS];
+    int         nb      = (argc > 1) ? parsePins(argv[0], pins, CTL_MAX_PINS) : -1;
+    int         status  = EXIT_SUCCESS;
+    int         k, s;
+
+    if(nb <= 0){
+        printError(NULL, "Usage: set <pins> <in|out|low|high|none|rising|falling|both|0|1>...");
+        return EXIT_FAILURE;
+    }
+    for(s=1; s<argc; s++){
+        if(findName(directionNames, 4, argv[s]) == -1 && findName(edgeNames, 4, argv[s]) == -1
+                && strcmp(argv[s], "0") != 0 && strcmp(argv[s], "1") != 0){
+            printError(NULL, "Invalid setting: %s", argv[s]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for(k=0; k<nb; k++){
+        pirror err = GIPY_pinExport(pins[k]);
+        for(s=1; s<argc && err == GE_OK; s++){
+            int direction   = findName(directionNames, 4, argv[s]);
+            int edge        = findName(edgeNames, 4, argv[s]);
+            if(direction != -1){
+                err = GIPY_pinSetDirection(pins[k], (pinDirection)direction);
+            }
+            else if(edge != -1){
+                err = GIPY_pinSetEdge(pins[k], (pinEdge)edge);
+            }
+            else{
+                err = GIPY_pinWrite(pins[k], (argv[s][0] == '1') ? LOGIC_ONE : LOGIC_ZERO);
+            }
+        }
+        if(checkError("set", pins[k], err) == TRUE){
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
+
+
+/**
+ * @brief   Save the configuration of the exported pins in a file
+ */
+int ctlSave(int argc, char **argv){
+    static uint8_t blob[CTL_MAX_BLOB];
+    if(argc < 1){
+        printError(NULL, "Usage: save <file>");
+        return EXIT_FAILURE;
+    }
+    GIPY_init(); //Adopt the exported pins
+    size_t size = GIPY_snapshotCapture(blob, sizeof(blob));
+    FILE *file = fopen(argv[0], "wb");
+    if(size > sizeof(blob) || file == NULL || fwrite(blob, 1, size, file) != size){
+        printError(NULL, "Unable to save the configuration in %s", argv[0]);
+        if(file != NULL){
+            fclose(file);
+        }
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+    printf("%u pins saved\n", ((snapshotHeader *)blob)->count);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief   Apply a configuration saved in a file
+ */
+int ctlLoad(int argc, char **argv){
+    static uint8_t blob[CTL_MAX_BLOB];
+    int changes = 0;
+    if(argc < 1){
+        printError(NULL, "Usage: load <file>");
+        return EXIT_FAILURE;
+    }
+    FILE *file = fopen(argv[0], "rb");
+    if(file == NULL){
+        printError(NULL, "Unable to open %s", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t size = fread(blob, 1, sizeof(blob), file);
+    fclose(file);
+    GIPY_init(); //Adopt the exported pins
+    pirror err = GIPY_snapshotRestore(blob, size, &changes);
+    printf("%d changes\n", changes);
+    if(err != GE_OK){
+        printError(NULL, "Unable to load %s (%s)", argv[0],
+                (err <= GE_PINVAL) ? errorNames[err] : "unknown error");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+
+// ****************************************************************************
+// Main function
+// ****************************************************************************
+int main(int argc, char **argv){
+    const char  *root       = NULL;
+    int         isSimul     = FALSE;
+    int         k, option;
+
+    while((option = getopt(argc, argv, "+r:S")) != -1){
+        switch(option){
+            case 'r': root = optarg; break;
+            case 'S': isSimul = TRUE; break;
+            default: argc = 0; break;
+        }
+    }
+    for(k=0; k<NB_COMMANDS && optind < argc; k++){
+        if(strcmp(commands[k].name, argv[optind]) != 0){
+            continue;
+        }
+        if(isSimul == TRUE && GIPY_simEnable(root, 1.0) != GE_OK){
+            printError(NULL, "Unable to enable the simulated backend");
+            return EXIT_FAILURE;
+        }
+        if(isSimul == FALSE && root != NULL && GIPY_setSysfsRoot(root) != GE_OK){
+            return EXIT_FAILURE;
+        }
+        return commands[k].run(argc - optind - 1, argv + optind + 1);
+    }
+    printf("Usage: %s [-r sysfs root] [-S] <command> [parameters]\n", argv[0]);
+    printf("    dump [-j] [pins]\n");
+    printf("    watch [pins]\n");
+    printf("    export <pins>\n");
+    printf("    unexport <pins|all>\n");
+    printf("    set <pins> <in|out|low|high|none|rising|falling|both|0|1>...\n");
+    printf("    save <file>\n");
+    printf("    load <file>\n");
+    printf("Pins: list of numbers and ranges (17,18,20-23)\n");
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,504 @@
+/*
+ * ****************************************************************************
+ * GIPY Library
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ *
+ * gipyd: daemon owning the GPIO for several processes (See gipyd.h).
+ *      execGipyd [-s socket] [-m shm name] [-r sysfs root] [-S] [-g pin:rate]
+ *  -S runs on the simulated backend, -g drives an edge stream on a pin
+ *  (Simulated backend only, may be repeated).
+ * Stops on SIGINT / SIGTERM: all pins are unexported.
+ * ****************************************************************************
+ */
+
+
+#include <signal.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "gipyd.h"
+#include "simul.h"
+
+
+// ****************************************************************************
+// Constants - General variable
+// ****************************************************************************
+
+/**
+ * @brief Connected client and the pins it holds
+ */
+typedef struct {
+    int         fd;     //-1 if free
+    uint8_t     *holds; //TRUE for each pin entry held by the client
+} gipydClient;
+
+static gipydState       *state          = NULL;
+static size_t           stateSize       = 0;
+static int              *holders        = NULL; //Number of clients per pin
+static int              *watched        = NULL; //TRUE if interrupt running
+static gipydClient      clients[GIPYD_MAX_CLIENTS];
+static pthread_mutex_t  publishLock     = PTHREAD_MUTEX_INITIALIZER;
+static volatile sig_atomic_t isRunning  = TRUE;
+
+
+// ****************************************************************************
+// Shared state functions
+// ****************************************************************************
+/**
+ * @brief           Start writing a pin entry (Readers will retry)
+ *
+ * @param pEntry    Entry to write
+ */
+static void beginWrite(gipydPin *pEntry){
+    pthread_mutex_lock(&publishLock); //Interrupt threads and commands
+    __atomic_store_n(&pEntry->seq, pEntry->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief           End writing a pin entry
+ *
+ * @param pEntry    Written entry
+ */
+static void endWrite(gipydPin *pEntry){
+    __atomic_store_n(&pEntry->seq, pEntry->seq + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&publishLock);
+}
+
+/**
+ * @brief           Publish a new level (And edge if pIsEdge)
+ *
+ * @param pEntry    Pin entry
+ * @param pValue    New level
+ * @param pStamp    Edge timestamp
+ * @param pIsEdge   TRUE to count an edge and wake the waiting clients
+ */
+static void publishValue(gipydPin *pEntry, int pValue, uint64_t pStamp, int pIsEdge){
+    beginWrite(pEntry);
+    pEntry->value = (uint8_t)pValue;
+    if(pIsEdge == TRUE){
+        pEntry->edges++;
+        pEntry->lastEdge = pStamp;
+        __atomic_store_n(&pEntry->events, pEntry->events + 1, __ATOMIC_RELAXED);
+    }
+    endWrite(pEntry);
+    if(pIsEdge == TRUE){
+        syscall(SYS_futex, &pEntry->events, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+/**
+ * @brief   Edge hook of the watched inputs (Context is the pin entry)
+ */
+static void edgeHook(int pPin, int pValue, uint64_t pStamp, void *pContext){
+    publishValue((gipydPin *)pContext, pValue, pStamp, TRUE);
+}
+
+/**
+ * @brief           Create the shared memory region (One entry per pin slot)
+ *
+ * @param pName     Shared memory name
+ * @return          GE_OK if no error, otherwise GE_IO
+ */
+static pirror openState(const char *pName){
+    static const int defaultPins[NB_PINS] = {PINS_AVAILABLE};
+    int nbPins  = gipyPinSlotCount();
+    stateSize   = sizeof(gipydState) + nbPins * sizeof(gipydPin);
+
+    int file = shm_open(pName, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if(file == -1 || ftruncate(file, stateSize) == -1){
+        printError(NULL, "Unable to create shared memory %s", pName);
+        return GE_IO;
+    }
+    state = mmap(NULL, stateSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+    holders = calloc(nbPins, sizeof(int));
+    watched = calloc(nbPins, sizeof(int));
+    if(state == MAP_FAILED || holders == NULL || watched == NULL){
+        printError(NULL, "Unable to map shared memory %s", pName);
+        return GE_IO;
+    }
+
+    //Entries are in slot order, which is the pin numbers order
+    int         nbChips = GIPY_getChips(NULL, 0);
+    gpioChip    *chips  = malloc((nbChips > 0 ? nbChips : 1) * sizeof(gpioChip));
+    int         k, n;
+    if(chips == NULL){
+        return GE_IO;
+    }
+    GIPY_getChips(chips, nbChips);
+    for(k=0; k<nbChips; k++){
+        for(n=0; n<chips[k].ngpio; n++){
+            int slot = gipyPinSlot(chips[k].base + n);
+            if(slot != -1){
+                state->pins[slot].pin = chips[k].base + n;
+            }
+        }
+    }
+    for(k=0; k<NB_PINS && nbChips == 0; k++){
+        state->pins[gipyPinSlot(defaultPins[k])].pin = defaultPins[k];
+    }
+    free(chips);
+    state->nbPins   = nbPins;
+    state->pid      = getpid();
+    state->version  = GIPYD_VERSION;
+    __atomic_store_n(&state->magic, GIPYD_MAGIC, __ATOMIC_RELEASE);
+    return GE_OK;
+}
+
+
+// ****************************************************************************
+// Command functions
+// ****************************************************************************
+/**
+ * @brief           Unexport a pin no more held by any client
+ *
+ * @param pSlot     Pin entry
+ */
+static void releasePin(int pSlot){
+    gipydPin *entry = &state->pins[pSlot];
+    GIPY_pinSetEdgeNone(entry->pin);
+    GIPY_pinSetEdgeHook(entry->pin, NULL, NULL);
+    GIPY_pinUnexport(entry->pin); //Interrupt thread stops with the value file
+    watched[pSlot] = FALSE;
+
+    beginWrite(entry);
+    entry->exported     = FALSE;
+    entry->direction    = IN;
+    entry->value        = 0;
+    entry->edges        = 0;
+    endWrite(entry);
+}
+
+/**
+ * @brief           Set the direction of a pin and watch it if input
+ *
+ * @param pSlot     Pin entry
+ * @param pDir      New direction
+ * @return          Error of the library call
+ */
+static pirror setDirection(int pSlot, pinDirection pDir){
+    gipydPin    *entry  = &state->pins[pSlot];
+    int         value   = (pDir == HIGH) ? 1 : 0;
+    pirror      err;
+
+    if(pDir != IN){
+        GIPY_pinSetEdgeNone(entry->pin); //Watched only as input
+    }
+    err = GIPY_pinSetDirection(entry->pin, pDir);
+    if(err != GE_OK){
+        return err;
+    }
+    if(pDir == IN){
+        err = GIPY_pinSetEdgeBoth(entry->pin);
+        GIPY_pinSetEdgeHook(entry->pin, &edgeHook, entry);
+        if(err == GE_OK && watched[pSlot] == FALSE){
+            err = GIPY_pinCreateInterrupt(entry->pin, NULL);
+            watched[pSlot] = (err == GE_OK) ? TRUE : FALSE;
+        }
+    }
+    if(pDir == IN || pDir == OUT){
+        GIPY_pinRead(entry->pin, &value);
+    }
+
+    beginWrite(entry);
+    entry->direction    = (pDir == IN) ? IN : OUT;
+    entry->value        = (uint8_t)value;
+    endWrite(entry);
+    return err;
+}
+
+/**
+ * @brief           Execute one command of a client
+ *
+ * @param pClient   Client sending the command
+ * @param pCommand  Command to execute
+ * @return          Result (pirror)
+ */
+static int32_t execute(gipydClient *pClient, const gipydCommand *pCommand){
+    int     slot = gipyPinSlot(pCommand->pin);
+    pirror  err;
+
+    if(slot == -1){
+        return GE_PIN;
+    }
+    gipydPin *entry = &state->pins[slot];
+
+    switch(pCommand->op){
+        case GIPYD_EXPORT:
+            if(pClient->holds[slot] == TRUE){
+                return GE_OK;
+            }
+            if(holders[slot] == 0){
+                err = GIPY_pinExport(entry->pin);
+                if(err != GE_OK){
+                    return err;
+                }
+                //Adopted output (Previous run) is kept as it is: no glitch
+                pinState pin;
+                if(GIPY_pinGetState(entry->pin, &pin) == GE_OK && pin.direction == OUT){
+                    beginWrite(entry);
+                    entry->exported     = TRUE;
+                    entry->direction    = OUT;
+                    entry->value        = (uint8_t)((pin.value == 1) ? 1 : 0);
+                    endWrite(entry);
+                }
+                else{
+                    beginWrite(entry);
+                    entry->exported = TRUE;
+                    endWrite(entry);
+                    setDirection(slot, IN); //Default direction is watched
+                }
+            }
+            pClient->holds[slot] = TRUE;
+            holders[slot]++;
+            return GE_OK;
+
+        case GIPYD_UNEXPORT:
+            if(pClient->holds[slot] == FALSE){
+                return GE_PERM;
+            }
+            pClient->holds[slot] = FALSE;
+            if(--holders[slot] == 0){
+                releasePin(slot);
+            }
+            return GE_OK;
+
+        case GIPYD_DIRECTION:
+            if(pClient->holds[slot] == FALSE){
+                return GE_PERM;
+            }
+            if(pCommand->arg < IN || pCommand->arg > HIGH){
+                return GE_PINDIR;
+            }
+            return setDirection(slot, pCommand->arg);
+
+        case GIPYD_EDGE:
+            if(pClient->holds[slot] == FALSE){
+                return GE_PERM;
+            }
+            //Inputs are always watched on both edges, clients filter
+            return (pCommand->arg >= NONE && pCommand->arg <= BOTH) ? GE_OK : GE_PARAM;
+
+        case GIPYD_WRITE:
+            if(pClient->holds[slot] == FALSE){
+                return GE_PERM;
+            }
+            err = GIPY_pinWrite(entry->pin, pCommand->arg);
+            if(err == GE_OK){
+                publishValue(entry, pCommand->arg, 0, FALSE);
+            }
+            return err;
+    }
+    return GE_PARAM;
+}
+
+/**
+ * @brief           Disconnect a client and drop its holds
+ *
+ * @param pClient   Client to drop
+ */
+static void dropClient(gipydClient *pClient){
+    int k;
+    for(k=0; k<(int)state->nbPins; k++){
+        if(pClient->holds[k] == TRUE){
+            pClient->holds[k] = FALSE;
+            if(--holders[k] == 0){
+                releasePin(k);
+            }
+        }
+    }
+    close(pClient->fd);
+    free(pClient->holds);
+    pClient->fd     = -1;
+    pClient->holds  = NULL;
+}
+
+/**
+ * @brief           Receive a batch from a client and send the results
+ *
+ * @param pClient   Client with a pending message
+ */
+static void serveClient(gipydClient *pClient){
+    gipydCommand    commands[GIPYD_MAX_BATCH];
+    int32_t         results[GIPYD_MAX_BATCH];
+    int             k;
+
+    ssize_t len = recv(pClient->fd, commands, sizeof(commands), 0);
+    if(len <= 0){
+        dbgInfo("Client %d disconnected", pClient->fd);
+        dropClient(pClient);
+        return;
+    }
+    int nbCommands = len / sizeof(gipydCommand);
+    for(k=0; k<nbCommands; k++){
+        results[k] = execute(pClient, &commands[k]);
+    }
+    if(send(pClient->fd, results, nbCommands * sizeof(int32_t), MSG_NOSIGNAL) == -1){
+        dropClient(pClient);
+    }
+}
+
+/**
+ * @brief           Create the listening socket
+ *
+ * @param pPath     Socket path (Removed first if it exists)
+ * @return          Socket, -1 if error
+ */
+static int openSocket(const char *pPath){
+    struct sockaddr_un address;
+    if(strlen(pPath) >= sizeof(address.sun_path)){
+        printError(NULL, "Socket path too long: %s", pPath);
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, pPath);
+    unlink(pPath);
+
+    //Created with GIPYD_SOCKET_MODE (Connecting needs write access)
+    int     fd      = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    mode_t  mask    = umask(~GIPYD_SOCKET_MODE & 0777);
+    int     res     = (fd == -1) ? -1 : bind(fd, (struct sockaddr *)&address, sizeof(address));
+    umask(mask);
+    if(res == -1 || listen(fd, GIPYD_MAX_CLIENTS) == -1){
+        printError(NULL, "Unable to listen on %s", pPath);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief   Stop the main loop (SIGINT / SIGTERM)
+ */
+static void stopHandler(int pSignal){
+    isRunning = FALSE;
+}
+
+
+// ****************************************************************************
+// Main function
+// ****************************************************************************
+/**
+ * Main function
+ */
+int main(int argc, char **argv){
+    const char  *socketPath = getenv(GIPYD_SOCKET_ENV);
+    const char  *shmName    = getenv(GIPYD_SHM_ENV);
+    const char  *root       = NULL;
+    int         isSimul     = FALSE;
+    int         k, option;
+
+    socketPath  = (socketPath != NULL) ? socketPath : GIPYD_SOCKET_PATH;
+    shmName     = (shmName != NULL) ? shmName : GIPYD_SHM_NAME;
+    while((option = getopt(argc, argv, "s:m:r:Sg:")) != -1){
+        switch(option){
+            case 's': socketPath = optarg; break;
+            case 'm': shmName = optarg; break;
+            case 'r': root = optarg; break;
+            case 'S': isSimul = TRUE; break;
+            case 'g': break; //Once the simulator is enabled
+            default:
+                printf("Usage: %s [-s socket] [-m shm] [-r sysfs root] [-S] [-g pin:rate]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    //Backend
+    if(isSimul == TRUE && GIPY_simEnable(root, 1.0) != GE_OK){
+        printError(NULL, "Unable to enable the simulated backend");
+        return EXIT_FAILURE;
+    }
+    if(isSimul == FALSE && root != NULL && GIPY_setSysfsRoot(root) != GE_OK){
+        return EXIT_FAILURE;
+    }
+    optind = 1;
+    while((option = getopt(argc, argv, "s:m:r:Sg:")) != -1){
+        int     pin;
+        double  rate;
+        if(option != 'g'){
+            continue;
+        }
+        if(sscanf(optarg, "%d:%lf", &pin, &rate) != 2){
+            printError(NULL, "Invalid stream %s (Expected pin:rate)", optarg);
+            continue;
+        }
+        simStream stream = {SIM_FIXED, rate, 0, 0.0, 0, 0};
+        if(GIPY_simSetStream(pin, &stream) != GE_OK){
+            printError(NULL, "Unable to drive pin %d (-S required)", pin);
+        }
+    }
+
+    //Shared state and socket
+    int listenFd = -1;
+    if(GIPY_init() != GE_OK || openState(shmName) != GE_OK
+            || (listenFd = openSocket(socketPath)) == -1){
+        shm_unlink(shmName);
+        return EXIT_FAILURE;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &stopHandler; //No SA_RESTART: poll is interrupted
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    for(k=0; k<GIPYD_MAX_CLIENTS; k++){
+        clients[k].fd = -1;
+    }
+    printf("gipyd: %u pins, socket %s, shared memory %s\n", state->nbPins, socketPath, shmName);
+
+    //Main loop: new clients and command batches
+    while(isRunning == TRUE){
+        struct pollfd   fds[GIPYD_MAX_CLIENTS + 1];
+        int             owners[GIPYD_MAX_CLIENTS + 1];
+        int             nbFds = 1;
+        fds[0].fd       = listenFd;
+        fds[0].events   = POLLIN;
+        for(k=0; k<GIPYD_MAX_CLIENTS; k++){
+            if(clients[k].fd != -1){
+                fds[nbFds].fd       = clients[k].fd;
+                fds[nbFds].events   = POLLIN;
+                owners[nbFds++]     = k;
+            }
+        }
+        if(poll(fds, nbFds, -1) <= 0){
+            continue; //Signal
+        }
+        for(k=1; k<nbFds; k++){
+            if(fds[k].revents != 0){
+                serveClient(&clients[owners[k]]);
+            }
+        }
+        if(fds[0].revents & POLLIN){
+            int fd = accept(listenFd, NULL, NULL);
+            for(k=0; k<GIPYD_MAX_CLIENTS && fd != -1; k++){
+                if(clients[k].fd == -1){
+                    clients[k].holds = calloc(state->nbPins, sizeof(uint8_t));
+                    clients[k].fd = (clients[k].holds != NULL) ? fd : -1;
+                    break;
+                }
+            }
+            if(fd != -1 && (k == GIPYD_MAX_CLIENTS || clients[k].fd == -1)){
+                close(fd); //Too many clients
+            }
+            dbgInfo("Client %d connected", fd);
+        }
+    }
+
+    //Release all pins
+    printf("gipyd: stopping\n");
+    for(k=0; k<GIPYD_MAX_CLIENTS; k++){
+        if(clients[k].fd != -1){
+            dropClient(&clients[k]);
+        }
+    }
+    close(listenFd);
+    unlink(socketPath);
+    munmap(state, stateSize);
+    shm_unlink(shmName);
+    if(isSimul == TRUE){
+        GIPY_simDisable();
+    }
+    return EXIT_SUCCESS;
+}
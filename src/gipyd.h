@@ -0,0 +1,137 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Daemon
+ * Protocol between gipyd (GPIO owner) and its clients
+ *
+ * OWNERSHIP
+ * gipyd is the only process using the GPIO. Clients export pins through it:
+ * a pin stays exported while one client at least holds it (A client
+ * unexporting a pin only drops its own hold). Holds of a client are
+ * dropped when it disconnects.
+ *
+ * SHARED STATE
+ * gipyd publishes the state of every pin (Exported, direction, level and
+ * edge counter) in a shared memory region (gipydState). Each entry is
+ * guarded by a seqlock: clients read it without lock or syscall, and retry
+ * if the daemon wrote the entry meanwhile. Inputs are watched on both
+ * edges by the daemon. The 'events' word of an entry is incremented on
+ * each edge and is a futex: clients wait on it for their interrupts.
+ *
+ * COMMANDS
+ * Outputs and configuration go through a local Unix socket (SOCK_SEQPACKET),
+ * created with GIPYD_SOCKET_MODE: only the owner and group of gipyd (The
+ * gpio group...) can connect.
+ * One message is a batch of gipydCommand, the reply is one int32_t result
+ * (pirror) per command, in the same order.
+ *
+ * CLIENT SHIM
+ * gipyc.c implements the pin functions of gipy.h (Export, direction, edge,
+ * read, write, interrupt) on top of gipyd: link it instead of the library
+ * and programs run unchanged. Reads come from the shared state.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_GIPYD_H_
+#define _HEADER_GIPYD_H_
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gipy.h"
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define GIPYD_SOCKET_PATH   "/tmp/gipyd.sock"   //Default socket
+#define GIPYD_SOCKET_ENV    "GIPYD_SOCKET"      //Env var to change the socket
+#define GIPYD_SOCKET_MODE   0660                //Socket access: owner and group only
+#define GIPYD_SHM_NAME      "/gipyd"            //Default shared memory name
+#define GIPYD_SHM_ENV       "GIPYD_SHM"         //Env var to change the name
+#define GIPYD_MAGIC         0x47495059          //"GIPY"
+#define GIPYD_VERSION       1
+#define GIPYD_MAX_BATCH     64                  //Max commands per message
+#define GIPYD_MAX_CLIENTS   32
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Published state of a pin (Written by gipyd only)
+ */
+typedef struct {
+    uint32_t    seq;        //Seqlock: odd while the entry is written
+    uint32_t    events;     //Edge counter (32 bits), futex word
+    int32_t     pin;        //Pin number
+    uint8_t     exported;   //TRUE if exported by gipyd
+    uint8_t     direction;  //IN or OUT (pinDirection)
+    uint8_t     value;      //Input level, or last written output value
+    uint8_t     reserved;
+    uint64_t    edges;      //Edges seen since export
+    uint64_t    lastEdge;   //Timestamp of the last edge (gipyd clock, ns)
+} gipydPin;
+
+/**
+ * \brief Shared memory region. One entry per pin, sorted by pin number
+ */
+typedef struct {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    nbPins;
+    uint32_t    pid;        //gipyd process
+    gipydPin    pins[];
+} gipydState;
+
+/**
+ * \brief Describe the commands
+ */
+typedef enum {
+    GIPYD_EXPORT,           //Hold the pin (Exported on first hold)
+    GIPYD_UNEXPORT,         //Drop the hold (Unexported on last hold)
+    GIPYD_DIRECTION,        //arg is a pinDirection
+    GIPYD_EDGE,             //arg is a pinEdge (Checked only, see gipyc.c)
+    GIPYD_WRITE             //arg is a pinValue
+} gipydOp;
+
+/**
+ * \brief One command of a batch
+ */
+typedef struct {
+    int32_t     op;         //gipydOp
+    int32_t     pin;
+    int32_t     arg;
+} gipydCommand;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Client batch functions (gipyc.c)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Start a batch of commands
+ * \details         Next export, unexport, direction, edge and write calls
+ *                  are queued (And return GE_OK) till the commit.
+ *
+ * \return GE_OK    If no error
+ * \return GE_PERM  If a batch is already started
+ */
+pirror GIPY_batchBegin(void);
+
+/**
+ * \brief           Send the queued commands in one message
+ *
+ * \return GE_OK    If all commands succeeded
+ * \return          Otherwise, the error of the first failed command
+ *                  (GE_IO if gipyd is not reachable)
+ */
+pirror GIPY_batchCommit(void);
+
+#endif
+
@@ -0,0 +1,30 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY C++ Header compile check
+ * Instantiates every part of gipy.hpp: built by the makefile so that the
+ * header keeps compiling (C++17, no warnings). Not linked in any program.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "gipy.hpp"
+
+/**
+ * \brief   Uses each Pin member with each board profile
+ */
+int gipyhppCheck(){
+    gipy::Pin<17, gipy::Out>                        led;
+    gipy::Pin<529, gipy::In, gipy::RaspberryPi512>  button;
+    gipy::Pin<27, gipy::OutHigh, gipy::RaspberryPiB> relay;
+    gipy::Pin<600, gipy::In, gipy::AnyBoard>        expander;
+
+    int count = 0;
+    led.write(button.read() == 1);
+    led.toggle();
+    relay.write(false);
+    button.onEdge(BOTH, [&count](int, uint64_t){ count++; });
+    expander.onEdge(RISING, [](int pValue, uint64_t pStamp){ (void)pValue; (void)pStamp; });
+    return (led && button && relay && expander.status() == GE_OK) ? count : -1;
+}
@@ -0,0 +1,235 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Keypad
+ * Matrix keypad scanner engine
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "keypad.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Scan thread. One scan every 1/scanRate
+ */
+static void *scanThread(void*);
+
+/**
+ * \brief   Read the raw matrix (One bit per key, not debounced)
+ *
+ * \param   pKeypad Opened keypad
+ * \param   pRaw    Filled with the raw matrix
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror scanMatrix(keypad*, uint64_t*);
+
+/**
+ * \brief   Check whether the raw matrix has ghost keys
+ * \details Two rows sharing two columns or more can not be resolved
+ */
+static int hasGhost(const keypad*, uint64_t);
+
+/**
+ * \brief   Debounce the raw matrix and queue the events
+ */
+static void debounce(keypad*, uint64_t, uint64_t);
+
+#define KEY_BIT(row, col) (1ULL << ((row) * KEYPAD_MAX_LINES + (col)))
+#define ROW_BITS(raw, row) (((raw) >> ((row) * KEYPAD_MAX_LINES)) & 0xFF)
+
+
+//------------------------------------------------------------------------------
+// Keypad functions
+//------------------------------------------------------------------------------
+pirror GIPY_keypadOpen(keypad *pKeypad, const keypadConfig *pConfig){
+    dbgInfo("Try to open keypad");
+    if(pKeypad == NULL || pConfig == NULL
+            || pConfig->nbRows < 1 || pConfig->nbRows > KEYPAD_MAX_LINES
+            || pConfig->nbCols < 1 || pConfig->nbCols > KEYPAD_MAX_LINES
+            || pConfig->scanRate == 0 || pConfig->debounce < 1
+            || pConfig->debounce > 255){
+        dbgError("Invalid keypad configuration");
+        return GE_PARAM;
+    }
+    memset(pKeypad, 0, sizeof(keypad));
+    pKeypad->config = *pConfig;
+
+    //Rows start inactive, columns are inputs
+    pirror  err = GE_OK;
+    int     k;
+    for(k=0; k<pConfig->nbRows && err == GE_OK; k++){
+        err = GIPY_pinSetDirection(pConfig->rows[k], (pConfig->activeLow) ? HIGH : LOW);
+    }
+    for(k=0; k<pConfig->nbCols && err == GE_OK; k++){
+        err = GIPY_pinSetDirectionIn(pConfig->cols[k]);
+    }
+    if(err != GE_OK){
+        dbgError("Unable to configure keypad pins");
+        return err;
+    }
+    err = GIPY_bankOpen(&pKeypad->rowBank, pConfig->rows, pConfig->nbRows);
+    if(err != GE_OK){
+        return err;
+    }
+    err = GIPY_bankOpen(&pKeypad->colBank, pConfig->cols, pConfig->nbCols);
+    if(err == GE_OK){
+        err = GIPY_queueInit(&pKeypad->events, sizeof(keyEvent), KEYPAD_QUEUE_SIZE);
+        if(err != GE_OK){
+            GIPY_bankClose(&pKeypad->colBank);
+        }
+    }
+    if(err != GE_OK){
+        GIPY_bankClose(&pKeypad->rowBank);
+        return err;
+    }
+
+    pKeypad->running = TRUE;
+    pthread_create(&pKeypad->thread, NULL, &scanThread, pKeypad);
+    dbgInfo("Keypad opened (%dx%d, %u scans/s)", pConfig->nbRows, pConfig->nbCols,
+            pConfig->scanRate);
+    return GE_OK;
+}
+
+void GIPY_keypadClose(keypad *pKeypad){
+    __atomic_store_n(&pKeypad->running, FALSE, __ATOMIC_RELEASE);
+    pthread_join(pKeypad->thread, NULL);
+    GIPY_bankClose(&pKeypad->rowBank);
+    GIPY_bankClose(&pKeypad->colBank);
+    GIPY_queueFree(&pKeypad->events);
+}
+
+int GIPY_keypadGetEvent(keypad *pKeypad, keyEvent *pEvent){
+    return GIPY_queuePop(&pKeypad->events, pEvent);
+}
+
+int GIPY_keypadIsDown(keypad *pKeypad, int pRow, int pCol){
+    if(pRow < 0 || pRow >= KEYPAD_MAX_LINES || pCol < 0 || pCol >= KEYPAD_MAX_LINES){
+        return FALSE;
+    }
+    uint64_t keys = __atomic_load_n(&pKeypad->keys, __ATOMIC_ACQUIRE);
+    return (keys & KEY_BIT(pRow, pCol)) ? TRUE : FALSE;
+}
+
+
+//------------------------------------------------------------------------------
+// Scan functions
+//------------------------------------------------------------------------------
+static void *scanThread(void *pKeypad){
+    keypad      *kp     = (keypad *)pKeypad;
+    uint64_t    period  = NSEC_PER_SEC / kp->config.scanRate;
+    uint64_t    next    = GIPY_clockNow();
+    dbgInfo("Start keypad scan thread");
+
+    while(__atomic_load_n(&kp->running, __ATOMIC_ACQUIRE) == TRUE){
+        uint64_t raw;
+        if(scanMatrix(kp, &raw) == GE_OK){
+            debounce(kp, raw, next);
+        }
+        kp->scans++;
+
+        //Fixed rate: the next scan time does not drift with the scan duration
+        next += period;
+        uint64_t now = GIPY_clockNow();
+        if(next > now){
+            GIPY_clockSleep(next - now);
+        }
+        else{
+            next = now; //Late, do not try to catch up
+        }
+    }
+    dbgInfo("Keypad scan thread stopped");
+    return NULL;
+}
+
+static pirror scanMatrix(keypad *pKeypad, uint64_t *pRaw){
+    keypadConfig    *cfg        = &pKeypad->config;
+    uint32_t        rowsMask    = (1U << cfg->nbRows) - 1;
+    uint32_t        colsMask    = (1U << cfg->nbCols) - 1;
+    uint32_t        inactive    = (cfg->activeLow) ? rowsMask : 0;
+    uint32_t        cols;
+    uint64_t        raw         = 0;
+    int             k;
+
+    //Nothing in progress: all rows at once, one read tells if a key is down
+    if(pKeypad->keys == 0 && pKeypad->debouncing == 0){
+        if(GIPY_bankWrite(&pKeypad->rowBank, rowsMask, inactive ^ rowsMask) != GE_OK
+                || GIPY_bankRead(&pKeypad->colBank, colsMask, &cols) != GE_OK){
+            return GE_IO;
+        }
+        cols = (cfg->activeLow) ? ~cols & colsMask : cols;
+        if(cols == 0){
+            *pRaw = 0;
+            return GE_OK;
+        }
+    }
+
+    //Row by row (Only the rows which change are written)
+    for(k=0; k<cfg->nbRows; k++){
+        if(GIPY_bankWrite(&pKeypad->rowBank, rowsMask, inactive ^ (1U << k)) != GE_OK
+                || GIPY_bankRead(&pKeypad->colBank, colsMask, &cols) != GE_OK){
+            return GE_IO;
+        }
+        cols = (cfg->activeLow) ? ~cols & colsMask : cols;
+        raw |= (uint64_t)cols << (k * KEYPAD_MAX_LINES);
+    }
+    *pRaw = raw;
+    return GE_OK;
+}
+
+static int hasGhost(const keypad *pKeypad, uint64_t pRaw){
+    int r1, r2;
+    for(r1=0; r1<pKeypad->config.nbRows; r1++){
+        for(r2=r1+1; r2<pKeypad->config.nbRows; r2++){
+            if(__builtin_popcount(ROW_BITS(pRaw, r1) & ROW_BITS(pRaw, r2)) >= 2){
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+static void debounce(keypad *pKeypad, uint64_t pRaw, uint64_t pStamp){
+    uint64_t keys = pKeypad->keys;
+
+    //Ghost keys: the matrix can not be trusted, keep the current state
+    if(pKeypad->config.hasDiodes == FALSE && hasGhost(pKeypad, pRaw)){
+        pKeypad->ghosts++;
+        return;
+    }
+
+    //Only the keys changed or being debounced are checked
+    uint64_t changed    = pRaw ^ keys;
+    uint64_t todo       = changed | pKeypad->debouncing;
+    while(todo != 0){
+        int         k   = __builtin_ctzll(todo);
+        uint64_t    bit = 1ULL << k;
+        todo &= ~bit;
+        if((changed & bit) == 0){
+            pKeypad->counters[k]    = 0; //Raw level back to the stable one
+            pKeypad->debouncing     &= ~bit;
+            continue;
+        }
+        pKeypad->debouncing |= bit;
+        if(++pKeypad->counters[k] < pKeypad->config.debounce){
+            continue;
+        }
+
+        //Stable change: new state and event
+        keyEvent event;
+        pKeypad->counters[k]    = 0;
+        pKeypad->debouncing     &= ~bit;
+        keys                    ^= bit;
+        event.stamp             = pStamp;
+        event.row               = k / KEYPAD_MAX_LINES;
+        event.col               = k % KEYPAD_MAX_LINES;
+        event.isDown            = (keys & bit) ? TRUE : FALSE;
+        GIPY_queuePush(&pKeypad->events, &event);
+    }
+    __atomic_store_n(&pKeypad->keys, keys, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,140 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Keypad
+ * Matrix keypad scanner engine
+ *
+ * SCAN
+ * Rows are outputs, columns are inputs. A scan thread drives one row at a
+ * time to the active level and reads all columns with one bank read (See
+ * bank.h). While no key is down, all rows are driven at once and the
+ * columns are read once: an idle scan costs one bank read.
+ * Rows are push-pull outputs: use diodes (Or series resistors) if several
+ * keys of the same column can be pushed together.
+ *
+ * DEBOUNCE AND ROLLOVER
+ * A key changes state after 'debounce' consecutive scans with the same
+ * raw level. Without diodes, three keys on the corners of a rectangle make
+ * the fourth one look pushed (Ghost key): these scans are ignored and
+ * counted, the keys keep their previous state.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_KEYPAD_H_
+#define _HEADER_KEYPAD_H_
+
+#include "gipy.h"
+#include "bank.h"
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define KEYPAD_MAX_LINES    8 //Max rows and max columns
+#define KEYPAD_QUEUE_SIZE   64
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Keypad configuration
+ */
+typedef struct {
+    int         nbRows;
+    int         nbCols;
+    int         rows[KEYPAD_MAX_LINES];
+    int         cols[KEYPAD_MAX_LINES];
+    int         activeLow;  //TRUE: rows driven low, pushed key reads 0
+    int         hasDiodes;  //TRUE if the matrix has diodes (No ghost key)
+    uint32_t    scanRate;   //Scans per second
+    int         debounce;   //Consecutive scans before a key changes state
+} keypadConfig;
+
+/**
+ * \brief Key event delivered through the keypad queue
+ */
+typedef struct {
+    uint64_t    stamp;      //Scan time (Library clock)
+    uint8_t     row;
+    uint8_t     col;
+    uint8_t     isDown;     //TRUE for key down, FALSE for key up
+} keyEvent;
+
+/**
+ * \brief Keypad engine. Bit (row * KEYPAD_MAX_LINES + col) is one key
+ */
+typedef struct {
+    keypadConfig    config;
+    pinBank         rowBank;
+    pinBank         colBank;
+    eventQueue      events;
+    uint64_t        keys;       //Debounced state (Read by the application)
+    uint8_t         counters[KEYPAD_MAX_LINES * KEYPAD_MAX_LINES];
+    uint64_t        debouncing; //Keys with a counter running
+    uint64_t        scans;
+    uint64_t        ghosts;     //Scans ignored because of ghost keys
+    int             running;
+    pthread_t       thread;
+} keypad;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a keypad and start scanning
+ * \details         Pins must be exported. Directions are set by this
+ *                  function (Rows at inactive level, columns as input).
+ *
+ * \param pKeypad   Keypad to initialize
+ * \param pConfig   Keypad configuration
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid configuration
+ * \return GE_PERM  If a pin is not exported
+ * \return GE_IO    If unable to configure a pin
+ */
+pirror GIPY_keypadOpen(keypad*, const keypadConfig*);
+
+/**
+ * \brief           Stop scanning and close the keypad
+ *
+ * \param pKeypad   Opened keypad
+ * \return void
+ */
+void GIPY_keypadClose(keypad*);
+
+/**
+ * \brief           Get the next key event (Does not block)
+ *
+ * \param pKeypad   Opened keypad
+ * \param pEvent    Filled with the oldest event
+ * \return          TRUE if an event was available, otherwise FALSE
+ */
+int GIPY_keypadGetEvent(keypad*, keyEvent*);
+
+/**
+ * \brief           Check whether a key is down (Debounced state)
+ *
+ * \param pKeypad   Opened keypad
+ * \param pRow      Key row
+ * \param pCol      Key column
+ * \return          TRUE if down, otherwise FALSE
+ */
+int GIPY_keypadIsDown(keypad*, int, int);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,362 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Motion
+ * Stepper motor motion engine (STEP / DIR drivers)
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include <math.h>
+
+#include "motion.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Speed profile of one move (Leading axis, times in seconds)
+ */
+typedef struct {
+    motionProfile   profile;
+    uint32_t        steps;
+    double          speed;      //Peak speed (Lower than max for a triangle)
+    double          accel;
+    double          rampTime;   //Duration of one ramp
+    double          rampSteps;  //Steps of one ramp
+    double          total;      //Move duration
+} movePlan;
+
+/**
+ * \brief   Timing thread. Run the queued moves
+ */
+static void *motionThread(void*);
+
+/**
+ * \brief   Run one move (Timing thread)
+ *
+ * \param   pEngine Opened engine
+ * \param   pMove   Move to run
+ * \return  void
+ */
+static void runMove(motionEngine*, const motionMove*);
+
+/**
+ * \brief   Compute the profile of a move
+ *
+ * \param   pPlan       Filled with the profile
+ * \param   pProfile    Profile shape
+ * \param   pSteps      Steps of the leading axis
+ * \param   pSpeed      Max speed (Steps/s)
+ * \param   pAccel      Acceleration (Steps/s^2)
+ * \return  void
+ */
+static void planMove(movePlan*, motionProfile, uint32_t, double, double);
+
+/**
+ * \brief   Time of a step of the leading axis since the move start (s)
+ */
+static double stepTime(const movePlan*, uint32_t);
+
+/**
+ * \brief   Time to go a distance from rest on the acceleration ramp (s)
+ */
+static double rampTime(const movePlan*, double);
+
+/**
+ * \brief   Wait till a clock time (Sleep, then spin for the last
+ *          MOTION_SPIN_NS)
+ */
+static void waitUntil(uint64_t);
+
+
+//------------------------------------------------------------------------------
+// Motion engine functions
+//------------------------------------------------------------------------------
+pirror GIPY_motionOpen(motionEngine *pEngine, const motionConfig *pConfig){
+    dbgInfo("Try to open motion engine");
+    if(pEngine == NULL || pConfig == NULL || pConfig->nbAxes < 1
+            || pConfig->nbAxes > MOTION_MAX_AXES || pConfig->maxSpeed == 0
+            || pConfig->acceleration == 0
+            || (pConfig->profile != MOTION_TRAPEZOID && pConfig->profile != MOTION_SCURVE)){
+        dbgError("Invalid motion configuration");
+        return GE_PARAM;
+    }
+    memset(pEngine, 0, sizeof(motionEngine));
+    pEngine->config = *pConfig;
+    if(pEngine->config.pulseWidth == 0){
+        pEngine->config.pulseWidth = MOTION_PULSE_NS;
+    }
+
+    //Step and dir lines start low
+    int     pins[2 * MOTION_MAX_AXES];
+    int     nb = pConfig->nbAxes;
+    int     k;
+    pirror  err = GE_OK;
+    for(k=0; k<nb; k++){
+        pins[k]         = pConfig->stepPins[k];
+        pins[nb + k]    = pConfig->dirPins[k];
+    }
+    for(k=0; k<2 * nb && err == GE_OK; k++){
+        err = GIPY_pinSetDirectionLow(pins[k]);
+    }
+    if(err != GE_OK){
+        dbgError("Unable to configure motion pins");
+        return err;
+    }
+    err = GIPY_bankOpen(&pEngine->bank, pins, 2 * nb);
+    if(err != GE_OK){
+        return err;
+    }
+    err = GIPY_queueInit(&pEngine->moves, sizeof(motionMove), MOTION_QUEUE_SIZE);
+    if(err != GE_OK){
+        GIPY_bankClose(&pEngine->bank);
+        return err;
+    }
+
+    pEngine->running = TRUE;
+    pthread_create(&pEngine->thread, NULL, &motionThread, pEngine);
+    dbgInfo("Motion engine opened (%d axes, %u steps/s, %u steps/s2)", nb,
+            pConfig->maxSpeed, pConfig->acceleration);
+    return GE_OK;
+}
+
+void GIPY_motionClose(motionEngine *pEngine){
+    __atomic_store_n(&pEngine->running, FALSE, __ATOMIC_RELEASE);
+    pthread_join(pEngine->thread, NULL);
+    GIPY_bankClose(&pEngine->bank);
+    GIPY_queueFree(&pEngine->moves);
+}
+
+pirror GIPY_motionMove(motionEngine *pEngine, const int64_t *pTargets, uint32_t pMaxSpeed){
+    motionMove move;
+    if(pTargets == NULL){
+        return GE_PARAM;
+    }
+    memset(&move, 0, sizeof(motionMove));
+    memcpy(move.targets, pTargets, pEngine->config.nbAxes * sizeof(int64_t));
+    move.maxSpeed = (pMaxSpeed == 0) ? pEngine->config.maxSpeed : pMaxSpeed;
+    if(GIPY_queuePush(&pEngine->moves, &move) == FALSE){
+        dbgError("Motion queue is full");
+        return GE_IO;
+    }
+    return GE_OK;
+}
+
+void GIPY_motionAbort(motionEngine *pEngine){
+    __atomic_store_n(&pEngine->isAborting, TRUE, __ATOMIC_SEQ_CST);
+    while(__atomic_load_n(&pEngine->isAborting, __ATOMIC_SEQ_CST) == TRUE){
+        GIPY_clockSleep(MOTION_IDLE_NS);
+    }
+}
+
+int GIPY_motionIsIdle(motionEngine *pEngine){
+    //Queue first: busy is set before a move is popped, so an empty queue
+    //(Acquire) and then not busy means no move is running
+    return (GIPY_queueCount(&pEngine->moves) == 0
+            && __atomic_load_n(&pEngine->isBusy, __ATOMIC_SEQ_CST) == FALSE) ? TRUE : FALSE;
+}
+
+int64_t GIPY_motionGetPosition(motionEngine *pEngine, int pAxis){
+    if(pAxis < 0 || pAxis >= pEngine->config.nbAxes){
+        return 0;
+    }
+    return __atomic_load_n(&pEngine->positions[pAxis], __ATOMIC_RELAXED);
+}
+
+pirror GIPY_motionSetPosition(motionEngine *pEngine, int pAxis, int64_t pPosition){
+    if(pAxis < 0 || pAxis >= pEngine->config.nbAxes){
+        return GE_PARAM;
+    }
+    if(GIPY_motionIsIdle(pEngine) == FALSE){
+        dbgError("Motion axis %d position can not change while moving", pAxis);
+        return GE_PERM;
+    }
+    __atomic_store_n(&pEngine->positions[pAxis], pPosition, __ATOMIC_RELAXED);
+    return GE_OK;
+}
+
+void GIPY_motionGetStats(motionEngine *pEngine, motionStats *pStats){
+    *pStats = pEngine->stats;
+}
+
+
+//------------------------------------------------------------------------------
+// Timing thread
+//------------------------------------------------------------------------------
+static void *motionThread(void *pEngine){
+    motionEngine    *eng = (motionEngine *)pEngine;
+    motionMove      move;
+    dbgInfo("Start motion thread");
+
+    while(__atomic_load_n(&eng->running, __ATOMIC_ACQUIRE) == TRUE){
+        if(__atomic_load_n(&eng->isAborting, __ATOMIC_SEQ_CST) == TRUE){
+            while(GIPY_queuePop(&eng->moves, &move) == TRUE){
+                //Dropped
+            }
+            __atomic_store_n(&eng->isAborting, FALSE, __ATOMIC_SEQ_CST);
+        }
+        __atomic_store_n(&eng->isBusy, TRUE, __ATOMIC_SEQ_CST);
+        if(GIPY_queuePop(&eng->moves, &move) == FALSE){
+            __atomic_store_n(&eng->isBusy, FALSE, __ATOMIC_SEQ_CST);
+            GIPY_clockSleep(MOTION_IDLE_NS);
+            continue;
+        }
+        runMove(eng, &move);
+        eng->stats.moves++;
+        __atomic_store_n(&eng->isBusy, FALSE, __ATOMIC_SEQ_CST);
+    }
+    dbgInfo("Motion thread stopped");
+    return NULL;
+}
+
+static void runMove(motionEngine *pEngine, const motionMove *pMove){
+    int         nb      = pEngine->config.nbAxes;
+    uint32_t    stepMask= (1U << nb) - 1;
+    uint32_t    dirs    = 0;
+    uint64_t    deltas[MOTION_MAX_AXES];
+    uint64_t    errors[MOTION_MAX_AXES];
+    uint64_t    lead    = 0;
+    movePlan    plan;
+    uint32_t    i;
+    int         k;
+
+    //Leading axis has the most steps
+    for(k=0; k<nb; k++){
+        int64_t delta   = pMove->targets[k] - pEngine->positions[k];
+        deltas[k]       = (delta < 0) ? -delta : delta;
+        dirs            |= (delta > 0) ? 1U << (nb + k) : 0;
+        lead            = (deltas[k] > lead) ? deltas[k] : lead;
+    }
+    if(lead == 0 || lead > UINT32_MAX){
+        return;
+    }
+    for(k=0; k<nb; k++){
+        errors[k] = lead / 2;
+    }
+    planMove(&plan, pEngine->config.profile, (uint32_t)lead, pMove->maxSpeed,
+            pEngine->config.acceleration);
+    GIPY_bankWrite(&pEngine->bank, stepMask << nb, dirs);
+
+    //Step times from the move start (No drift)
+    uint64_t start = GIPY_clockNow();
+    for(i=1; i<=lead; i++){
+        if(__atomic_load_n(&pEngine->isAborting, __ATOMIC_RELAXED) == TRUE
+                || __atomic_load_n(&pEngine->running, __ATOMIC_RELAXED) == FALSE){
+            dbgInfo("Motion move stopped after %u steps", i - 1);
+            return;
+        }
+        uint32_t steps = 0;
+        for(k=0; k<nb; k++){
+            errors[k] += deltas[k];
+            if(errors[k] >= lead){
+                errors[k]   -= lead;
+                steps       |= 1U << k;
+            }
+        }
+        uint64_t when = start + (uint64_t)(stepTime(&plan, i) * NSEC_PER_SEC);
+        waitUntil(when);
+        uint64_t now = GIPY_clockNow();
+        GIPY_bankWrite(&pEngine->bank, stepMask, steps);
+        waitUntil(now + pEngine->config.pulseWidth);
+        GIPY_bankWrite(&pEngine->bank, stepMask, 0);
+
+        //Statistics and live positions
+        uint64_t late = now - when;
+        pEngine->stats.steps++;
+        pEngine->stats.errorTotal   += late;
+        pEngine->stats.errorMax     = (late > pEngine->stats.errorMax) ? late : pEngine->stats.errorMax;
+        pEngine->stats.late         += (late > MOTION_LATE_NS) ? 1 : 0;
+        for(k=0; k<nb; k++){
+            if(steps & (1U << k)){
+                __atomic_add_fetch(&pEngine->positions[k],
+                        (dirs & (1U << (nb + k))) ? 1 : -1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Profile functions
+//------------------------------------------------------------------------------
+static void planMove(movePlan *pPlan, motionProfile pProfile, uint32_t pSteps,
+        double pSpeed, double pAccel){
+    pPlan->profile  = pProfile;
+    pPlan->steps    = pSteps;
+    pPlan->accel    = pAccel;
+
+    //Triangle if both ramps do not fit in the move
+    double speed = pSpeed;
+    if(pProfile == MOTION_TRAPEZOID && speed * speed / pAccel > pSteps){
+        speed = sqrt(pAccel * pSteps);
+    }
+    if(pProfile == MOTION_SCURVE && speed * speed * M_PI / (2.0 * pAccel) > pSteps){
+        speed = sqrt(2.0 * pAccel * pSteps / M_PI);
+    }
+    pPlan->speed = speed;
+    if(pProfile == MOTION_TRAPEZOID){
+        pPlan->rampTime     = speed / pAccel;
+        pPlan->rampSteps    = speed * speed / (2.0 * pAccel);
+    }
+    else{
+        pPlan->rampTime     = M_PI * speed / (2.0 * pAccel);
+        pPlan->rampSteps    = speed * pPlan->rampTime / 2.0;
+    }
+    pPlan->total = 2.0 * pPlan->rampTime + (pSteps - 2.0 * pPlan->rampSteps) / speed;
+}
+
+static double stepTime(const movePlan *pPlan, uint32_t pStep){
+    double s = (double)pStep;
+    if(s <= pPlan->rampSteps){
+        return rampTime(pPlan, s);
+    }
+    if(s < pPlan->steps - pPlan->rampSteps){
+        return pPlan->rampTime + (s - pPlan->rampSteps) / pPlan->speed;
+    }
+    return pPlan->total - rampTime(pPlan, pPlan->steps - s);
+}
+
+static double rampTime(const movePlan *pPlan, double pDistance){
+    double ta = pPlan->rampTime;
+    double v  = pPlan->speed;
+    if(pDistance <= 0.0){
+        return 0.0;
+    }
+    if(pPlan->profile == MOTION_TRAPEZOID){
+        return sqrt(2.0 * pDistance / pPlan->accel);
+    }
+
+    //S-curve: s(t) = v/2 (t - ta/pi sin(pi t / ta)), no closed inverse.
+    //Start from the cubic of small t, then Newton (s is convex on the ramp)
+    double t = cbrt(12.0 * ta * ta * pDistance / (v * M_PI * M_PI));
+    int k;
+    for(k=0; k<8; k++){
+        t = (t > ta) ? ta : t;
+        double x        = M_PI * t / ta;
+        double speed    = v / 2.0 * (1.0 - cos(x));
+        double error    = v / 2.0 * (t - ta / M_PI * sin(x)) - pDistance;
+        if(speed <= 0.0 || fabs(error) < 1e-6){
+            break;
+        }
+        t -= error / speed;
+    }
+    return (t > ta) ? ta : (t < 0.0) ? 0.0 : t;
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static void waitUntil(uint64_t pTime){
+    uint64_t now = GIPY_clockNow();
+    if(pTime > now + MOTION_SPIN_NS){
+        GIPY_clockSleep(pTime - now - MOTION_SPIN_NS);
+    }
+    while(GIPY_clockNow() < pTime){
+        //Spin: sleep wake up latency is about the spin duration
+    }
+}
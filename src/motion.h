@@ -0,0 +1,205 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Motion
+ * Stepper motor motion engine (STEP / DIR drivers)
+ *
+ * MOVES
+ * A move is a target position of each axis (Steps, absolute). Moves are
+ * queued by the application and run one after the other by a timing
+ * thread, each one from rest to rest. The axis with the most steps leads:
+ * its step times follow the speed profile, the other axes step with it
+ * (Bresenham), so all axes start and stop together on a straight line.
+ *
+ * PROFILES
+ * Trapezoidal: constant acceleration, cruise, constant deceleration.
+ * S-curve: the speed follows a half cosine during the ramps (No
+ * acceleration step, peak acceleration is the configured one, ramps are
+ * pi/2 longer). Short moves do not reach the max speed (Triangle).
+ *
+ * STEPS
+ * The step times are computed from the move start, so an error does not
+ * add up. Each step is one bank write of all the step pins of the axes
+ * stepping at this time, then one write to clear them after 'pulseWidth'.
+ * The thread sleeps, then spins for the last MOTION_SPIN_NS. The lateness
+ * of each step (Write time minus step time) is measured in the statistics.
+ * Directions are written once at the move start.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_MOTION_H_
+#define _HEADER_MOTION_H_
+
+#include "gipy.h"
+#include "bank.h"
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define MOTION_MAX_AXES     4
+#define MOTION_QUEUE_SIZE   32
+#define MOTION_PULSE_NS     (2 * NSEC_PER_USEC) //Default step pulse width
+#define MOTION_SPIN_NS      (50 * NSEC_PER_USEC) //Busy wait before a step
+#define MOTION_LATE_NS      (20 * NSEC_PER_USEC) //Later steps are counted
+#define MOTION_IDLE_NS      NSEC_PER_MSEC //Queue poll period while idle
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Describe the speed profiles
+ */
+typedef enum {
+    MOTION_TRAPEZOID,
+    MOTION_SCURVE
+} motionProfile;
+
+/**
+ * \brief Motion engine configuration
+ */
+typedef struct {
+    int             nbAxes;
+    int             stepPins[MOTION_MAX_AXES];
+    int             dirPins[MOTION_MAX_AXES]; //High is the positive direction
+    uint32_t        maxSpeed;       //Steps/s of the leading axis
+    uint32_t        acceleration;   //Steps/s^2 of the leading axis
+    motionProfile   profile;
+    uint32_t        pulseWidth;     //Step pulse (ns), 0 for MOTION_PULSE_NS
+} motionConfig;
+
+/**
+ * \brief Move queued in the engine
+ */
+typedef struct {
+    int64_t         targets[MOTION_MAX_AXES];
+    uint32_t        maxSpeed;       //0 for the configured max speed
+} motionMove;
+
+/**
+ * \brief Step timing statistics (Filled by the timing thread)
+ */
+typedef struct {
+    uint64_t        moves;          //Moves run (Stopped ones included)
+    uint64_t        steps;          //Step writes (Axes stepping together: one)
+    uint64_t        late;           //Steps later than MOTION_LATE_NS
+    uint64_t        errorMax;       //Max lateness (ns)
+    uint64_t        errorTotal;     //Sum of lateness (ns), mean is total / steps
+} motionStats;
+
+/**
+ * \brief Motion engine. Bank pin k is step pin k, nbAxes + k is dir pin k
+ */
+typedef struct {
+    motionConfig    config;
+    pinBank         bank;
+    eventQueue      moves;
+    int64_t         positions[MOTION_MAX_AXES]; //Live positions (Steps)
+    motionStats     stats;
+    int             isBusy;         //TRUE while a move may run
+    int             isAborting;     //Set by GIPY_motionAbort, cleared by the thread
+    int             running;
+    pthread_t       thread;
+} motionEngine;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a motion engine and start its timing thread
+ * \details         Pins must be exported. They are set as low outputs by
+ *                  this function. Positions start at 0.
+ *
+ * \param pEngine   Engine to initialize
+ * \param pConfig   Engine configuration
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid configuration
+ * \return GE_PERM  If a pin is not exported
+ * \return GE_IO    If unable to configure a pin or allocate the queue
+ */
+pirror GIPY_motionOpen(motionEngine*, const motionConfig*);
+
+/**
+ * \brief           Stop the timing thread and close the engine
+ * \details         The move in progress is stopped without deceleration.
+ *
+ * \param pEngine   Opened engine
+ * \return void
+ */
+void GIPY_motionClose(motionEngine*);
+
+/**
+ * \brief           Queue a move (One application thread only)
+ *
+ * \param pEngine   Opened engine
+ * \param pTargets  Target position of each axis (Steps)
+ * \param pMaxSpeed Max speed of the leading axis, 0 for the configured one
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid parameters
+ * \return GE_IO    If the move queue is full
+ */
+pirror GIPY_motionMove(motionEngine*, const int64_t*, uint32_t);
+
+/**
+ * \brief           Stop the move in progress (No deceleration) and drop the
+ *                  queued moves. Returns once the engine is idle.
+ *
+ * \param pEngine   Opened engine
+ * \return void
+ */
+void GIPY_motionAbort(motionEngine*);
+
+/**
+ * \brief           Check whether all the queued moves are done
+ *
+ * \param pEngine   Opened engine
+ * \return          TRUE if idle, otherwise FALSE
+ */
+int GIPY_motionIsIdle(motionEngine*);
+
+/**
+ * \brief           Get the live position of an axis
+ *
+ * \param pEngine   Opened engine
+ * \param pAxis     Axis index
+ * \return          Position (Steps), 0 if invalid axis
+ */
+int64_t GIPY_motionGetPosition(motionEngine*, int);
+
+/**
+ * \brief           Set the position of an axis (Homing)
+ *
+ * \param pEngine   Opened engine
+ * \param pAxis     Axis index
+ * \param pPosition New position (Steps)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid axis
+ * \return GE_PERM  If the engine is not idle
+ */
+pirror GIPY_motionSetPosition(motionEngine*, int, int64_t);
+
+/**
+ * \brief           Get the step timing statistics
+ *
+ * \param pEngine   Opened engine
+ * \param pStats    Filled with the statistics
+ * \return void
+ */
+void GIPY_motionGetStats(motionEngine*, motionStats*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
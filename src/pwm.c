@@ -0,0 +1,302 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY PWM
+ * Hardware PWM channels (sysfs /sys/class/pwm)
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include <errno.h>
+
+#include "pwm.h"
+#include "simul.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Write a pwmchipN file (export, unexport)
+ *
+ * \param   pFormat Path format (PWM_PATH_EXPORT...)
+ * \param   pChip   Chip number
+ * \param   pValue  Number to write
+ * \return  Write result (-1 and errno set if error), -2 if unable to open
+ */
+static int writeChipFile(const char*, int, int);
+
+/**
+ * \brief   Write a channel attribute (Open, write, close)
+ *
+ * \param   pPwm    Exported channel
+ * \param   pName   Attribute file name
+ * \param   pText   Text to write
+ * \param   pLen    Text length
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror writeAttribute(pwmChannel*, const char*, const char*, int);
+
+/**
+ * \brief   Read a channel attribute
+ *
+ * \param   pPwm    Exported channel
+ * \param   pName   Attribute file name
+ * \param   pBuffer Filled with the content (64 bytes, null terminated)
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror readAttribute(pwmChannel*, const char*, char*);
+
+/**
+ * \brief   Format a time in ns as decimal text ended by '\n'
+ * \details The '\n' is accepted by the kernel and ends the value on a
+ *          regular file when a shorter value is written over a longer one
+ *          (Simulated tree), so no truncate is needed.
+ *
+ * \param   pValue  Value to format
+ * \param   pBuffer Filled with the text (24 bytes, not null terminated)
+ * \return  Text length
+ */
+static int formatTime(uint64_t, char*);
+
+
+//------------------------------------------------------------------------------
+// PWM channel functions
+//------------------------------------------------------------------------------
+int GIPY_pwmGetChannels(int pChip){
+    char    root[PATH_MAX];
+    char    path[PATH_MAX + 32];
+    char    content[16];
+    if(pChip < 0){
+        return -1;
+    }
+    pwmRootOf(GIPY_getSysfsRoot(), root);
+    snprintf(path, sizeof(path), PWM_PATH_NPWM, root, pChip);
+    int file = open(path, O_RDONLY);
+    if(file == -1){
+        return -1;
+    }
+    ssize_t len = read(file, content, sizeof(content) - 1);
+    close(file);
+    if(len <= 0){
+        return -1;
+    }
+    content[len] = '\0';
+    return atoi(content);
+}
+
+pirror GIPY_pwmExport(pwmChannel *pPwm, int pChip, int pChannel){
+    dbgInfo("Try to export pwm %d of pwmchip%d", pChannel, pChip);
+    if(pPwm == NULL || pChannel < 0 || pChannel >= GIPY_pwmGetChannels(pChip)){
+        dbgError("Invalid pwm channel %d of pwmchip%d", pChannel, pChip);
+        return GE_PARAM;
+    }
+
+    //EBUSY: already exported, the channel is used as it is
+    int res = writeChipFile(PWM_PATH_EXPORT, pChip, pChannel);
+    if(res == -2){
+        return GE_PERM;
+    }
+    if(res == -1 && errno != EBUSY){
+        dbgError("Unable to export pwm %d of pwmchip%d", pChannel, pChip);
+        return GE_IO;
+    }
+    if(GIPY_simIsEnabled() == TRUE && simPwmExport(pChip, pChannel) != GE_OK){
+        return GE_IO; //Simulated pwmM folder is created on export
+    }
+
+    //Keep the duty_cycle file open, read back the current state
+    char root[PATH_MAX];
+    char path[PATH_MAX + 64];
+    char content[64];
+    pPwm->chip      = pChip;
+    pPwm->channel   = pChannel;
+    pwmRootOf(GIPY_getSysfsRoot(), root);
+    snprintf(path, sizeof(path), PWM_PATH_ATTRIBUTE, root, pChip, pChannel, "duty_cycle");
+    pPwm->dutyFd = open(path, O_RDWR);
+    if(pPwm->dutyFd == -1){
+        dbgError("Unable to open (RDWR) duty cycle file: %s", path);
+        return GE_PERM;
+    }
+    pPwm->period    = (readAttribute(pPwm, "period", content) == GE_OK) ? strtoull(content, NULL, 10) : 0;
+    pPwm->duty      = (readAttribute(pPwm, "duty_cycle", content) == GE_OK) ? strtoull(content, NULL, 10) : 0;
+    pPwm->polarity  = (readAttribute(pPwm, "polarity", content) == GE_OK
+            && strncmp(content, "inversed", 8) == 0) ? PWM_INVERSED : PWM_NORMAL;
+    pPwm->isEnabled = (readAttribute(pPwm, "enable", content) == GE_OK
+            && content[0] == '1') ? TRUE : FALSE;
+    dbgInfo("Pwm %d of pwmchip%d exported (Period: %llu, duty: %llu, enabled: %d)",
+            pChannel, pChip, (unsigned long long)pPwm->period,
+            (unsigned long long)pPwm->duty, pPwm->isEnabled);
+    return GE_OK;
+}
+
+pirror GIPY_pwmUnexport(pwmChannel *pPwm){
+    dbgInfo("Try to unexport pwm %d of pwmchip%d", pPwm->channel, pPwm->chip);
+    if(pPwm->dutyFd != -1){
+        close(pPwm->dutyFd);
+        pPwm->dutyFd = -1;
+    }
+    int res = writeChipFile(PWM_PATH_UNEXPORT, pPwm->chip, pPwm->channel);
+    if(res == -2){
+        return GE_NOENT;
+    }
+    if(res == -1){
+        dbgError("Unable to unexport pwm %d of pwmchip%d", pPwm->channel, pPwm->chip);
+        return GE_IO;
+    }
+    if(GIPY_simIsEnabled() == TRUE){
+        simPwmUnexport(pPwm->chip, pPwm->channel);
+    }
+    return GE_OK;
+}
+
+pirror GIPY_pwmSetPeriod(pwmChannel *pPwm, uint64_t pPeriod){
+    char    text[24];
+    if(pPeriod == 0 || pPeriod < pPwm->duty){
+        dbgError("Invalid pwm period %llu (Duty cycle: %llu)",
+                (unsigned long long)pPeriod, (unsigned long long)pPwm->duty);
+        return GE_PARAM;
+    }
+    if(writeAttribute(pPwm, "period", text, formatTime(pPeriod, text)) != GE_OK){
+        return GE_IO;
+    }
+    pPwm->period = pPeriod;
+    return GE_OK;
+}
+
+pirror GIPY_pwmSetDuty(pwmChannel *pPwm, uint64_t pDuty){
+    char    text[24];
+    if(pDuty > pPwm->period){
+        return GE_PARAM;
+    }
+    int len = formatTime(pDuty, text);
+    if(pwrite(pPwm->dutyFd, text, len, 0) != len){
+        dbgError("Unable to write pwm %d duty cycle", pPwm->channel);
+        return GE_IO;
+    }
+    pPwm->duty = pDuty;
+    return GE_OK;
+}
+
+pirror GIPY_pwmSetPolarity(pwmChannel *pPwm, pwmPolarity pPolarity){
+    if(pPwm->isEnabled == TRUE){
+        dbgError("Pwm %d polarity can not change while enabled", pPwm->channel);
+        return GE_PERM;
+    }
+    switch(pPolarity){
+        case PWM_NORMAL:
+            if(writeAttribute(pPwm, "polarity", "normal\n", 7) != GE_OK){
+                return GE_IO;
+            }
+            break;
+        case PWM_INVERSED:
+            if(writeAttribute(pPwm, "polarity", "inversed\n", 9) != GE_OK){
+                return GE_IO;
+            }
+            break;
+        default:
+            return GE_PARAM;
+    }
+    pPwm->polarity = pPolarity;
+    return GE_OK;
+}
+
+pirror GIPY_pwmEnable(pwmChannel *pPwm, int pEnable){
+    if(pEnable == TRUE && pPwm->period == 0){
+        dbgError("Pwm %d can not be enabled without period", pPwm->channel);
+        return GE_PARAM;
+    }
+    if(writeAttribute(pPwm, "enable", (pEnable == TRUE) ? "1\n" : "0\n", 2) != GE_OK){
+        return GE_IO;
+    }
+    pPwm->isEnabled = (pEnable == TRUE) ? TRUE : FALSE;
+    return GE_OK;
+}
+
+void pwmRootOf(const char *pRoot, char *pBuffer){
+    size_t len      = strlen(pRoot);
+    size_t suffix   = strlen(PWM_GPIO_FOLDER);
+    if(len >= suffix && strcmp(pRoot + len - suffix, PWM_GPIO_FOLDER) == 0){
+        snprintf(pBuffer, PATH_MAX, "%.*s%s", (int)(len - suffix), pRoot, PWM_FOLDER);
+    }
+    else{
+        snprintf(pBuffer, PATH_MAX, "%s%s", pRoot, PWM_FOLDER);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static int writeChipFile(const char *pFormat, int pChip, int pValue){
+    char    root[PATH_MAX];
+    char    path[PATH_MAX + 32];
+    char    text[16];
+    pwmRootOf(GIPY_getSysfsRoot(), root);
+    snprintf(path, sizeof(path), pFormat, root, pChip);
+    int file = open(path, O_WRONLY);
+    if(file == -1){
+        dbgError("Unable to open (WRONLY) file: %s", path);
+        return -2;
+    }
+    int len = sprintf(text, "%d", pValue);
+    int res = (write(file, text, len) == len) ? 0 : -1;
+    int err = errno;
+    close(file);
+    errno = err;
+    return res;
+}
+
+static pirror writeAttribute(pwmChannel *pPwm, const char *pName, const char *pText, int pLen){
+    char    root[PATH_MAX];
+    char    path[PATH_MAX + 64];
+    pwmRootOf(GIPY_getSysfsRoot(), root);
+    snprintf(path, sizeof(path), PWM_PATH_ATTRIBUTE, root, pPwm->chip, pPwm->channel, pName);
+    int file = open(path, O_WRONLY);
+    if(file == -1){
+        dbgError("Unable to open (WRONLY) pwm file: %s", path);
+        return GE_IO;
+    }
+    if(write(file, pText, pLen) != pLen){
+        dbgError("Unable to write pwm file: %s", path);
+        close(file);
+        return GE_IO;
+    }
+    close(file);
+    return GE_OK;
+}
+
+static pirror readAttribute(pwmChannel *pPwm, const char *pName, char *pBuffer){
+    char    root[PATH_MAX];
+    char    path[PATH_MAX + 64];
+    pwmRootOf(GIPY_getSysfsRoot(), root);
+    snprintf(path, sizeof(path), PWM_PATH_ATTRIBUTE, root, pPwm->chip, pPwm->channel, pName);
+    int file = open(path, O_RDONLY);
+    if(file == -1){
+        return GE_IO;
+    }
+    ssize_t len = read(file, pBuffer, 63);
+    close(file);
+    if(len <= 0){
+        return GE_IO;
+    }
+    pBuffer[len] = '\0';
+    return GE_OK;
+}
+
+static int formatTime(uint64_t pValue, char *pBuffer){
+    char    digits[20];
+    int     nb = 0;
+    int     k;
+    do{
+        digits[nb++]    = '0' + (pValue % 10);
+        pValue          /= 10;
+    } while(pValue != 0);
+    for(k=0; k<nb; k++){
+        pBuffer[k] = digits[nb - 1 - k];
+    }
+    pBuffer[nb] = '\n';
+    return nb + 1;
+}
@@ -0,0 +1,174 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY PWM
+ * Hardware PWM channels (sysfs /sys/class/pwm)
+ *
+ * SYSFS ROOT
+ * The pwm root follows the library sysfs root (See GIPY_setSysfsRoot): a
+ * root ending with "gpio/" becomes "pwm/" beside it (/sys/class/gpio/ gives
+ * /sys/class/pwm/), any other root holds a "pwm/" folder (Simulated tree).
+ *
+ * CHANNELS
+ * A channel is exported with pwmchipN/export, then configured with its
+ * pwmchipN/pwmM/period, duty_cycle, polarity and enable files (Times in ns).
+ * The duty_cycle file is kept open: changing the duty cycle is one write.
+ * The channel keeps the last written values, so the kernel rules are
+ * checked before writing (Duty cycle not over the period, polarity only
+ * changed while disabled, period set before enabling).
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_PWM_H_
+#define _HEADER_PWM_H_
+
+#include "gipy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define PWM_GPIO_FOLDER     "gpio/" //Sysfs root suffix replaced by PWM_FOLDER
+#define PWM_FOLDER          "pwm/"
+#define PWM_PATH_EXPORT     "%spwmchip%d/export"
+#define PWM_PATH_UNEXPORT   "%spwmchip%d/unexport"
+#define PWM_PATH_NPWM       "%spwmchip%d/npwm"
+#define PWM_PATH_ATTRIBUTE  "%spwmchip%d/pwm%d/%s"
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Describe the PWM polarities
+ */
+typedef enum {
+    PWM_NORMAL,     //High during the duty cycle
+    PWM_INVERSED    //Low during the duty cycle
+} pwmPolarity;
+
+/**
+ * \brief Exported PWM channel
+ */
+typedef struct {
+    int         chip;       //pwmchipN
+    int         channel;    //pwmM
+    int         dutyFd;     //duty_cycle file, kept open
+    uint64_t    period;     //ns
+    uint64_t    duty;       //ns
+    pwmPolarity polarity;
+    int         isEnabled;
+} pwmChannel;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Get the number of channels of a PWM chip
+ *
+ * \param pChip     Chip number (pwmchipN)
+ * \return          Number of channels, -1 if no such chip
+ */
+int GIPY_pwmGetChannels(int);
+
+/**
+ * \brief           Export a PWM channel
+ * \details         A channel already exported (By another process or a
+ *                  previous run) is used as it is. Its current period, duty
+ *                  cycle, polarity and enable state are read back.
+ *
+ * \param pPwm      Channel to initialize
+ * \param pChip     Chip number (pwmchipN)
+ * \param pChannel  Channel number in the chip (pwmM)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid chip or channel
+ * \return GE_PERM  If unable to open the export or channel files
+ * \return GE_IO    If unable to export the channel
+ */
+pirror GIPY_pwmExport(pwmChannel*, int, int);
+
+/**
+ * \brief           Unexport a PWM channel
+ * \details         The output is not disabled (Same as the kernel).
+ *
+ * \param pPwm      Exported channel
+ * \return GE_OK    If no error
+ * \return GE_NOENT If unable to open the unexport file
+ * \return GE_IO    If unable to unexport the channel
+ */
+pirror GIPY_pwmUnexport(pwmChannel*);
+
+/**
+ * \brief           Set the period of a PWM channel
+ *
+ * \param pPwm      Exported channel
+ * \param pPeriod   Period in ns
+ * \return GE_OK    If no error
+ * \return GE_PARAM If 0 or lower than the duty cycle (Lower it first)
+ * \return GE_IO    If unable to write the period
+ */
+pirror GIPY_pwmSetPeriod(pwmChannel*, uint64_t);
+
+/**
+ * \brief           Set the duty cycle of a PWM channel (One write)
+ *
+ * \param pPwm      Exported channel
+ * \param pDuty     Active time per period in ns
+ * \return GE_OK    If no error
+ * \return GE_PARAM If over the period
+ * \return GE_IO    If unable to write the duty cycle
+ */
+pirror GIPY_pwmSetDuty(pwmChannel*, uint64_t);
+
+/**
+ * \brief           Set the polarity of a PWM channel
+ *
+ * \param pPwm      Exported channel
+ * \param pPolarity New polarity
+ * \return GE_OK    If no error
+ * \return GE_PERM  If the channel is enabled
+ * \return GE_PARAM If invalid polarity
+ * \return GE_IO    If unable to write the polarity
+ */
+pirror GIPY_pwmSetPolarity(pwmChannel*, pwmPolarity);
+
+/**
+ * \brief           Enable or disable the output of a PWM channel
+ *
+ * \param pPwm      Exported channel
+ * \param pEnable   TRUE to enable, FALSE to disable
+ * \return GE_OK    If no error
+ * \return GE_PARAM If enabled without period
+ * \return GE_IO    If unable to write the enable file
+ */
+pirror GIPY_pwmEnable(pwmChannel*, int);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Library internal
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Get the pwm root of a sysfs root (See SYSFS ROOT)
+ *
+ * \param pRoot     Sysfs root (Ends with '/')
+ * \param pBuffer   Filled with the pwm root (PATH_MAX)
+ * \return void
+ */
+void pwmRootOf(const char*, char*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
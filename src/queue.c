@@ -0,0 +1,75 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Queue
+ * Fixed size event queue (One producer, one consumer, no lock)
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "queue.h"
+#include "trace.h"
+
+
+//------------------------------------------------------------------------------
+// Queue functions
+//------------------------------------------------------------------------------
+pirror GIPY_queueInit(eventQueue *pQueue, size_t pSize, uint32_t pCapacity){
+    if(pQueue == NULL || pSize == 0 || pCapacity == 0 || pCapacity > (1U << 30)){
+        return GE_PARAM;
+    }
+    uint32_t capacity = 1;
+    while(capacity < pCapacity){
+        capacity <<= 1;
+    }
+    memset(pQueue, 0, sizeof(eventQueue));
+    pQueue->buffer = malloc(pSize * capacity);
+    if(pQueue->buffer == NULL){
+        return GE_IO;
+    }
+    pQueue->elementSize = pSize;
+    pQueue->capacity    = capacity;
+    return GE_OK;
+}
+
+void GIPY_queueFree(eventQueue *pQueue){
+    free(pQueue->buffer);
+    pQueue->buffer      = NULL;
+    pQueue->capacity    = 0;
+}
+
+int GIPY_queuePush(eventQueue *pQueue, const void *pElement){
+    uint32_t tail = pQueue->tail; //Only written by this side
+    uint32_t head = __atomic_load_n(&pQueue->head, __ATOMIC_ACQUIRE);
+    if(tail - head >= pQueue->capacity){
+        __atomic_add_fetch(&pQueue->overflows, 1, __ATOMIC_RELAXED);
+        traceProbe2(queue_overflow, pQueue, pQueue->overflows);
+        return 0;
+    }
+    memcpy(pQueue->buffer + (tail & (pQueue->capacity - 1)) * pQueue->elementSize,
+            pElement, pQueue->elementSize);
+    __atomic_store_n(&pQueue->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int GIPY_queuePop(eventQueue *pQueue, void *pElement){
+    uint32_t head = pQueue->head; //Only written by this side
+    uint32_t tail = __atomic_load_n(&pQueue->tail, __ATOMIC_ACQUIRE);
+    if(head == tail){
+        return 0;
+    }
+    memcpy(pElement, pQueue->buffer + (head & (pQueue->capacity - 1)) * pQueue->elementSize,
+            pQueue->elementSize);
+    __atomic_store_n(&pQueue->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+uint32_t GIPY_queueCount(eventQueue *pQueue){
+    return __atomic_load_n(&pQueue->tail, __ATOMIC_ACQUIRE)
+        - __atomic_load_n(&pQueue->head, __ATOMIC_ACQUIRE);
+}
+
+uint64_t GIPY_queueOverflows(eventQueue *pQueue){
+    return __atomic_load_n(&pQueue->overflows, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,109 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Queue
+ * Fixed size event queue (One producer, one consumer, no lock)
+ *
+ * Used by the engines to deliver events from their thread (Producer) to
+ * the application (Consumer). When the queue is full, the new event is
+ * dropped and counted as overflow.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_QUEUE_H_
+#define _HEADER_QUEUE_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "errman.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Event queue (Capacity is a power of 2)
+ */
+typedef struct {
+    uint8_t     *buffer;
+    size_t      elementSize;
+    uint32_t    capacity;
+    uint32_t    head;       //Next element to pop (Written by consumer)
+    uint32_t    tail;       //Next free element (Written by producer)
+    uint64_t    overflows;  //Dropped events
+} eventQueue;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Allocate a queue
+ *
+ * \param pQueue    Queue to initialize
+ * \param pSize     Size of one element
+ * \param pCapacity Max number of elements (Rounded up to a power of 2)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid size or capacity
+ * \return GE_IO    If unable to allocate the buffer
+ */
+pirror GIPY_queueInit(eventQueue*, size_t, uint32_t);
+
+/**
+ * \brief           Free a queue
+ *
+ * \param pQueue    Queue to free
+ * \return void
+ */
+void GIPY_queueFree(eventQueue*);
+
+/**
+ * \brief           Push an element (Producer side)
+ *
+ * \param pQueue    Queue
+ * \param pElement  Element to copy in the queue
+ * \return          TRUE if pushed, FALSE if full (Overflow counted)
+ */
+int GIPY_queuePush(eventQueue*, const void*);
+
+/**
+ * \brief           Pop an element (Consumer side)
+ *
+ * \param pQueue    Queue
+ * \param pElement  Filled with the oldest element
+ * \return          TRUE if popped, FALSE if empty
+ */
+int GIPY_queuePop(eventQueue*, void*);
+
+/**
+ * \brief           Get the number of elements in the queue
+ *
+ * \param pQueue    Queue
+ * \return          Number of elements
+ */
+uint32_t GIPY_queueCount(eventQueue*);
+
+/**
+ * \brief           Get the number of dropped elements (Queue was full)
+ *
+ * \param pQueue    Queue
+ * \return          Number of overflows
+ */
+uint64_t GIPY_queueOverflows(eventQueue*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
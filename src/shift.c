@@ -0,0 +1,333 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Shift
+ * Shift register chains (74HC595 outputs, 74HC165 inputs) as virtual pins
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "shift.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Refresh thread. At most one refresh every 1/maxRate
+ */
+static void *shiftThread(void*);
+
+/**
+ * \brief   Shift the outputs and the inputs once (Refresh thread)
+ *
+ * \param   pChain  Opened chain
+ * \param   pImage  Outputs to shift out
+ * \param   pInputs Filled with the inputs shifted in
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror refresh(shiftChain*, uint64_t, uint64_t*);
+
+/**
+ * \brief   Busy wait till half a clock period elapsed since pStart (See spi.c)
+ */
+static inline void waitHalfPeriod(uint64_t*, uint32_t);
+
+/**
+ * \brief   Virtual pins operations (Index in the chain pins)
+ */
+static pirror virtualRead(void*, int, int*);
+static pirror virtualWrite(void*, int, int);
+static pirror virtualSetDirection(void*, int, pinDirection);
+
+static const virtualPinOps shiftPinOps = {
+    virtualRead,
+    virtualWrite,
+    virtualSetDirection
+};
+
+#define CLOCK_BIT   0x01U
+#define LATCH_BIT   0x02U
+#define IMAGE_MASK(nb) (((nb) >= 64) ? ~0ULL : ((1ULL << (nb)) - 1))
+
+
+//------------------------------------------------------------------------------
+// Shift chain functions
+//------------------------------------------------------------------------------
+pirror GIPY_shiftOpen(shiftChain *pChain, const shiftConfig *pConfig){
+    dbgInfo("Try to open shift chain (Clock: %d)", (pConfig) ? pConfig->pinClock : -1);
+    if(pChain == NULL || pConfig == NULL
+            || pConfig->pinClock == SHIFT_NO_PIN || pConfig->pinLatch == SHIFT_NO_PIN
+            || pConfig->nbOutputs < 0 || pConfig->nbOutputs > SHIFT_MAX_BITS
+            || pConfig->nbInputs < 0 || pConfig->nbInputs > SHIFT_MAX_BITS
+            || pConfig->nbOutputs + pConfig->nbInputs == 0
+            || (pConfig->nbOutputs > 0 && pConfig->pinData == SHIFT_NO_PIN)
+            || (pConfig->nbInputs > 0 && pConfig->pinIn == SHIFT_NO_PIN)){
+        dbgError("Invalid shift chain configuration");
+        return GE_PARAM;
+    }
+    memset(pChain, 0, sizeof(shiftChain));
+    pChain->config = *pConfig;
+    if(pChain->config.maxRate == 0){
+        pChain->config.maxRate = SHIFT_DEFAULT_RATE;
+    }
+
+    //Set directions: latch idle high, clock and data low
+    pirror err = GIPY_pinSetDirection(pConfig->pinClock, LOW);
+    if(err == GE_OK){
+        err = GIPY_pinSetDirection(pConfig->pinLatch, HIGH);
+    }
+    if(err == GE_OK && pConfig->nbOutputs > 0){
+        err = GIPY_pinSetDirection(pConfig->pinData, LOW);
+    }
+    if(err == GE_OK && pConfig->nbInputs > 0){
+        err = GIPY_pinSetDirectionIn(pConfig->pinIn);
+    }
+    if(err != GE_OK){
+        dbgError("Unable to set shift chain pins directions");
+        return err;
+    }
+
+    //Output bank: clock, latch, then data if outputs
+    int pins[3];
+    int nbPins      = 0;
+    pins[nbPins++]  = pConfig->pinClock;
+    pins[nbPins++]  = pConfig->pinLatch;
+    if(pConfig->nbOutputs > 0){
+        pChain->dataBit = 1U << nbPins;
+        pins[nbPins++]  = pConfig->pinData;
+    }
+    err = GIPY_bankOpen(&pChain->out, pins, nbPins);
+    if(err != GE_OK){
+        return err;
+    }
+    if(pConfig->nbInputs > 0){
+        err = GIPY_bankOpen(&pChain->in, &pConfig->pinIn, 1);
+        if(err != GE_OK){
+            GIPY_bankClose(&pChain->out);
+            return err;
+        }
+    }
+    if(pConfig->pinBase != SHIFT_NO_PIN){
+        err = gipyAddVirtualPins(pConfig->pinBase, pConfig->nbOutputs + pConfig->nbInputs,
+                &shiftPinOps, pChain);
+        if(err != GE_OK){
+            GIPY_bankClose(&pChain->out);
+            if(pConfig->nbInputs > 0){
+                GIPY_bankClose(&pChain->in);
+            }
+            return err;
+        }
+    }
+
+    pChain->isForced    = TRUE;
+    pChain->running     = TRUE;
+    pthread_create(&pChain->thread, NULL, &shiftThread, pChain);
+    dbgInfo("Shift chain opened (%d outputs, %d inputs, backend %s)", pConfig->nbOutputs,
+            pConfig->nbInputs, GIPY_bankBackendName(pChain->out.backend));
+    return GE_OK;
+}
+
+void GIPY_shiftClose(shiftChain *pChain){
+    if(pChain->config.pinBase != SHIFT_NO_PIN){
+        gipyRemoveVirtualPins(pChain->config.pinBase);
+    }
+    __atomic_store_n(&pChain->running, FALSE, __ATOMIC_RELEASE);
+    pthread_join(pChain->thread, NULL);
+    GIPY_bankClose(&pChain->out);
+    if(pChain->config.nbInputs > 0){
+        GIPY_bankClose(&pChain->in);
+    }
+}
+
+void GIPY_shiftWrite(shiftChain *pChain, uint64_t pMask, uint64_t pValues){
+    uint64_t image = __atomic_load_n(&pChain->outputs, __ATOMIC_RELAXED);
+    uint64_t next;
+    pMask &= IMAGE_MASK(pChain->config.nbOutputs);
+    do{
+        next = (image & ~pMask) | (pValues & pMask);
+    }while(__atomic_compare_exchange_n(&pChain->outputs, &image, next, TRUE,
+                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED) == FALSE);
+}
+
+uint64_t GIPY_shiftRead(shiftChain *pChain){
+    return __atomic_load_n(&pChain->inputs, __ATOMIC_ACQUIRE);
+}
+
+pirror GIPY_shiftSync(shiftChain *pChain){
+    //A period started after this load reads the image written before
+    uint64_t started = __atomic_load_n(&pChain->started, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&pChain->isForced, TRUE, __ATOMIC_RELEASE);
+    while(__atomic_load_n(&pChain->finished, __ATOMIC_ACQUIRE) <= started){
+        GIPY_clockSleep(NSEC_PER_SEC / pChain->config.maxRate / 4 + 1);
+    }
+    return __atomic_load_n(&pChain->lastError, __ATOMIC_ACQUIRE);
+}
+
+void GIPY_shiftGetStats(shiftChain *pChain, shiftStats *pStats){
+    *pStats = pChain->stats;
+}
+
+
+//------------------------------------------------------------------------------
+// Refresh thread
+//------------------------------------------------------------------------------
+static void *shiftThread(void *pChain){
+    shiftChain  *chain      = (shiftChain *)pChain;
+    uint64_t    period      = NSEC_PER_SEC / chain->config.maxRate;
+    uint64_t    next        = GIPY_clockNow();
+    uint64_t    written     = 0;
+    int         nbBits      = (chain->config.nbOutputs > chain->config.nbInputs)
+                                ? chain->config.nbOutputs : chain->config.nbInputs;
+    dbgInfo("Start shift thread");
+
+    while(__atomic_load_n(&chain->running, __ATOMIC_ACQUIRE) == TRUE){
+        uint64_t now = GIPY_clockNow();
+        if(next > now){
+            GIPY_clockSleep(next - now);
+        }
+        else if(now - next > period){
+            next = now; //Late: no burst of refreshes to catch up
+        }
+        next += period;
+
+        //Started before the image is loaded: a sync seeing the previous
+        //count waits for a period reading its image (See GIPY_shiftSync)
+        __atomic_add_fetch(&chain->started, 1, __ATOMIC_SEQ_CST);
+        uint64_t    image       = __atomic_load_n(&chain->outputs, __ATOMIC_SEQ_CST);
+        int         isForced    = __atomic_exchange_n(&chain->isForced, FALSE, __ATOMIC_ACQ_REL);
+        if(image == written && isForced == FALSE && chain->config.nbInputs == 0){
+            chain->stats.skipped++;
+            __atomic_add_fetch(&chain->finished, 1, __ATOMIC_ACQ_REL); //Already on the outputs
+            continue;
+        }
+
+        uint64_t inputs = 0;
+        uint64_t start  = GIPY_clockNow();
+        pirror   err    = refresh(chain, image, &inputs);
+        chain->stats.time += GIPY_clockNow() - start;
+        if(err == GE_OK){
+            written = image;
+            __atomic_store_n(&chain->inputs, inputs, __ATOMIC_RELEASE);
+            chain->stats.refreshes++;
+            chain->stats.bits += nbBits;
+        }
+        else{
+            __atomic_store_n(&chain->isForced, TRUE, __ATOMIC_RELEASE);
+            chain->stats.errors++;
+        }
+        __atomic_store_n(&chain->lastError, err, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&chain->finished, 1, __ATOMIC_ACQ_REL);
+    }
+    dbgInfo("Stop shift thread");
+    return NULL;
+}
+
+static pirror refresh(shiftChain *pChain, uint64_t pImage, uint64_t *pInputs){
+    pinBank     *out    = &pChain->out;
+    uint32_t    data    = pChain->dataBit;
+    uint32_t    half    = pChain->config.halfPeriod;
+    int         nbOut   = pChain->config.nbOutputs;
+    int         nbIn    = pChain->config.nbInputs;
+    int         nbBits  = (nbOut > nbIn) ? nbOut : nbIn;
+    uint64_t    edge    = (half != 0) ? GIPY_clockNow() : 0;
+    uint64_t    inputs  = 0;
+    pirror      err     = GE_OK;
+    int         k;
+
+    //Load the 165 inputs (The 595 latches the same outputs again)
+    if(nbIn > 0){
+        err = GIPY_bankWrite(out, LATCH_BIT, 0);
+        waitHalfPeriod(&edge, half);
+        err = (err == GE_OK) ? GIPY_bankWrite(out, LATCH_BIT, LATCH_BIT) : err;
+        waitHalfPeriod(&edge, half);
+    }
+
+    //Last output first: bit 0 ends in the first register. Input before the clock
+    for(k=0; k<nbBits && err == GE_OK; k++){
+        int         shift   = nbBits - 1 - k;
+        uint32_t    level   = ((pImage >> shift) & 0x01) ? data : 0;
+        if(nbIn > 0 && k < nbIn){
+            uint32_t bit = 0;
+            err = GIPY_bankRead(&pChain->in, 0x01, &bit);
+            inputs |= (uint64_t)bit << k;
+        }
+        err = (err == GE_OK) ? GIPY_bankWrite(out, CLOCK_BIT | data, level) : err;
+        waitHalfPeriod(&edge, half);
+        err = (err == GE_OK) ? GIPY_bankWrite(out, CLOCK_BIT, CLOCK_BIT) : err;
+        waitHalfPeriod(&edge, half);
+    }
+    err = (err == GE_OK) ? GIPY_bankWrite(out, CLOCK_BIT, 0) : err;
+
+    //Latch the 595 outputs (Rising edge)
+    if(nbOut > 0 && err == GE_OK){
+        waitHalfPeriod(&edge, half);
+        err = GIPY_bankWrite(out, LATCH_BIT, 0);
+        waitHalfPeriod(&edge, half);
+        err = (err == GE_OK) ? GIPY_bankWrite(out, LATCH_BIT, LATCH_BIT) : err;
+    }
+    if(err != GE_OK){
+        dbgError("Shift chain refresh failed (Clock: %d)", pChain->config.pinClock);
+    }
+    *pInputs = inputs;
+    return err;
+}
+
+
+//------------------------------------------------------------------------------
+// Virtual pins functions
+//------------------------------------------------------------------------------
+static pirror virtualRead(void *pChain, int pIndex, int *pRead){
+    shiftChain *chain = (shiftChain *)pChain;
+    if(pIndex < chain->config.nbOutputs){
+        *pRead = (int)((__atomic_load_n(&chain->outputs, __ATOMIC_ACQUIRE) >> pIndex) & 0x01);
+    }
+    else{
+        *pRead = (int)((GIPY_shiftRead(chain) >> (pIndex - chain->config.nbOutputs)) & 0x01);
+    }
+    return GE_OK;
+}
+
+static pirror virtualWrite(void *pChain, int pIndex, int pValue){
+    shiftChain *chain = (shiftChain *)pChain;
+    if(pIndex >= chain->config.nbOutputs){
+        dbgError("Shift chain pin %d is an input", pIndex);
+        return GE_PINDIR;
+    }
+    GIPY_shiftWrite(chain, 1ULL << pIndex, (uint64_t)(pValue & 0x01) << pIndex);
+    return GE_OK;
+}
+
+static pirror virtualSetDirection(void *pChain, int pIndex, pinDirection pDir){
+    shiftChain *chain = (shiftChain *)pChain;
+    if(pIndex >= chain->config.nbOutputs){
+        return (pDir == IN) ? GE_OK : GE_PINDIR;
+    }
+    switch(pDir){
+        case OUT:
+            return GE_OK;
+        case LOW:
+            return virtualWrite(pChain, pIndex, LOGIC_ZERO);
+        case HIGH:
+            return virtualWrite(pChain, pIndex, LOGIC_ONE);
+        default:
+            return GE_PINDIR;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static inline void waitHalfPeriod(uint64_t *pStart, uint32_t pHalfPeriod){
+    if(pHalfPeriod == 0){
+        return;
+    }
+    uint64_t now;
+    do{
+        now = GIPY_clockNow();
+    }while(now - *pStart < pHalfPeriod);
+    *pStart = now;
+}
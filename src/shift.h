@@ -0,0 +1,177 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Shift
+ * Shift register chains (74HC595 outputs, 74HC165 inputs) as virtual pins
+ *
+ * CHAIN
+ * Registers share the clock and latch lines. The latch line is the 595
+ * RCLK and the 165 SH/LD (Idle high): a low pulse loads the 165 inputs,
+ * its rising edge latches the 595 outputs. The data line is the 595 SER of
+ * the first register, the input line is the 165 QH of the first register.
+ * A refresh is one latch pulse (Inputs only), then one clock per bit with
+ * the data set while the clock is low and the input read before the
+ * rising edge, then one latch pulse (Outputs only). The lines are one pin
+ * bank (See bank.h): the fastest backend, data and clock in one write.
+ *
+ * SHADOW IMAGE
+ * Outputs are written in a shadow image (Bit k is output k, QA of the
+ * first register is bit 0). A refresh thread runs at most 'maxRate' times
+ * per second and shifts the image only if it changed since the last
+ * refresh (Always with inputs, to sample them). Writes between two
+ * refreshes are merged in one. GIPY_shiftSync waits till the image is on
+ * the outputs. Inputs are read from the image of the last refresh (Bit k is
+ * the k-th bit shifted in).
+ *
+ * VIRTUAL PINS
+ * With 'pinBase' set, outputs are the pins pinBase to pinBase + nbOutputs
+ * - 1, inputs are the next ones. They are used with the pin functions
+ * (GIPY_pinWrite, GIPY_pinRead, GIPY_pinSetDirection), which only change
+ * or read the images: no IO in the caller.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_SHIFT_H_
+#define _HEADER_SHIFT_H_
+
+#include "gipy.h"
+#include "bank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define SHIFT_NO_PIN        -1
+#define SHIFT_MAX_BITS      64 //Max outputs and max inputs (8 registers)
+#define SHIFT_DEFAULT_RATE  1000 //Refreshes per second if maxRate is 0
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Shift register chain configuration
+ */
+typedef struct {
+    int         pinData;    //595 SER (SHIFT_NO_PIN if no outputs)
+    int         pinClock;   //595 SRCLK and 165 CLK
+    int         pinLatch;   //595 RCLK and 165 SH/LD
+    int         pinIn;      //165 QH (SHIFT_NO_PIN if no inputs)
+    int         nbOutputs;
+    int         nbInputs;
+    int         pinBase;    //First virtual pin (SHIFT_NO_PIN for none)
+    uint32_t    maxRate;    //Max refreshes per second
+    uint32_t    halfPeriod; //Min ns between two clock edges (0: full speed)
+} shiftConfig;
+
+/**
+ * \brief Refresh statistics (Filled by the refresh thread)
+ */
+typedef struct {
+    uint64_t    refreshes;  //Refreshes done
+    uint64_t    skipped;    //Periods without refresh (Image not changed)
+    uint64_t    errors;     //Failed refreshes
+    uint64_t    bits;       //Bits shifted
+    uint64_t    time;       //Time shifting (ns), bits/s is bits * 1e9 / time
+} shiftStats;
+
+/**
+ * \brief Shift register chain. Output bank: clock, latch, then data
+ */
+typedef struct {
+    shiftConfig config;
+    pinBank     out;
+    pinBank     in;
+    uint32_t    dataBit;    //0 if no outputs
+    uint64_t    outputs;    //Shadow image of the outputs
+    uint64_t    inputs;     //Inputs of the last refresh
+    uint64_t    started;    //Periods started, skipped ones included (Sync)
+    uint64_t    finished;   //Periods finished, skipped ones included (Sync)
+    int         isForced;   //Refresh at the next period, changed or not
+    pirror      lastError;  //Result of the last refresh
+    shiftStats  stats;
+    int         running;
+    pthread_t   thread;
+} shiftChain;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a chain and start its refresh thread
+ * \details         Pins must be exported. Directions are set by this
+ *                  function (Clock low, latch high, data low). Outputs
+ *                  start low (First refresh). The chain must stay valid
+ *                  while opened.
+ *
+ * \param pChain    Chain to initialize
+ * \param pConfig   Chain configuration
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid configuration, or virtual pins already used
+ * \return GE_PERM  If a pin is not exported
+ * \return GE_IO    If unable to set a pin direction
+ */
+pirror GIPY_shiftOpen(shiftChain*, const shiftConfig*);
+
+/**
+ * \brief           Stop the refresh thread and close the chain
+ * \details         Virtual pins are removed. Outputs keep their last level.
+ *
+ * \param pChain    Opened chain
+ * \return void
+ */
+void GIPY_shiftClose(shiftChain*);
+
+/**
+ * \brief           Change outputs in the shadow image (Any thread)
+ *
+ * \param pChain    Opened chain
+ * \param pMask     Outputs to change (Bit k is output k)
+ * \param pValues   New levels of these outputs
+ * \return void
+ */
+void GIPY_shiftWrite(shiftChain*, uint64_t, uint64_t);
+
+/**
+ * \brief           Get the inputs of the last refresh (Any thread)
+ *
+ * \param pChain    Opened chain
+ * \return          Inputs image (Bit k is input k)
+ */
+uint64_t GIPY_shiftRead(shiftChain*);
+
+/**
+ * \brief           Wait for a refresh started after this call
+ * \details         The outputs written before are then on the pins and the
+ *                  inputs are read after the call. Waits at most one period
+ *                  plus one refresh.
+ *
+ * \param pChain    Opened chain
+ * \return GE_OK    If no error
+ * \return GE_IO    If the refresh failed
+ */
+pirror GIPY_shiftSync(shiftChain*);
+
+/**
+ * \brief           Get the refresh statistics
+ *
+ * \param pChain    Opened chain
+ * \param pStats    Filled with the statistics
+ * \return void
+ */
+void GIPY_shiftGetStats(shiftChain*, shiftStats*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,791 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Simulator
+ * Simulated GPIO backend with synthetic edge generators
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "simul.h"
+#include "pwm.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   State of a simulated line
+ */
+typedef struct {
+    int             pin;            //Pin number of the line
+    int             active;         //TRUE if the stream is running
+    simStream       stream;
+    uint64_t        nextEdge;       //Clock time of the next edge
+    uint64_t        burstStart;     //Clock time of the current burst start
+    int             burstLeft;      //Edges left in the current burst
+    uint32_t        rng;            //Xorshift state
+    int             level;          //Current line level
+    pinEdge         edge;           //Edge setting (Which edges are notified)
+    int             pending;        //TRUE if a notification is pending
+    uint64_t        pendingStamp;   //Timestamp of the pending edge
+    simStats        stats;
+    int             valueFd;        //Simulated value file (-1 if none)
+    pthread_cond_t  cond;           //Signaled when a notification is pending
+} simPin;
+
+/**
+ * \brief   Get the simulated line of a pin
+ *
+ * \param   int the pin number
+ * \return  Line of the pin, NULL if not a valid pin (Or not enabled)
+ */
+static simPin *getSimPin(const int);
+
+/**
+ * \brief   Close the value file and remove the gpioX folder of a line
+ */
+static void removeGpioFolder(simPin*);
+
+/**
+ * \brief   Remove the pwmM folder of a PWM channel
+ */
+static void removePwmFolder(int, int);
+
+/**
+ * \brief   Create (or remove) the simulated pwm tree (Part of buildTree)
+ *
+ * \param   pCreate TRUE to create, FALSE to remove
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror buildPwmTree(int);
+
+/**
+ * \brief   Create (or remove) the simulated sysfs tree
+ *
+ * \param   pCreate TRUE to create, FALSE to remove
+ * \return  GE_OK if no error, otherwise GE_IO
+ */
+static pirror buildTree(int);
+
+/**
+ * \brief   Generator thread. Apply all due edges then sleep till the next one
+ */
+static void *generatorThread(void*);
+
+/**
+ * \brief   Toggle the line and update the notification state (Lock held)
+ *
+ * \param   pSim    Line to toggle
+ * \param   pStamp  Edge timestamp
+ * \return  void
+ */
+static void applyEdge(simPin*, uint64_t);
+
+/**
+ * \brief   Compute the time of the next edge of a stream (Lock held)
+ *
+ * \param   pSim    Line with an active stream
+ * \param   pFirst  TRUE if this is the first edge (Stream start)
+ * \return  void
+ */
+static void scheduleNext(simPin*, int);
+
+/**
+ * \brief   Write the current level in the simulated value file (Lock held)
+ */
+static void writeLevel(simPin*);
+
+/**
+ * \brief   Write a whole simulated file
+ *
+ * \return  Opened file if pKeep is TRUE, 0 if closed, -1 if error
+ */
+static int writeFile(const char*, const char*, int);
+
+/**
+ * \brief   Random number in ]0,1] (Xorshift32)
+ */
+static double randomUnit(uint32_t*);
+
+/**
+ * \brief   Initialize a condition with CLOCK_MONOTONIC
+ */
+static void initCondition(pthread_cond_t*);
+
+static int              enabled     = FALSE;
+static int              running     = FALSE;
+static int              createdRoot = FALSE;
+static char             simRoot[PATH_MAX];
+static simPin           *simPins    = NULL; //One per slot (See gipyPinSlot)
+static int              nbSimPins   = 0;
+static int              nbWaiters   = 0; //Handlers in simWaitEdge
+static gpioChip         simChips[SIM_MAX_CHIPS] = {SIM_DEFAULT_CHIP};
+static int              nbSimChips  = 1;
+static pthread_t        generatorId;
+static pthread_mutex_t  simLock     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   generatorCond;
+static pthread_cond_t   drainCond   = PTHREAD_COND_INITIALIZER;
+
+
+//------------------------------------------------------------------------------
+// Simulator control
+//------------------------------------------------------------------------------
+pirror GIPY_simSetChips(const gpioChip *pChips, int pNbChips){
+    if(enabled == TRUE){
+        dbgError("Simulator chips can not change while enabled");
+        return GE_PERM;
+    }
+    if(pChips == NULL || pNbChips < 1 || pNbChips > SIM_MAX_CHIPS){
+        return GE_PARAM;
+    }
+    int k, n;
+    for(k=0; k<pNbChips; k++){
+        if(pChips[k].base < 0 || pChips[k].ngpio <= 0){
+            dbgError("Invalid simulated chip (Base: %d, ngpio: %d)",
+                    pChips[k].base, pChips[k].ngpio);
+            return GE_PARAM;
+        }
+        for(n=0; n<k; n++){
+            if(pChips[k].base < pChips[n].base + pChips[n].ngpio
+                    && pChips[n].base < pChips[k].base + pChips[k].ngpio){
+                dbgError("Simulated chips %d and %d overlap", n, k);
+                return GE_PARAM;
+            }
+        }
+    }
+    memcpy(simChips, pChips, pNbChips * sizeof(gpioChip));
+    nbSimChips = pNbChips;
+    return GE_OK;
+}
+
+pirror GIPY_simEnable(const char *pRoot, double pSpeed){
+    dbgInfo("Try to enable simulator (Root: %s, speed: %f)", pRoot, pSpeed);
+    if(enabled == TRUE){
+        dbgError("Simulator already enabled");
+        return GE_PERM;
+    }
+    if(pSpeed < 0.0){
+        dbgError("Invalid simulator speed: %f", pSpeed);
+        return GE_PARAM;
+    }
+
+    //Create the root folder (Temporary one if not given)
+    if(pRoot == NULL){
+        strcpy(simRoot, SIM_ROOT_TEMPLATE);
+        if(mkdtemp(simRoot) == NULL){
+            dbgError("Unable to create temporary folder "SIM_ROOT_TEMPLATE);
+            return GE_IO;
+        }
+        createdRoot = TRUE;
+    }
+    else{
+        if(strlen(pRoot) + 2 > sizeof(simRoot)){
+            return GE_PARAM;
+        }
+        strcpy(simRoot, pRoot);
+        if(mkdir(simRoot, 0755) == -1 && errno != EEXIST){
+            dbgError("Unable to create simulator root %s", simRoot);
+            return GE_IO;
+        }
+        createdRoot = FALSE;
+    }
+    if(simRoot[strlen(simRoot)-1] != '/'){
+        strcat(simRoot, "/");
+    }
+
+    if(buildTree(TRUE) != GE_OK){
+        buildTree(FALSE);
+        return GE_IO;
+    }
+
+    //Switch the library on the simulated tree (Pin table built from its chips)
+    if(GIPY_setSysfsRoot(simRoot) != GE_OK){
+        buildTree(FALSE);
+        return GE_PERM;
+    }
+    nbSimPins   = gipyPinSlotCount();
+    simPins     = calloc((nbSimPins > 0) ? nbSimPins : 1, sizeof(simPin));
+    if(simPins == NULL){
+        GIPY_setSysfsRoot(NULL);
+        buildTree(FALSE);
+        return GE_IO;
+    }
+    int k, n;
+    for(k=0; k<nbSimChips; k++){
+        for(n=0; n<simChips[k].ngpio; n++){
+            int     pin = simChips[k].base + n;
+            simPin  *sim = &simPins[gipyPinSlot(pin)];
+            sim->pin        = pin;
+            sim->valueFd    = -1;
+            sim->edge       = NONE;
+            initCondition(&sim->cond);
+        }
+    }
+    GIPY_clockSetVirtual(pSpeed);
+    initCondition(&generatorCond);
+    enabled = TRUE;
+    running = TRUE;
+    pthread_create(&generatorId, NULL, &generatorThread, NULL);
+    dbgInfo("Simulator enabled in %s", simRoot);
+    return GE_OK;
+}
+
+pirror GIPY_simDisable(void){
+    dbgInfo("Try to disable simulator");
+    if(enabled == FALSE){
+        return GE_PERM;
+    }
+    if(GIPY_setSysfsRoot(NULL) != GE_OK){
+        dbgError("Pins must be unexported before disabling the simulator");
+        return GE_PERM;
+    }
+
+    //Stop generator
+    pthread_mutex_lock(&simLock);
+    running = FALSE;
+    pthread_cond_signal(&generatorCond);
+    pthread_mutex_unlock(&simLock);
+    pthread_join(generatorId, NULL);
+
+    //Release waiting handlers before freeing the lines
+    int k;
+    pthread_mutex_lock(&simLock);
+    enabled = FALSE;
+    for(k=0; k<nbSimPins; k++){
+        pthread_cond_broadcast(&simPins[k].cond);
+    }
+    while(nbWaiters > 0){
+        pthread_cond_wait(&drainCond, &simLock);
+    }
+    pthread_mutex_unlock(&simLock);
+
+    //Restore real environment
+    GIPY_clockSetReal();
+    buildTree(FALSE);
+    for(k=0; k<nbSimPins; k++){
+        pthread_cond_destroy(&simPins[k].cond);
+    }
+    free(simPins);
+    simPins     = NULL;
+    nbSimPins   = 0;
+    dbgInfo("Simulator disabled");
+    return GE_OK;
+}
+
+int GIPY_simIsEnabled(void){
+    return enabled;
+}
+
+pirror GIPY_simSetStream(int pPin, const simStream *pStream){
+    if(enabled == FALSE){
+        return GE_PERM;
+    }
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        dbgError("Invalid pin number: %d", pPin);
+        return GE_PIN;
+    }
+
+    //Check stream parameters
+    if(pStream != NULL){
+        int isBurst = (pStream->profile == SIM_BURSTY || pStream->profile == SIM_BOUNCE);
+        if(pStream->rate <= 0.0
+                || (isBurst && pStream->burstRate <= 0.0)
+                || (pStream->profile == SIM_BURSTY && pStream->burstSize < 1)
+                || (pStream->profile == SIM_BOUNCE && pStream->burstSize < 0)
+                || pStream->profile > SIM_BOUNCE){
+            dbgError("Invalid stream for pin %d", pPin);
+            return GE_PARAM;
+        }
+    }
+
+    pthread_mutex_lock(&simLock);
+    sim->active = FALSE;
+    if(pStream != NULL){
+        sim->stream = *pStream;
+        sim->rng    = (pStream->seed != 0) ? pStream->seed : 2463534242U;
+        scheduleNext(sim, TRUE);
+        sim->active = TRUE;
+    }
+    pthread_cond_signal(&generatorCond);
+    pthread_mutex_unlock(&simLock);
+    return GE_OK;
+}
+
+pirror GIPY_simSetLevel(int pPin, pinValue pValue){
+    if(enabled == FALSE){
+        return GE_PERM;
+    }
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        return GE_PIN;
+    }
+    if(pValue != LOGIC_ZERO && pValue != LOGIC_ONE){
+        return GE_PINVAL;
+    }
+    pthread_mutex_lock(&simLock);
+    if(sim->level != (int)pValue){
+        int wasPending = sim->pending;
+        applyEdge(sim, GIPY_clockNow());
+        writeLevel(sim);
+        if(wasPending == FALSE && sim->pending == TRUE){
+            pthread_cond_signal(&sim->cond);
+        }
+    }
+    pthread_mutex_unlock(&simLock);
+    return GE_OK;
+}
+
+pirror GIPY_simGetStats(int pPin, simStats *pStats){
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        return GE_PIN;
+    }
+    if(pStats == NULL){
+        return GE_PARAM;
+    }
+    pthread_mutex_lock(&simLock);
+    *pStats = sim->stats;
+    pthread_mutex_unlock(&simLock);
+    return GE_OK;
+}
+
+pirror GIPY_simResetStats(int pPin){
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        return GE_PIN;
+    }
+    pthread_mutex_lock(&simLock);
+    memset(&sim->stats, 0, sizeof(simStats));
+    pthread_mutex_unlock(&simLock);
+    return GE_OK;
+}
+
+
+//------------------------------------------------------------------------------
+// Library internal functions
+//------------------------------------------------------------------------------
+pirror simExport(int pPin){
+    static const char *files[]      = {"direction", "edge", "value"};
+    static const char *defaults[]   = {"in\n", "none\n", "0\n"};
+    char path[PATH_MAX + 32];
+    char content[1];
+    int f, fd;
+
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        return GE_IO;
+    }
+    snprintf(path, sizeof(path), "%sgpio%d", simRoot, pPin);
+    if(mkdir(path, 0755) == -1 && errno != EEXIST){
+        dbgError("Unable to create simulated folder %s", path);
+        return GE_IO;
+    }
+    pthread_mutex_lock(&simLock);
+    for(f=0; f<3 && sim->valueFd == -1; f++){
+        //Files left by a previous run are kept (Pin still exported)
+        snprintf(path, sizeof(path), "%sgpio%d/%s", simRoot, pPin, files[f]);
+        fd = open(path, O_RDWR);
+        if(fd == -1){
+            fd = writeFile(path, defaults[f], (f == 2) ? TRUE : FALSE);
+        }
+        else if(f != 2){
+            close(fd);
+            continue;
+        }
+        else{
+            sim->level = (pread(fd, content, 1, 0) == 1 && content[0] == '1') ? 1 : 0;
+        }
+        if(fd == -1){
+            pthread_mutex_unlock(&simLock);
+            return GE_IO;
+        }
+        if(f == 2){
+            sim->valueFd = fd; //Kept open by the generator
+            writeLevel(sim);
+        }
+    }
+    pthread_mutex_unlock(&simLock);
+    return GE_OK;
+}
+
+void simUnexport(int pPin){
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        return;
+    }
+    pthread_mutex_lock(&simLock);
+    removeGpioFolder(sim);
+    pthread_mutex_unlock(&simLock);
+}
+
+pirror simPwmExport(int pChip, int pChannel){
+    static const char *files[]      = {"period", "duty_cycle", "polarity", "enable"};
+    static const char *defaults[]   = {"0\n", "0\n", "normal\n", "0\n"};
+    char root[PATH_MAX];
+    char path[PATH_MAX + 64];
+    int f;
+
+    if(pChip < 0 || pChip >= SIM_PWM_CHIPS || pChannel < 0 || pChannel >= SIM_PWM_CHANNELS){
+        return GE_PARAM;
+    }
+    pwmRootOf(simRoot, root);
+    snprintf(path, sizeof(path), "%spwmchip%d/pwm%d", root, pChip, pChannel);
+    if(mkdir(path, 0755) == -1){
+        return (errno == EEXIST) ? GE_OK : GE_IO; //Exported again: state kept
+    }
+    for(f=0; f<4; f++){
+        snprintf(path, sizeof(path), "%spwmchip%d/pwm%d/%s", root, pChip, pChannel, files[f]);
+        if(writeFile(path, defaults[f], FALSE) == -1){
+            dbgError("Unable to create simulated file %s", path);
+            return GE_IO;
+        }
+    }
+    return GE_OK;
+}
+
+void simPwmUnexport(int pChip, int pChannel){
+    if(pChip >= 0 && pChip < SIM_PWM_CHIPS && pChannel >= 0 && pChannel < SIM_PWM_CHANNELS){
+        removePwmFolder(pChip, pChannel);
+    }
+}
+
+void simSetEdge(int pPin, pinEdge pEdge){
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        return;
+    }
+    pthread_mutex_lock(&simLock);
+    sim->edge       = pEdge;
+    sim->pending    = FALSE; //Notified with the previous setting
+    pthread_mutex_unlock(&simLock);
+}
+
+int simWaitEdge(int pPin, uint64_t pDeadline, uint64_t *pStamp){
+    struct timespec deadline;
+    int             isEdge = FALSE;
+
+    GIPY_clockToWall(pDeadline, SIM_WAIT_TIMEOUT, &deadline);
+    pthread_mutex_lock(&simLock);
+    simPin *sim = getSimPin(pPin);
+    if(sim == NULL){
+        pthread_mutex_unlock(&simLock);
+        return FALSE; //Disabled
+    }
+    nbWaiters++;
+    while(enabled == TRUE && sim->pending == FALSE){
+        if(pthread_cond_timedwait(&sim->cond, &simLock, &deadline) != 0){
+            break; //Timeout
+        }
+    }
+    if(sim->pending == TRUE){
+        sim->pending    = FALSE;
+        *pStamp         = sim->pendingStamp;
+        isEdge          = TRUE;
+    }
+    if(--nbWaiters == 0 && enabled == FALSE){
+        pthread_cond_signal(&drainCond); //GIPY_simDisable may free the lines
+    }
+    pthread_mutex_unlock(&simLock);
+    return isEdge;
+}
+
+
+//------------------------------------------------------------------------------
+// Generator functions
+//------------------------------------------------------------------------------
+static void *generatorThread(void *pUnused){
+    struct timespec deadline;
+    dbgInfo("Start simulator generator");
+
+    pthread_mutex_lock(&simLock);
+    while(running == TRUE){
+        uint64_t now    = GIPY_clockNow();
+        uint64_t next   = UINT64_MAX;
+        int k;
+
+        //Apply all edges due so far (Merged in one value write per pin)
+        for(k=0; k<nbSimPins; k++){
+            simPin *sim = &simPins[k];
+            if(sim->active == FALSE){
+                continue;
+            }
+            int wasPending  = sim->pending;
+            int wasLevel    = sim->level;
+            while(sim->active == TRUE && sim->nextEdge <= now){
+                applyEdge(sim, sim->nextEdge);
+                scheduleNext(sim, FALSE);
+                if(sim->stream.maxEdges != 0
+                        && sim->stats.generated >= sim->stream.maxEdges){
+                    sim->active = FALSE;
+                }
+            }
+            if(sim->level != wasLevel){
+                writeLevel(sim);
+            }
+            if(wasPending == FALSE && sim->pending == TRUE){
+                pthread_cond_signal(&sim->cond);
+            }
+            if(sim->active == TRUE && sim->nextEdge < next){
+                next = sim->nextEdge;
+            }
+        }
+
+        //Sleep till the next edge (Or a stream change)
+        GIPY_clockToWall(next, SIM_WAIT_TIMEOUT, &deadline);
+        pthread_cond_timedwait(&generatorCond, &simLock, &deadline);
+    }
+    pthread_mutex_unlock(&simLock);
+    dbgInfo("Simulator generator stopped");
+    return NULL;
+}
+
+static void applyEdge(simPin *pSim, uint64_t pStamp){
+    pSim->level ^= 1;
+    pSim->stats.generated++;
+
+    //Only edges matching the edge setting are notified
+    int isNotified = (pSim->edge == BOTH)
+        || (pSim->edge == RISING && pSim->level == 1)
+        || (pSim->edge == FALLING && pSim->level == 0);
+    if(isNotified == FALSE){
+        return;
+    }
+    pSim->stats.notified++;
+    if(pSim->pending == TRUE){
+        pSim->stats.merged++; //Same as the kernel: one pending event at most
+        return;
+    }
+    pSim->pending       = TRUE;
+    pSim->pendingStamp  = pStamp;
+}
+
+static void scheduleNext(simPin *pSim, int pFirst){
+    simStream   *st     = &pSim->stream;
+    uint64_t    now     = (pFirst == TRUE) ? GIPY_clockNow() : pSim->nextEdge;
+    double      period  = (double)NSEC_PER_SEC / st->rate;
+    double      inBurst = (st->burstRate > 0.0) ? (double)NSEC_PER_SEC / st->burstRate : 0.0;
+
+    switch(st->profile){
+        case SIM_FIXED:
+            pSim->nextEdge = now + (uint64_t)period;
+            break;
+        case SIM_POISSON:
+            pSim->nextEdge = now + (uint64_t)(-log(randomUnit(&pSim->rng)) * period);
+            break;
+        case SIM_BURSTY:
+        case SIM_BOUNCE:
+            //A bounce toggle is the clean edge plus burstSize back and forth
+            if(pFirst == FALSE && --pSim->burstLeft > 0){
+                double gap = inBurst;
+                if(st->profile == SIM_BOUNCE){
+                    gap *= 0.5 + randomUnit(&pSim->rng); //Bounces are irregular
+                }
+                pSim->nextEdge = now + (uint64_t)gap;
+                break;
+            }
+            pSim->burstStart    = ((pFirst == TRUE) ? now : pSim->burstStart) + (uint64_t)period;
+            pSim->burstLeft     = (st->profile == SIM_BOUNCE) ? 2*st->burstSize + 1 : st->burstSize;
+            pSim->nextEdge      = (pSim->burstStart > now) ? pSim->burstStart : now + 1;
+            break;
+    }
+    if(pSim->nextEdge <= now){
+        pSim->nextEdge = now + 1; //Rates above 1GHz are not simulated
+    }
+}
+
+static void writeLevel(simPin *pSim){
+    if(pSim->valueFd != -1){
+        pwrite(pSim->valueFd, (pSim->level == 1) ? "1\n" : "0\n", 2, 0);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static simPin *getSimPin(const int pPin){
+    if(enabled == FALSE){
+        return NULL; //Pin table may already be the real one
+    }
+    int slot = gipyPinSlot(pPin);
+    if(slot < 0 || slot >= nbSimPins){
+        return NULL;
+    }
+    return &simPins[slot];
+}
+
+static void removeGpioFolder(simPin *pSim){
+    static const char *files[] = {"direction", "edge", "value"};
+    char path[PATH_MAX + 32];
+    int f;
+
+    if(pSim->valueFd != -1){
+        close(pSim->valueFd);
+        pSim->valueFd = -1;
+    }
+    for(f=0; f<3; f++){
+        snprintf(path, sizeof(path), "%sgpio%d/%s", simRoot, pSim->pin, files[f]);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%sgpio%d", simRoot, pSim->pin);
+    rmdir(path);
+}
+
+static pirror buildTree(int pCreate){
+    static const char *files[] = {"base", "ngpio", "label"};
+    char path[PATH_MAX + 64];
+    char content[64];
+    int k, f;
+
+    //Export and unexport files
+    for(f=0; f<2; f++){
+        snprintf(path, sizeof(path), "%s%s", simRoot, (f == 0) ? "export" : "unexport");
+        if(pCreate == FALSE){
+            unlink(path);
+        }
+        else if(writeFile(path, "", FALSE) == -1){
+            return GE_IO;
+        }
+    }
+
+    //Remaining gpioX folders (Export failed on library side)
+    for(k=0; k<nbSimPins && pCreate == FALSE; k++){
+        removeGpioFolder(&simPins[k]);
+    }
+
+    //One folder per chip
+    for(k=0; k<nbSimChips; k++){
+        for(f=0; f<3; f++){
+            if(f == 0){
+                snprintf(path, sizeof(path), "%sgpiochip%d", simRoot, simChips[k].base);
+                if(pCreate == TRUE && mkdir(path, 0755) == -1 && errno != EEXIST){
+                    dbgError("Unable to create simulated folder %s", path);
+                    return GE_IO;
+                }
+            }
+            snprintf(path, sizeof(path), "%sgpiochip%d/%s", simRoot, simChips[k].base, files[f]);
+            if(pCreate == FALSE){
+                unlink(path);
+                continue;
+            }
+            switch(f){
+                case 0:     sprintf(content, "%d\n", simChips[k].base); break;
+                case 1:     sprintf(content, "%d\n", simChips[k].ngpio); break;
+                default:    snprintf(content, sizeof(content), "%s\n", simChips[k].label);
+            }
+            if(writeFile(path, content, FALSE) == -1){
+                return GE_IO;
+            }
+        }
+        if(pCreate == FALSE){
+            snprintf(path, sizeof(path), "%sgpiochip%d", simRoot, simChips[k].base);
+            rmdir(path);
+        }
+    }
+    if(buildPwmTree(pCreate) != GE_OK){
+        return GE_IO;
+    }
+    if(pCreate == FALSE && createdRoot == TRUE){
+        rmdir(simRoot);
+    }
+    return GE_OK;
+}
+
+static void removePwmFolder(int pChip, int pChannel){
+    static const char *files[] = {"period", "duty_cycle", "polarity", "enable"};
+    char root[PATH_MAX];
+    char path[PATH_MAX + 64];
+    int f;
+
+    pwmRootOf(simRoot, root);
+    for(f=0; f<4; f++){
+        snprintf(path, sizeof(path), "%spwmchip%d/pwm%d/%s", root, pChip, pChannel, files[f]);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%spwmchip%d/pwm%d", root, pChip, pChannel);
+    rmdir(path);
+}
+
+static pirror buildPwmTree(int pCreate){
+    static const char *files[] = {"export", "unexport", "npwm"};
+    char root[PATH_MAX];
+    char path[PATH_MAX + 64];
+    char content[16];
+    int k, f;
+
+    pwmRootOf(simRoot, root);
+    if(pCreate == TRUE && mkdir(root, 0755) == -1 && errno != EEXIST){
+        dbgError("Unable to create simulated folder %s", root);
+        return GE_IO;
+    }
+    for(k=0; k<SIM_PWM_CHIPS; k++){
+        snprintf(path, sizeof(path), "%spwmchip%d", root, k);
+        if(pCreate == TRUE && mkdir(path, 0755) == -1 && errno != EEXIST){
+            dbgError("Unable to create simulated folder %s", path);
+            return GE_IO;
+        }
+        for(f=0; f<3; f++){
+            snprintf(path, sizeof(path), "%spwmchip%d/%s", root, k, files[f]);
+            if(pCreate == FALSE){
+                unlink(path);
+                continue;
+            }
+            content[0] = '\0';
+            if(f == 2){
+                sprintf(content, "%d\n", SIM_PWM_CHANNELS);
+            }
+            if(writeFile(path, content, FALSE) == -1){
+                return GE_IO;
+            }
+        }
+        if(pCreate == FALSE){
+            //Remaining pwmM folders (Not unexported)
+            for(f=0; f<SIM_PWM_CHANNELS; f++){
+                removePwmFolder(k, f);
+            }
+            snprintf(path, sizeof(path), "%spwmchip%d", root, k);
+            rmdir(path);
+        }
+    }
+    if(pCreate == FALSE){
+        rmdir(root);
+    }
+    return GE_OK;
+}
+
+static int writeFile(const char *pPath, const char *pContent, int pKeep){
+    int fd = open(pPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd == -1 || write(fd, pContent, strlen(pContent)) == -1){
+        dbgError("Unable to create simulated file %s", pPath);
+        if(fd != -1){
+            close(fd);
+        }
+        return -1;
+    }
+    if(pKeep == TRUE){
+        return fd;
+    }
+    close(fd);
+    return 0;
+}
+
+static double randomUnit(uint32_t *pState){
+    uint32_t x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+    return ((double)(x >> 8) + 1.0) / 16777216.0;
+}
+
+static void initCondition(pthread_cond_t *pCond){
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(pCond, &attr);
+    pthread_condattr_destroy(&attr);
+}
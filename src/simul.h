@@ -0,0 +1,253 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Simulator
+ * Simulated GPIO backend with synthetic edge generators
+ *
+ * SIMULATED SYSFS
+ * When enabled, the library sysfs root is relocated to a generated folder
+ * which mirror /sys/class/gpio (export, unexport, gpiochipN/base, ngpio, 
+ * label). Exporting a pin creates its gpioX/direction, edge and value files.
+ * All pins functions work unchanged on these regular files.
+ * The tree also holds a pwm/ folder (See pwm.h) with SIM_PWM_CHIPS chips of
+ * SIM_PWM_CHANNELS channels: exporting a channel creates its pwmM/period,
+ * duty_cycle, polarity and enable files.
+ * Since poll does not report POLLPRI on regular files, interrupt handlers
+ * wait for the simulator notifications instead.
+ *
+ * EDGE STREAMS
+ * Each input pin can be driven by an edge stream (Fixed rate, Poisson,
+ * bursts or bouncing switch). Edges are timestamped with the library clock
+ * (Virtual clock), which may run faster than real time. Like the kernel
+ * does, only one notification can be pending per pin: edges happening
+ * while one is pending are merged (Counted as merged in the stats).
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_SIMUL_H_
+#define _HEADER_SIMUL_H_
+
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "gipy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define SIM_ROOT_TEMPLATE   "/tmp/gipysim.XXXXXX"
+#define SIM_MAX_CHIPS       8
+#define SIM_DEFAULT_CHIP    {0, 28, "gipysim"} //Same lines as a Raspberry Pi
+#define SIM_WAIT_TIMEOUT    (100*NSEC_PER_MSEC) //Max wall wait of a handler
+#define SIM_PWM_CHIPS       1 //pwmchip0...
+#define SIM_PWM_CHANNELS    2 //Channels per pwmchip (Same as a Raspberry Pi)
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Describe the edge stream profiles
+ */
+typedef enum {
+    SIM_FIXED,      //One edge every 1/rate
+    SIM_POISSON,    //Random edges, rate edges/s in average
+    SIM_BURSTY,     //rate bursts/s, burstSize edges at burstRate in each burst
+    SIM_BOUNCE      //rate switch toggles/s, each with burstSize bounces
+} simProfile;
+
+/**
+ * \brief Describe an edge stream for one pin
+ */
+typedef struct {
+    simProfile  profile;
+    double      rate;       //Edges/s, bursts/s or toggles/s (See profile)
+    int         burstSize;  //Edges per burst / bounces per toggle
+    double      burstRate;  //Edge rate inside a burst or a bounce
+    uint64_t    maxEdges;   //Stop after this number of edges (0: no limit)
+    uint32_t    seed;       //Random seed (Poisson, bounce)
+} simStream;
+
+/**
+ * \brief Generator statistics of a pin
+ */
+typedef struct {
+    uint64_t generated; //Edges generated on the line
+    uint64_t notified;  //Edges matching the pin edge setting
+    uint64_t merged;    //Notified edges merged into a pending one (Dropped)
+} simStats;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Simulator control
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Set the gpiochips of the simulated tree
+ * \details         Must be called before GIPY_simEnable. Lines of the
+ *                  chips must not overlap. Default is SIM_DEFAULT_CHIP.
+ *
+ * \param pChips    Chips to simulate
+ * \param pNbChips  Number of chips (1 to SIM_MAX_CHIPS)
+ * \return GE_OK    If no error
+ * \return GE_PERM  If simulator already enabled
+ * \return GE_PARAM If invalid chips
+ */
+pirror GIPY_simSetChips(const gpioChip*, int);
+
+/**
+ * \brief           Enable the simulated backend
+ * \details         Create the simulated sysfs tree, relocate the library
+ *                  sysfs root to it, switch the clock to virtual mode
+ *                  and start the generator thread.
+ *
+ * \param pRoot     Folder for the simulated sysfs (Temporary one if NULL)
+ * \param pSpeed    Virtual clock speed (See GIPY_clockSetVirtual)
+ * \return GE_OK    If no error
+ * \return GE_PERM  If already enabled (Or pins exported)
+ * \return GE_PARAM If invalid speed
+ * \return GE_IO    If unable to create the tree
+ */
+pirror GIPY_simEnable(const char*, double);
+
+/**
+ * \brief           Disable the simulated backend
+ * \details         Stop generators, restore the sysfs root and real clock,
+ *                  remove the simulated files. Pins must be unexported before.
+ *
+ * \return GE_OK    If no error
+ * \return GE_PERM  If not enabled (Or pins still exported)
+ */
+pirror GIPY_simDisable(void);
+
+/**
+ * \brief           Check whether the simulated backend is enabled
+ *
+ * \return          TRUE if enabled, otherwise FALSE
+ */
+int GIPY_simIsEnabled(void);
+
+/**
+ * \brief           Set the edge stream driving a pin
+ * \details         The stream starts from the current clock time
+ *
+ * \param pPin      Pin to drive
+ * \param pStream   Stream description (NULL to stop the stream)
+ * \return GE_OK    If no error
+ * \return GE_PERM  If simulator not enabled
+ * \return GE_PIN   If invalid pin
+ * \return GE_PARAM If invalid stream parameters
+ */
+pirror GIPY_simSetStream(int, const simStream*);
+
+/**
+ * \brief           Force the level of a simulated line (Generate one edge)
+ *
+ * \param pPin      Pin to drive
+ * \param pValue    New level
+ * \return GE_OK    If no error
+ * \return GE_PERM  If simulator not enabled
+ * \return GE_PIN   If invalid pin
+ * \return GE_PINVAL If invalid value
+ */
+pirror GIPY_simSetLevel(int, pinValue);
+
+/**
+ * \brief           Get the generator statistics of a pin
+ *
+ * \param pPin      Pin number
+ * \param pStats    Structure to fill
+ * \return GE_OK    If no error
+ * \return GE_PIN   If invalid pin
+ * \return GE_PARAM If pStats is NULL
+ */
+pirror GIPY_simGetStats(int, simStats*);
+
+/**
+ * \brief           Reset the generator statistics of a pin
+ *
+ * \param pPin      Pin number
+ * \return GE_OK    If no error
+ * \return GE_PIN   If invalid pin
+ */
+pirror GIPY_simResetStats(int);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Library internal (Called by gipy.c)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Create the simulated gpioX folder of a pin
+ *
+ * \param pPin      Pin number
+ * \return GE_OK    If no error
+ * \return GE_IO    If unable to create the files
+ */
+pirror simExport(int);
+
+/**
+ * \brief           Remove the simulated gpioX folder of a pin
+ *
+ * \param pPin      Pin number
+ * \return void
+ */
+void simUnexport(int);
+
+/**
+ * \brief           Create the simulated pwmM folder of a PWM channel
+ *
+ * \param pChip     Chip number
+ * \param pChannel  Channel number
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid chip or channel
+ * \return GE_IO    If unable to create the files
+ */
+pirror simPwmExport(int, int);
+
+/**
+ * \brief           Remove the simulated pwmM folder of a PWM channel
+ *
+ * \param pChip     Chip number
+ * \param pChannel  Channel number
+ * \return void
+ */
+void simPwmUnexport(int, int);
+
+/**
+ * \brief           Notify the simulator of a pin edge setting change
+ * \details         A pending notification is dropped
+ *
+ * \param pPin      Pin number
+ * \param pEdge     New edge setting
+ * \return void
+ */
+void simSetEdge(int, pinEdge);
+
+/**
+ * \brief           Wait for the next edge notification of a pin
+ * \details         Clear the pending notification. Wait till pDeadline,
+ *                  at most SIM_WAIT_TIMEOUT (wall time).
+ *
+ * \param pPin      Pin number
+ * \param pDeadline Library clock time to stop waiting (UINT64_MAX if none)
+ * \param pStamp    Filled with the edge timestamp (Library clock)
+ * \return          TRUE if an edge was pending, FALSE if timeout
+ */
+int simWaitEdge(int, uint64_t, uint64_t*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,177 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY SPI
+ * Software (Bit-banged) SPI master on GPIO pins
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "spi.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Busy wait till half a clock period elapsed since pStart
+ *
+ * \param   pStart      Time of the last clock edge (Updated)
+ * \param   pHalfPeriod Half period (ns). Nothing done if 0
+ * \return  void
+ */
+static inline void waitHalfPeriod(uint64_t*, uint32_t);
+
+
+//------------------------------------------------------------------------------
+// SPI functions
+//------------------------------------------------------------------------------
+pirror GIPY_spiOpen(spiBus *pBus, const spiConfig *pConfig){
+    dbgInfo("Try to open SPI bus (Clock: %d)", (pConfig) ? pConfig->pinSclk : -1);
+    if(pBus == NULL || pConfig == NULL || pConfig->mode < 0 || pConfig->mode > 3
+            || pConfig->pinSclk == SPI_NO_PIN
+            || (pConfig->pinMosi == SPI_NO_PIN && pConfig->pinMiso == SPI_NO_PIN)){
+        dbgError("Invalid SPI configuration");
+        return GE_PARAM;
+    }
+    memset(pBus, 0, sizeof(spiBus));
+    pBus->config = *pConfig;
+
+    //Set directions: outputs start at their idle level
+    pirror err = GIPY_pinSetDirection(pConfig->pinSclk,
+            (pConfig->mode & SPI_MODE_CPOL) ? HIGH : LOW);
+    if(err == GE_OK && pConfig->pinCs != SPI_NO_PIN){
+        err = GIPY_pinSetDirection(pConfig->pinCs, HIGH);
+    }
+    if(err == GE_OK && pConfig->pinMosi != SPI_NO_PIN){
+        err = GIPY_pinSetDirection(pConfig->pinMosi, LOW);
+    }
+    if(err == GE_OK && pConfig->pinMiso != SPI_NO_PIN){
+        err = GIPY_pinSetDirection(pConfig->pinMiso, IN);
+    }
+    if(err != GE_OK){
+        dbgError("Unable to set SPI pins directions");
+        return err;
+    }
+
+    //Output bank: clock first, then MOSI and CS if used
+    int pins[3];
+    int nbPins      = 0;
+    pins[nbPins++]  = pConfig->pinSclk;
+    pBus->sclkBit   = 1U;
+    if(pConfig->pinMosi != SPI_NO_PIN){
+        pBus->mosiBit   = 1U << nbPins;
+        pins[nbPins++]  = pConfig->pinMosi;
+    }
+    if(pConfig->pinCs != SPI_NO_PIN){
+        pBus->csBit     = 1U << nbPins;
+        pins[nbPins++]  = pConfig->pinCs;
+    }
+    err = GIPY_bankOpen(&pBus->out, pins, nbPins);
+    if(err != GE_OK){
+        return err;
+    }
+    if(pConfig->pinMiso != SPI_NO_PIN){
+        err = GIPY_bankOpen(&pBus->in, &pConfig->pinMiso, 1);
+        if(err != GE_OK){
+            GIPY_bankClose(&pBus->out);
+            return err;
+        }
+    }
+
+    //Shadow image starts with the levels set by the directions
+    uint32_t idle = (pConfig->mode & SPI_MODE_CPOL) ? pBus->sclkBit : 0;
+    GIPY_bankWrite(&pBus->out, pBus->sclkBit | pBus->mosiBit | pBus->csBit, idle | pBus->csBit);
+    dbgInfo("SPI bus opened (Mode %d, backend %s)", pConfig->mode,
+            GIPY_bankBackendName(pBus->out.backend));
+    return GE_OK;
+}
+
+void GIPY_spiClose(spiBus *pBus){
+    GIPY_bankClose(&pBus->out);
+    if(pBus->config.pinMiso != SPI_NO_PIN){
+        GIPY_bankClose(&pBus->in);
+    }
+}
+
+pirror GIPY_spiTransfer(spiBus *pBus, const uint8_t *pTx, uint8_t *pRx, size_t pLen){
+    pinBank     *out    = &pBus->out;
+    uint32_t    sclk    = pBus->sclkBit;
+    uint32_t    mosi    = pBus->mosiBit;
+    uint32_t    idle    = (pBus->config.mode & SPI_MODE_CPOL) ? sclk : 0;
+    uint32_t    active  = idle ^ sclk;
+    uint32_t    half    = pBus->config.halfPeriod;
+    int         isCpha  = pBus->config.mode & SPI_MODE_CPHA;
+    int         isMiso  = (pBus->config.pinMiso != SPI_NO_PIN);
+    uint64_t    edge    = (half != 0) ? GIPY_clockNow() : 0;
+    pirror      err     = GE_OK;
+    size_t      k;
+
+    //Select the slave (Clock at idle level)
+    err = GIPY_bankWrite(out, sclk | pBus->csBit, idle);
+    waitHalfPeriod(&edge, half);
+
+    for(k=0; k<pLen && err == GE_OK; k++){
+        uint8_t txByte  = (pTx != NULL) ? pTx[k] : 0x00;
+        uint8_t rxByte  = 0x00;
+        int     b;
+        for(b=0; b<8 && err == GE_OK; b++){
+            int         shift   = (pBus->config.lsbFirst == TRUE) ? b : 7 - b;
+            uint32_t    data    = ((txByte >> shift) & 0x01) ? mosi : 0;
+            uint32_t    miso    = 0;
+
+            if(isCpha == 0){
+                //Data is set with clock idle, sampled on the leading edge
+                err = GIPY_bankWrite(out, sclk | mosi, idle | data);
+                waitHalfPeriod(&edge, half);
+                err = (err == GE_OK) ? GIPY_bankWrite(out, sclk, active) : err;
+                if(isMiso && err == GE_OK){
+                    err = GIPY_bankRead(&pBus->in, 0x01, &miso);
+                }
+                waitHalfPeriod(&edge, half);
+            }
+            else{
+                //Data is shifted on the leading edge, sampled on the trailing
+                err = GIPY_bankWrite(out, sclk | mosi, active | data);
+                waitHalfPeriod(&edge, half);
+                if(isMiso && err == GE_OK){
+                    err = GIPY_bankRead(&pBus->in, 0x01, &miso);
+                }
+                err = (err == GE_OK) ? GIPY_bankWrite(out, sclk, idle) : err;
+                waitHalfPeriod(&edge, half);
+            }
+            rxByte |= (uint8_t)(miso << shift);
+        }
+        if(pRx != NULL){
+            pRx[k] = rxByte;
+        }
+    }
+
+    //Clock back to idle, then deselect the slave
+    GIPY_bankWrite(out, sclk, idle);
+    waitHalfPeriod(&edge, half);
+    if(pBus->csBit != 0){
+        GIPY_bankWrite(out, pBus->csBit, pBus->csBit);
+    }
+    if(err != GE_OK){
+        dbgError("SPI transfer failed (Clock: %d)", pBus->config.pinSclk);
+    }
+    return err;
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static inline void waitHalfPeriod(uint64_t *pStart, uint32_t pHalfPeriod){
+    if(pHalfPeriod == 0){
+        return;
+    }
+    uint64_t now;
+    do{
+        now = GIPY_clockNow();
+    }while(now - *pStart < pHalfPeriod);
+    *pStart = now;
+}
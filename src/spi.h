@@ -0,0 +1,110 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY SPI
+ * Software (Bit-banged) SPI master on GPIO pins
+ *
+ * Whole transfers are clocked in one loop, using a pin bank (See bank.h),
+ * so the fastest backend is used and clock + data lines are changed by
+ * one bank write. Modes 0 to 3 are supported:
+ *  - CPOL (Mode bit 1): clock idle level
+ *  - CPHA (Mode bit 0): 0 sample on leading edge, 1 sample on trailing edge
+ * Chip select is active low.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_SPI_H_
+#define _HEADER_SPI_H_
+
+#include "gipy.h"
+#include "bank.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define SPI_NO_PIN      -1
+#define SPI_MODE_CPHA   0x01
+#define SPI_MODE_CPOL   0x02
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief SPI bus configuration
+ */
+typedef struct {
+    int         pinCs;      //Chip select (SPI_NO_PIN if not managed)
+    int         pinSclk;    //Clock
+    int         pinMosi;    //Master out (SPI_NO_PIN if read only)
+    int         pinMiso;    //Master in (SPI_NO_PIN if write only)
+    int         mode;       //0 to 3
+    int         lsbFirst;   //TRUE to shift LSB first (MSB first otherwise)
+    uint32_t    halfPeriod; //Min ns between two clock edges (0: full speed)
+} spiConfig;
+
+/**
+ * \brief SPI bus. Output bank bits are given by the masks
+ */
+typedef struct {
+    spiConfig   config;
+    pinBank     out;        //Clock, MOSI and CS
+    pinBank     in;         //MISO
+    uint32_t    sclkBit;
+    uint32_t    mosiBit;    //0 if no MOSI
+    uint32_t    csBit;      //0 if no CS
+} spiBus;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Open a SPI bus
+ * \details         Pins must be exported. Directions are set by this
+ *                  function (CS high, clock at idle level, MOSI low).
+ *
+ * \param pBus      Bus to initialize
+ * \param pConfig   Bus configuration
+ * \return GE_OK    If no error
+ * \return GE_PARAM If invalid configuration
+ * \return GE_PERM  If a pin is not exported
+ * \return GE_IO    If unable to set a pin direction
+ */
+pirror GIPY_spiOpen(spiBus*, const spiConfig*);
+
+/**
+ * \brief           Close a SPI bus (Pins stay exported)
+ *
+ * \param pBus      Bus to close
+ * \return void
+ */
+void GIPY_spiClose(spiBus*);
+
+/**
+ * \brief           Full duplex transfer (CS is asserted during the transfer)
+ *
+ * \param pBus      Opened bus
+ * \param pTx       Bytes to send (NULL to send zeros)
+ * \param pRx       Buffer for received bytes (NULL to discard)
+ * \param pLen      Number of bytes
+ * \return GE_OK    If no error
+ * \return GE_IO    If a pin access failed
+ */
+pirror GIPY_spiTransfer(spiBus*, const uint8_t*, uint8_t*, size_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
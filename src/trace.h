@@ -0,0 +1,65 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Static tracepoints (USDT) for the hot paths
+ *
+ * PROBES
+ * Probes are sys/sdt.h markers (Provider 'gipy'): a nop in the code and a
+ * note in the ELF, patched only while a tracer is attached. Arguments are
+ * values already computed by the library (No clock read for a probe).
+ * Stamps are the library clock (CLOCK_MONOTONIC in real mode, same as the
+ * bpftrace nsecs, unless the counter source is selected: see clock.h).
+ *  - pin_export(pin, fd), pin_unexport(pin)
+ *  - pin_direction(pin, direction), pin_edge(pin, edge)
+ *  - pin_adaptive(pin, highRate, lowRate, period)
+ *  - pin_rate_limit(pin, minInterval, stormRate, backOff)
+ *  - pin_mode(pin, mode, rate): adaptive / storm mode switches
+ *  - pin_read(pin, value), pin_write(pin, value): handle and int functions
+ *  - edge(pin, value, stamp, count): event handled (Count of coalesced edges)
+ *  - callback_start(pin, value, stamp), callback_end(pin, value, stamp):
+ *    edge hook and ISR function of the event
+ *  - queue_overflow(queue, overflows): event dropped by a full queue
+ *
+ * Example: bpftrace -e 'usdt:./bin/execTicTacBoom:gipy:edge
+ *                      { @lat = hist(nsecs - arg2); }'
+ *
+ * SET VARIABLES
+ * Probes are compiled if sys/sdt.h is found (systemtap-sdt-dev package),
+ * otherwise they are removed. Compile with -DTRACE_DISABLE to remove them.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#if !defined(TRACE_DISABLE) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TRACE_ACTIVE
+#endif
+#endif
+
+
+// -----------------------------------------------------------------------------
+// PART IF TRACE IS ENABLED
+// -----------------------------------------------------------------------------
+#ifdef TRACE_ACTIVE
+#define traceProbe1(name, a1)               DTRACE_PROBE1(gipy, name, a1)
+#define traceProbe2(name, a1, a2)           DTRACE_PROBE2(gipy, name, a1, a2)
+#define traceProbe3(name, a1, a2, a3)       DTRACE_PROBE3(gipy, name, a1, a2, a3)
+#define traceProbe4(name, a1, a2, a3, a4)   DTRACE_PROBE4(gipy, name, a1, a2, a3, a4)
+
+
+// -----------------------------------------------------------------------------
+// PART IF TRACE IS DISABLED (Arguments are not evaluated)
+// -----------------------------------------------------------------------------
+#else
+#define traceProbe1(name, a1)
+#define traceProbe2(name, a1, a2)
+#define traceProbe3(name, a1, a2, a3)
+#define traceProbe4(name, a1, a2, a3, a4)
+
+#endif //End trace_mode expression
+#endif //General end ifndef
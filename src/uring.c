@@ -0,0 +1,244 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Uring
+ * Minimal io_uring ring (Raw syscalls, no liburing)
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#include "uring.h"
+
+
+//------------------------------------------------------------------------------
+// Private header (Static functions / Vars)
+//------------------------------------------------------------------------------
+
+/**
+ * \brief   Create and map a ring
+ *
+ * \param   pRing       Ring to initialize
+ * \param   pEntries    Submission queue size
+ * \return  GE_OK if no error, GE_PERM if io_uring can not be used on this
+ *          kernel (ENOSYS, EPERM, too old), otherwise GE_IO
+ */
+static pirror openRing(uringRing*, unsigned);
+
+/**
+ * \brief   Unmap and close a ring (Thread exit)
+ */
+static void closeRing(void*);
+
+/**
+ * \brief   Create the thread key (Once)
+ */
+static void createKey(void);
+
+/**
+ * \brief   Get a free submission entry (Cleared)
+ *
+ * \return  Entry, NULL if the queue is full
+ */
+static struct io_uring_sqe *getSqe(uringRing*);
+
+static pthread_key_t    ringKey;
+static pthread_once_t   ringKeyOnce = PTHREAD_ONCE_INIT;
+static int              isAvailable = -1; //-1 if not checked yet
+
+
+//------------------------------------------------------------------------------
+// Uring functions
+//------------------------------------------------------------------------------
+int GIPY_uringIsAvailable(void){
+    return (uringThreadRing() != NULL) ? TRUE : FALSE;
+}
+
+
+//------------------------------------------------------------------------------
+// Library internal functions
+//------------------------------------------------------------------------------
+uringRing *uringThreadRing(void){
+    if(__atomic_load_n(&isAvailable, __ATOMIC_RELAXED) == FALSE){
+        return NULL;
+    }
+    pthread_once(&ringKeyOnce, &createKey);
+    uringRing *ring = pthread_getspecific(ringKey);
+    if(ring != NULL){
+        return ring;
+    }
+
+    //First use in this thread: only a kernel refusal is latched, other
+    //failures (ENOMEM, EMFILE, memlock...) fail this thread only
+    ring = malloc(sizeof(uringRing));
+    pirror err = (ring == NULL) ? GE_IO : openRing(ring, URING_ENTRIES);
+    if(err != GE_OK){
+        free(ring);
+        if(err == GE_PERM){
+            __atomic_store_n(&isAvailable, FALSE, __ATOMIC_RELAXED);
+            dbgInfo("io_uring not available");
+        }
+        else{
+            dbgError("Unable to open the io_uring ring of this thread");
+        }
+        return NULL;
+    }
+    __atomic_store_n(&isAvailable, TRUE, __ATOMIC_RELAXED);
+    pthread_setspecific(ringKey, ring);
+    return ring;
+}
+
+pirror uringPrepRw(uringRing *pRing, int pIsWrite, int pFd, void *pBuffer,
+        unsigned pLen, uint64_t pOffset, uint64_t pData){
+    struct io_uring_sqe *sqe = getSqe(pRing);
+    if(sqe == NULL){
+        return GE_PARAM;
+    }
+    sqe->opcode     = (pIsWrite == TRUE) ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd         = pFd;
+    sqe->addr       = (uint64_t)(uintptr_t)pBuffer;
+    sqe->len        = pLen;
+    sqe->off        = pOffset;
+    sqe->user_data  = pData;
+    return GE_OK;
+}
+
+pirror uringPrepPoll(uringRing *pRing, int pFd, unsigned pEvents, uint64_t pData){
+    struct io_uring_sqe *sqe = getSqe(pRing);
+    if(sqe == NULL){
+        return GE_PARAM;
+    }
+    sqe->opcode         = IORING_OP_POLL_ADD;
+    sqe->fd             = pFd;
+    sqe->poll32_events  = pEvents;
+    sqe->user_data      = pData;
+    return GE_OK;
+}
+
+pirror uringPrepPollRemove(uringRing *pRing, uint64_t pTarget, uint64_t pData){
+    struct io_uring_sqe *sqe = getSqe(pRing);
+    if(sqe == NULL){
+        return GE_PARAM;
+    }
+    sqe->opcode     = IORING_OP_POLL_REMOVE;
+    sqe->fd         = -1;
+    sqe->addr       = pTarget;
+    sqe->user_data  = pData;
+    return GE_OK;
+}
+
+pirror uringPrepTimeout(uringRing *pRing, struct __kernel_timespec *pTime,
+        unsigned pCount, uint64_t pData){
+    struct io_uring_sqe *sqe = getSqe(pRing);
+    if(sqe == NULL){
+        return GE_PARAM;
+    }
+    sqe->opcode     = IORING_OP_TIMEOUT;
+    sqe->fd         = -1;
+    sqe->addr       = (uint64_t)(uintptr_t)pTime;
+    sqe->len        = 1;
+    sqe->off        = pCount;
+    sqe->user_data  = pData;
+    return GE_OK;
+}
+
+pirror uringSubmit(uringRing *pRing, unsigned pWait){
+    //Publish the prepared entries (Tail is read by the kernel)
+    unsigned tail = *pRing->sqTail;
+    __atomic_store_n(pRing->sqTail, tail + pRing->toSubmit, __ATOMIC_RELEASE);
+
+    int ret;
+    do{
+        ret = syscall(__NR_io_uring_enter, pRing->fd, pRing->toSubmit, pWait,
+                (pWait > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    }while(ret == -1 && errno == EINTR);
+    pRing->toSubmit = 0;
+    return (ret == -1) ? GE_IO : GE_OK;
+}
+
+int uringReap(uringRing *pRing, uint64_t *pData, int32_t *pResult){
+    unsigned head = *pRing->cqHead;
+    if(head == __atomic_load_n(pRing->cqTail, __ATOMIC_ACQUIRE)){
+        return FALSE;
+    }
+    struct io_uring_cqe *cqe = &pRing->cqes[head & pRing->cqMask];
+    *pData      = cqe->user_data;
+    *pResult    = cqe->res;
+    __atomic_store_n(pRing->cqHead, head + 1, __ATOMIC_RELEASE);
+    return TRUE;
+}
+
+
+//------------------------------------------------------------------------------
+// Tools functions
+//------------------------------------------------------------------------------
+static pirror openRing(uringRing *pRing, unsigned pEntries){
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(pRing, 0, sizeof(uringRing));
+    pRing->fd = syscall(__NR_io_uring_setup, pEntries, &params);
+    if(pRing->fd == -1){
+        return (errno == ENOSYS || errno == EPERM) ? GE_PERM : GE_IO;
+    }
+    if((params.features & IORING_FEAT_SINGLE_MMAP) == 0){
+        close(pRing->fd); //Older than 5.4: not worth supporting
+        return GE_PERM;
+    }
+
+    //SQ and CQ rings share one mapping, entries have their own
+    size_t sqSize   = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize   = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    pRing->ringSize = (sqSize > cqSize) ? sqSize : cqSize;
+    pRing->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    pRing->ringMap  = mmap(NULL, pRing->ringSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, pRing->fd, IORING_OFF_SQ_RING);
+    pRing->sqes     = mmap(NULL, pRing->sqesSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, pRing->fd, IORING_OFF_SQES);
+    if(pRing->ringMap == MAP_FAILED || pRing->sqes == MAP_FAILED){
+        if(pRing->ringMap != MAP_FAILED){
+            munmap(pRing->ringMap, pRing->ringSize);
+        }
+        if(pRing->sqes != MAP_FAILED){
+            munmap(pRing->sqes, pRing->sqesSize);
+        }
+        close(pRing->fd);
+        return GE_IO;
+    }
+
+    uint8_t *map        = pRing->ringMap;
+    pRing->sqHead       = (unsigned *)(map + params.sq_off.head);
+    pRing->sqTail       = (unsigned *)(map + params.sq_off.tail);
+    pRing->sqMask       = *(unsigned *)(map + params.sq_off.ring_mask);
+    pRing->sqArray      = (unsigned *)(map + params.sq_off.array);
+    pRing->sqEntries    = params.sq_entries;
+    pRing->cqHead       = (unsigned *)(map + params.cq_off.head);
+    pRing->cqTail       = (unsigned *)(map + params.cq_off.tail);
+    pRing->cqMask       = *(unsigned *)(map + params.cq_off.ring_mask);
+    pRing->cqes         = (struct io_uring_cqe *)(map + params.cq_off.cqes);
+    dbgInfo("io_uring ring opened (fd: %d, %u entries)", pRing->fd, params.sq_entries);
+    return GE_OK;
+}
+
+static void closeRing(void *pRing){
+    uringRing *ring = (uringRing *)pRing;
+    munmap(ring->sqes, ring->sqesSize);
+    munmap(ring->ringMap, ring->ringSize);
+    close(ring->fd);
+    free(ring);
+}
+
+static void createKey(void){
+    pthread_key_create(&ringKey, &closeRing);
+}
+
+static struct io_uring_sqe *getSqe(uringRing *pRing){
+    unsigned tail = *pRing->sqTail + pRing->toSubmit;
+    if(tail - __atomic_load_n(pRing->sqHead, __ATOMIC_ACQUIRE) >= pRing->sqEntries){
+        return NULL;
+    }
+    unsigned index = tail & pRing->sqMask;
+    pRing->sqArray[index] = index;
+    pRing->toSubmit++;
+    memset(&pRing->sqes[index], 0, sizeof(struct io_uring_sqe));
+    return &pRing->sqes[index];
+}
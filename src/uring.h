@@ -0,0 +1,167 @@
+/*
+ * -----------------------------------------------------------------------------
+ * GIPY Uring
+ * Minimal io_uring ring (Raw syscalls, no liburing)
+ *
+ * Used by the banks (See bank.h) to submit the positional reads of many
+ * value files with one io_uring_enter, and to wait on POLLPRI for many
+ * pins at once. Each thread gets its own ring (Created on first use, freed
+ * when the thread exits): rings are never shared, no lock is needed.
+ *
+ * Since:   Oct 18, 2026
+ * Author:  Constantin MASSON
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef _HEADER_URING_H_
+#define _HEADER_URING_H_
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+#include "gipy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//------------------------------------------------------------------------------
+// CONSTANTS
+//------------------------------------------------------------------------------
+#define URING_ENTRIES       64 //Submission queue size (Completion queue is twice)
+
+
+//------------------------------------------------------------------------------
+// STRUCTURES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief Mapped io_uring instance
+ */
+typedef struct {
+    int                 fd;
+    unsigned            *sqHead;
+    unsigned            *sqTail;
+    unsigned            sqMask;
+    unsigned            *sqArray;
+    unsigned            sqEntries;
+    struct io_uring_sqe *sqes;
+    unsigned            *cqHead;
+    unsigned            *cqTail;
+    unsigned            cqMask;
+    struct io_uring_cqe *cqes;
+    void                *ringMap;   //SQ and CQ rings (Single mmap)
+    size_t              ringSize;
+    size_t              sqesSize;
+    unsigned            toSubmit;   //Prepared entries not submitted yet
+} uringRing;
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Check whether io_uring can be used on this kernel
+ *
+ * \return          TRUE if available, otherwise FALSE
+ */
+int GIPY_uringIsAvailable(void);
+
+
+//------------------------------------------------------------------------------
+// PROTOTYPES: Library internal
+//------------------------------------------------------------------------------
+
+/**
+ * \brief           Get the ring of the calling thread
+ *
+ * \details         io_uring is marked unavailable for all threads only if
+ *                  the kernel refuses it (ENOSYS, EPERM): other failures
+ *                  return NULL for this call only.
+ *
+ * \return          Ring, NULL if io_uring is not available
+ */
+uringRing *uringThreadRing(void);
+
+/**
+ * \brief           Prepare a positional read (Or write if pIsWrite)
+ *
+ * \param pRing     Ring
+ * \param pIsWrite  TRUE for a write
+ * \param pFd       File
+ * \param pBuffer   Buffer to read in / write from
+ * \param pLen      Number of bytes
+ * \param pOffset   Offset in file
+ * \param pData     User data of the completion
+ * \return GE_OK    If no error
+ * \return GE_PARAM If the submission queue is full
+ */
+pirror uringPrepRw(uringRing*, int, int, void*, unsigned, uint64_t, uint64_t);
+
+/**
+ * \brief           Prepare a one shot poll
+ *
+ * \param pRing     Ring
+ * \param pFd       File to poll
+ * \param pEvents   Poll events (POLLPRI...)
+ * \param pData     User data (Also used to remove the poll)
+ * \return GE_OK    If no error
+ * \return GE_PARAM If the submission queue is full
+ */
+pirror uringPrepPoll(uringRing*, int, unsigned, uint64_t);
+
+/**
+ * \brief           Prepare the removal of a pending poll
+ *
+ * \param pRing     Ring
+ * \param pTarget   User data of the poll to remove
+ * \param pData     User data of this completion
+ * \return GE_OK    If no error
+ * \return GE_PARAM If the submission queue is full
+ */
+pirror uringPrepPollRemove(uringRing*, uint64_t, uint64_t);
+
+/**
+ * \brief           Prepare a timeout (Completes after pCount completions or
+ *                  when the time is elapsed)
+ *
+ * \param pRing     Ring
+ * \param pTime     Relative time (Must stay valid till submitted)
+ * \param pCount    Completions to wait for
+ * \param pData     User data of the completion
+ * \return GE_OK    If no error
+ * \return GE_PARAM If the submission queue is full
+ */
+pirror uringPrepTimeout(uringRing*, struct __kernel_timespec*, unsigned, uint64_t);
+
+/**
+ * \brief           Submit the prepared entries and wait for completions
+ *
+ * \param pRing     Ring
+ * \param pWait     Number of completions to wait for
+ * \return GE_OK    If no error
+ * \return GE_IO    If io_uring_enter failed
+ */
+pirror uringSubmit(uringRing*, unsigned);
+
+/**
+ * \brief           Get the next completion (Does not block)
+ *
+ * \param pRing     Ring
+ * \param pData     Filled with the user data
+ * \param pResult   Filled with the result
+ * \return          TRUE if a completion was consumed, otherwise FALSE
+ */
+int uringReap(uringRing*, uint64_t*, int32_t*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
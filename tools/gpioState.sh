@@ -1,27 +1,12 @@
 #!/bin/sh
 #
-# Display the status of one GPIO
+# Display the status of GPIOs (Wrapper of gipyctl: one process, no fork per pin)
+# Set GIPYCTL to the gipyctl binary if not in the PATH (bin/execGipyctl)
 
 
-# Display data for one pin
-displayDataPin(){
-	if [[ ! -e "/sys/class/gpio/gpio$1" ]];then
-		echo "***** Pin $1 *****"
-		echo "Not exported yet"
-		echo "***** *****"
-		return #Leave function
-	fi
-
-	echo "***** Pin $1 *****"
-	echo Direction: `cat /sys/class/gpio/gpio$1/direction`
-	echo Edge: `cat /sys/class/gpio/gpio$1/edge`
-	echo Value: `cat /sys/class/gpio/gpio$1/value`
-	echo "***** *****"
-}
-
 # Check whether parameter is valid
 isValidParameter(){
-	if [[ $# -lt 1 ]];then
+	if [ $# -lt 1 ];then
 		echo "One or more pin must be given"
 		exit 1
 	fi
@@ -30,12 +15,10 @@ isValidParameter(){
 # Launch program 
 main(){
 	isValidParameter "$@"
-	for pin in "$@";do
-		displayDataPin $pin
-	done
+	pins=`echo "$@" | tr ' ' ','`
+	exec "${GIPYCTL:-execGipyctl}" dump "$pins"
 }
 
 
 main "$@"
 
-
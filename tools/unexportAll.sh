@@ -1,17 +1,15 @@
 #!/bin/sh
 #
-# Unexport all exported GPIO
+# Unexport all exported GPIO (Wrapper of gipyctl)
+# Set GIPYCTL to the gipyctl binary if not in the PATH (bin/execGipyctl)
 
 
 # Main function
 main(){
-	for pin in `ls /sys/class/gpio/ | grep -ie gpio[0-9] | cut -c 5-`;do
-		echo $pin > /sys/class/gpio/unexport
-	done
+	exec "${GIPYCTL:-execGipyctl}" unexport all
 }
 
 
 # Launch program 
 main "$@"
 
-